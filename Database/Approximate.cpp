@@ -0,0 +1,124 @@
+#include "Approximate.h"
+#include "Predicate.h"
+#include <cmath>
+#include <iomanip>
+
+namespace {
+    // Błąd względny HyperLogLog z 2^12 rejestrami: 1.04 / sqrt(4096).
+    constexpr double HLL_RELATIVE_ERROR = 1.04 / 64.0;
+
+    auto mix(std::uint64_t value) -> std::uint64_t {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return value;
+    }
+
+    /*
+     * Liczba różnych wartości całości z próby: przy założeniu, że każda z D wartości występuje total / D razy,
+     * próba ułamka fraction zawiera średnio D * (1 - (1 - fraction)^(total / D)) z nich - szukamy D (bisekcją),
+     * dla którego to daje sampled. Kolumna prawie unikalna w próbie wychodzi ~total, a mało różnych wartości ~sampled.
+     */
+    auto scaleDistinct(double sampled, double total, double fraction) -> double {
+        double low = sampled;
+        double high = std::max(sampled, total);
+        for (int i = 0; i < 64; ++i) {
+            double middle = (low + high) / 2.0;
+            double expected = middle * (1.0 - std::pow(1.0 - fraction, total / middle));
+            (expected < sampled ? low : high) = middle;
+        }
+        return (low + high) / 2.0;
+    }
+
+    auto formatNumber(double value) -> std::string {
+        std::ostringstream out;
+        out << std::llround(value);
+        return out.str();
+    }
+}
+
+auto TableSample::includes(const std::string &tableName, std::size_t block) const -> bool {
+    std::uint64_t hash = mix(hashValue(tableName) ^ mix(seed + block));
+    // 53 górne bity jako liczba z [0, 1).
+    return static_cast<double>(hash >> 11) * 0x1.0p-53 * 100.0 < percent;
+}
+
+auto ApproxAggregate::describe() const -> std::string {
+    if (function == ApproxFunction::CountDistinct) {
+        return "APPROX_COUNT_DISTINCT(" + column + ")";
+    }
+    std::ostringstream out;
+    out << "APPROX_QUANTILE(" << column << ", " << quantile << ")";
+    return out.str();
+}
+
+auto ApproxResult::describe(const ApproxAggregate &aggregate) const -> std::string {
+    std::ostringstream out;
+    out << aggregate.describe() << " = ";
+    if (empty) {
+        out << "(no values)";
+    } else {
+        out << formatNumber(estimate) << " (bounds " << formatNumber(low) << " .. " << formatNumber(high) << ")";
+    }
+    std::size_t read = rowsTotal - std::min(rowsNotSampled, rowsTotal);
+    out << ", rows read " << read << " of " << rowsTotal;
+    if (rowsNotSampled > 0 && rowsTotal > 0) {
+        out << " (" << std::fixed << std::setprecision(1)
+            << 100.0 * static_cast<double>(read) / static_cast<double>(rowsTotal) << "% sample)";
+    }
+    return out.str();
+}
+
+auto ApproxAccumulator::add(const std::string &value) -> void {
+    if (value.empty()) {
+        return;
+    }
+    if (aggregate.function == ApproxFunction::CountDistinct) {
+        distinct.add(value);
+    } else {
+        long long number;
+        if (!parseExactInteger(value, number)) {
+            return;
+        }
+        quantiles.add(number);
+    }
+    ++values;
+}
+
+/*
+ * Przedziały (ok. 95-99%): liczba różnych wartości - ±2 błędy standardowe HyperLogLog, a przy próbie górna granica
+ * dolicza wszystkie niewczytane wiersze (każdy mógłby mieć nową wartość), a sam wynik skaluje scaleDistinct.
+ * Kwantyl - wartości na rangach q ± (błąd rangi KLL + 2 * sqrt(q(1-q)/n) dla próby n wartości).
+ */
+auto ApproxAccumulator::result(std::size_t rowsNotSampled, std::size_t rowsTotal) const -> ApproxResult {
+    ApproxResult result;
+    result.rowsNotSampled = rowsNotSampled;
+    result.rowsTotal = rowsTotal;
+    if (values == 0) {
+        result.empty = true;
+        return result;
+    }
+    if (aggregate.function == ApproxFunction::CountDistinct) {
+        double estimate = std::min(distinct.estimate(), static_cast<double>(values));
+        result.low = std::max(1.0, estimate * (1.0 - 2.0 * HLL_RELATIVE_ERROR));
+        result.high = std::min(static_cast<double>(values), estimate * (1.0 + 2.0 * HLL_RELATIVE_ERROR)) +
+                      static_cast<double>(rowsNotSampled);
+        if (rowsNotSampled > 0 && rowsNotSampled < rowsTotal) {
+            double fraction = static_cast<double>(rowsTotal - rowsNotSampled) / static_cast<double>(rowsTotal);
+            estimate = scaleDistinct(estimate, static_cast<double>(values) / fraction, fraction);
+        }
+        result.estimate = std::clamp(estimate, result.low, result.high);
+        return result;
+    }
+    const double q = aggregate.quantile;
+    double error = quantiles.rankError();
+    if (rowsNotSampled > 0) {
+        error += 2.0 * std::sqrt(q * (1.0 - q) / static_cast<double>(values));
+    }
+    result.estimate = static_cast<double>(quantiles.quantile(q));
+    result.low = static_cast<double>(quantiles.quantile(std::max(0.0, q - error)));
+    result.high = static_cast<double>(quantiles.quantile(std::min(1.0, q + error)));
+    return result;
+}
@@ -0,0 +1,63 @@
+#ifndef DATABASE2_APPROXIMATE_H
+#define DATABASE2_APPROXIMATE_H
+#pragma once
+#include "Prerequestion.h"
+#include "HyperLogLog.h"
+#include "QuantileSketch.h"
+#include <cstdint>
+
+/*
+ * SELECT ... FROM t TABLESAMPLE (p PERCENT) [REPEATABLE (seed)]: skan czyta tylko wylosowane bloki mapy stref
+ * (po ZONE_BLOCK_ROWS wierszy), więc koszt spada proporcjonalnie do p. Bez REPEATABLE ziarno jest losowane
+ * przy każdym zapytaniu.
+ */
+struct TableSample {
+    double percent = 100.0;
+    std::uint64_t seed = 0;
+
+    // Ta sama trójka (ziarno, tabela, blok) daje zawsze tę samą odpowiedź.
+    auto includes(const std::string &tableName, std::size_t block) const -> bool;
+};
+
+enum class ApproxFunction : std::uint8_t {
+    CountDistinct,
+    Quantile
+};
+
+// APPROX_COUNT_DISTINCT(column) - HyperLogLog; APPROX_QUANTILE(column, q) - szkic KLL (tylko kolumny int).
+struct ApproxAggregate {
+    ApproxFunction function = ApproxFunction::CountDistinct;
+    std::string column;
+    double quantile = 0.5;
+
+    auto describe() const -> std::string;
+};
+
+// Wynik z przedziałem [low, high]; rowsNotSampled - żywe wiersze w blokach pominiętych przez TABLESAMPLE.
+struct ApproxResult {
+    bool empty = false;
+    double estimate = 0.0;
+    double low = 0.0;
+    double high = 0.0;
+    std::size_t rowsNotSampled = 0;
+    std::size_t rowsTotal = 0;
+
+    auto describe(const ApproxAggregate &aggregate) const -> std::string;
+};
+
+// Szkic jednego agregatu zasilany wartościami pasujących wierszy; puste komórki są pomijane jak w COUNT(column).
+class ApproxAccumulator {
+public:
+    explicit ApproxAccumulator(ApproxAggregate aggregate) : aggregate(std::move(aggregate)) {}
+
+    auto add(const std::string &value) -> void;
+    auto result(std::size_t rowsNotSampled, std::size_t rowsTotal) const -> ApproxResult;
+
+private:
+    ApproxAggregate aggregate;
+    HyperLogLog distinct;
+    QuantileSketch quantiles;
+    std::size_t values = 0;
+};
+
+#endif //DATABASE2_APPROXIMATE_H
@@ -0,0 +1,260 @@
+#include "BackgroundSaver.h"
+#include "FileOps.h"
+#include "Cancellation.h"
+#include <csignal>
+
+#ifdef DATABASE_FORK_SNAPSHOT
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+BackgroundSaver::BackgroundSaver(Database &db) : db(db), scheduler([this]() { loop(); }) {
+}
+
+BackgroundSaver::~BackgroundSaver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    wake.notify_all();
+    if (scheduler.joinable()) {
+        scheduler.join();
+    }
+    waitForCompletion();
+}
+
+auto BackgroundSaver::start(const std::string &filename) -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+    pollLocked();
+    if (state == State::Running) {
+        throw std::runtime_error("A background save to " + currentFile + " is already running");
+    }
+    startLocked(filename);
+}
+
+auto BackgroundSaver::setInterval(const std::string &filename, std::chrono::seconds interval) -> void {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        periodicFile = filename;
+        periodicInterval = interval;
+        nextPeriodicSave = std::chrono::steady_clock::now() + interval;
+    }
+    wake.notify_all();
+}
+
+auto BackgroundSaver::status() -> std::string {
+    std::lock_guard<std::mutex> lock(mutex);
+    pollLocked();
+
+    std::ostringstream out;
+    auto millis = [](std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    };
+    switch (state) {
+        case State::Idle:
+            out << "Background save: idle";
+            break;
+        case State::Running:
+            out << "Background save: running to " << currentFile << ", " << tablesDone.load() << "/"
+                << tablesTotal.load() << " tables, " << millis(std::chrono::steady_clock::now() - startedAt)
+                << " ms elapsed";
+            break;
+        case State::Done:
+            out << "Background save: finished " << currentFile << " in " << millis(lastDuration) << " ms";
+            break;
+        case State::Failed:
+            out << "Background save: failed " << currentFile << ": " << lastError;
+            break;
+    }
+    out << " (" << completedSaves << " completed)\n";
+    if (periodicInterval.count() > 0) {
+        out << "Periodic save: every " << periodicInterval.count() << " s to " << periodicFile << "\n";
+    }
+    return out.str();
+}
+
+auto BackgroundSaver::finishLocked(bool succeeded, const std::string &error) -> void {
+    state = succeeded ? State::Done : State::Failed;
+    lastError = error;
+    lastDuration = std::chrono::steady_clock::now() - startedAt;
+    completedSaves += succeeded;
+}
+
+auto BackgroundSaver::loop() -> void {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopRequested) {
+        wake.wait_for(lock, std::chrono::seconds(1), [this]() { return stopRequested; });
+        if (stopRequested) {
+            break;
+        }
+        pollLocked();
+        if (periodicInterval.count() == 0 || state == State::Running ||
+            std::chrono::steady_clock::now() < nextPeriodicSave) {
+            continue;
+        }
+
+        // Kolejność blokad jak w CLI: najpierw baza, potem stan zapisu.
+        lock.unlock();
+        std::lock_guard<std::recursive_mutex> dbLock(db.latch());
+        lock.lock();
+        if (stopRequested || periodicInterval.count() == 0 || state == State::Running) {
+            continue;
+        }
+        try {
+            startLocked(periodicFile);
+        } catch (const std::exception &e) {
+            currentFile = periodicFile;
+            finishLocked(false, e.what());
+        }
+        nextPeriodicSave = std::chrono::steady_clock::now() + periodicInterval;
+    }
+}
+
+#ifdef DATABASE_FORK_SNAPSHOT
+
+auto BackgroundSaver::startLocked(const std::string &filename) -> void {
+    // Potomek ma tylko jeden wątek - nie może czekać na blokady wątku wczytującego tabele z LOAD.
+    db.loadAllTables();
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error("Unable to start background save: pipe failed");
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error("Unable to start background save: fork failed");
+    }
+
+    if (pid == 0) {
+        // Po fork() w dziecku istnieje tylko ten wątek - wątki puli zostały w rodzicu.
+        ThreadPool::disableInThisProcess();
+        // Snapshot w tle nie jest częścią polecenia SAVE ASYNC: ani jego limit czasu, ani Ctrl-C przerywający
+        // zapytanie na pierwszym planie (SIGINT dostaje cała grupa procesów) nie mogą go przerwać.
+        detachFromStatement();
+        std::signal(SIGINT, SIG_IGN);
+        close(fds[0]);
+        int exitCode = 0;
+        try {
+            FileOps fileops;
+            auto childStart = std::chrono::steady_clock::now();
+            fileops.saveDatabase(db, filename, [fd = fds[1], childStart](std::size_t done, std::size_t total) {
+                auto elapsed = std::chrono::steady_clock::now() - childStart;
+                std::uint64_t record[3] = {done, total, static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())};
+                [[maybe_unused]] auto written = write(fd, record, sizeof(record));
+            });
+        } catch (const std::exception &e) {
+            std::cerr << "Background save failed: " << e.what() << std::endl;
+            exitCode = 1;
+        }
+        // Bez destruktorów - należą do procesu rodzica (wątki, pliki tymczasowe itd.).
+        _exit(exitCode);
+    }
+
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    child = pid;
+    progressPipe = fds[0];
+    state = State::Running;
+    currentFile = filename;
+    startedAt = std::chrono::steady_clock::now();
+    tablesDone = 0;
+    tablesTotal = db.getTables().size();
+    childNanos = 0;
+}
+
+auto BackgroundSaver::pollLocked() -> void {
+    if (state != State::Running) {
+        return;
+    }
+    // Rekordy postępu: zapisane tabele, wszystkie tabele, czas zapisu w potomku (ns).
+    std::uint64_t record[3];
+    while (read(progressPipe, record, sizeof(record)) == static_cast<ssize_t>(sizeof(record))) {
+        tablesDone = record[0];
+        tablesTotal = record[1];
+        childNanos = record[2];
+    }
+
+    int status = 0;
+    pid_t result = waitpid(child, &status, WNOHANG);
+    if (result == 0 || (result < 0 && errno == EINTR)) {
+        return;
+    }
+    close(progressPipe);
+    progressPipe = -1;
+    child = -1;
+    if (result > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        finishLocked(true, "");
+        // Zakończenie zauważamy dopiero przy odpytaniu - czas zapisu bierzemy od potomka.
+        if (childNanos > 0) {
+            lastDuration = std::chrono::nanoseconds(childNanos);
+        }
+    } else {
+        finishLocked(false, "snapshot process exited with status " +
+                            std::to_string(WIFEXITED(status) ? WEXITSTATUS(status) : -1));
+    }
+}
+
+auto BackgroundSaver::waitForCompletion() -> void {
+    if (child > 0) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        close(progressPipe);
+        child = -1;
+    }
+}
+
+#else
+
+auto BackgroundSaver::startLocked(const std::string &filename) -> void {
+    if (worker.joinable()) {
+        worker.join();
+    }
+    // Bez fork() kopię bazy robimy pod blokadą - zapis na dysk i tak odbywa się już poza nią.
+    auto snapshot = std::make_shared<Database>(db);
+    state = State::Running;
+    currentFile = filename;
+    startedAt = std::chrono::steady_clock::now();
+    tablesDone = 0;
+    tablesTotal = snapshot->getTables().size();
+    workerFinished = false;
+    worker = std::thread([this, snapshot, filename]() {
+        bool succeeded = true;
+        std::string error;
+        try {
+            FileOps fileops;
+            fileops.saveDatabase(*snapshot, filename, [this](std::size_t done, std::size_t total) {
+                tablesDone = done;
+                tablesTotal = total;
+            });
+        } catch (const std::exception &e) {
+            succeeded = false;
+            error = e.what();
+        }
+        workerSucceeded = succeeded;
+        workerError = error;
+        workerFinished.store(true, std::memory_order_release);
+    });
+}
+
+auto BackgroundSaver::pollLocked() -> void {
+    if (state != State::Running || !workerFinished.load(std::memory_order_acquire)) {
+        return;
+    }
+    worker.join();
+    finishLocked(workerSucceeded, workerError);
+}
+
+auto BackgroundSaver::waitForCompletion() -> void {
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+#endif
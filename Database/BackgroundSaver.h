@@ -0,0 +1,79 @@
+#ifndef DATABASE2_BACKGROUNDSAVER_H
+#define DATABASE2_BACKGROUNDSAVER_H
+#pragma once
+#include "Prerequestion.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Na systemach POSIX zrzut robi proces potomny z fork() - jądro kopiuje strony pamięci dopiero przy zapisie.
+#if defined(__unix__) || defined(__APPLE__)
+#define DATABASE_FORK_SNAPSHOT 1
+#include <sys/types.h>
+#endif
+
+class Database;
+
+/*
+ * SAVE ASYNC i okresowe zrzuty (SAVE EVERY). Stan bazy z chwili polecenia zapisuje proces potomny
+ * (fork, copy-on-write), a bez fork() - wątek w tle zapisujący kopię bazy zrobioną pod blokadą.
+ * Polecenia działają dalej w trakcie zapisu; postęp i wynik pokazuje SAVE STATUS.
+ */
+class BackgroundSaver {
+public:
+    explicit BackgroundSaver(Database &db);
+    ~BackgroundSaver();
+
+    BackgroundSaver(const BackgroundSaver &) = delete;
+    auto operator=(const BackgroundSaver &) -> BackgroundSaver & = delete;
+
+    // Wywołujący trzyma blokadę bazy (db.latch()).
+    auto start(const std::string &filename) -> void;
+    // Zero wyłącza okresowe zrzuty.
+    auto setInterval(const std::string &filename, std::chrono::seconds interval) -> void;
+    auto status() -> std::string;
+
+private:
+    enum class State { Idle, Running, Done, Failed };
+
+    auto startLocked(const std::string &filename) -> void;
+    auto pollLocked() -> void;
+    auto finishLocked(bool succeeded, const std::string &error) -> void;
+    auto waitForCompletion() -> void;
+    auto loop() -> void;
+
+    Database &db;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopRequested = false;
+
+    State state = State::Idle;
+    std::string currentFile;
+    std::string lastError;
+    std::chrono::steady_clock::time_point startedAt;
+    std::chrono::steady_clock::duration lastDuration{};
+    std::atomic<std::size_t> tablesDone{0};
+    std::atomic<std::size_t> tablesTotal{0};
+    std::size_t completedSaves = 0;
+
+    std::string periodicFile;
+    std::chrono::seconds periodicInterval{0};
+    std::chrono::steady_clock::time_point nextPeriodicSave;
+
+#ifdef DATABASE_FORK_SNAPSHOT
+    pid_t child = -1;
+    int progressPipe = -1;
+    std::uint64_t childNanos = 0;
+#else
+    std::thread worker;
+    std::atomic<bool> workerFinished{false};
+    bool workerSucceeded = false;
+    std::string workerError;
+#endif
+    std::thread scheduler;
+};
+
+#endif //DATABASE2_BACKGROUNDSAVER_H
@@ -0,0 +1,89 @@
+#ifndef DATABASE2_BINARYIO_H
+#define DATABASE2_BINARYIO_H
+#pragma once
+#include "Prerequestion.h"
+#include <bit>
+#include <cstdint>
+
+// Zapis/odczyt liczb (little-endian) i napisów w binarnym formacie snapshotu.
+inline auto writeU64(std::ostream &out, std::uint64_t value) -> void {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    out.write(bytes, 8);
+}
+
+inline auto readU64(std::istream &in) -> std::uint64_t {
+    unsigned char bytes[8];
+    if (!in.read(reinterpret_cast<char *>(bytes), 8)) {
+        throw std::runtime_error("Unexpected end of snapshot file");
+    }
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+inline auto writeI64(std::ostream &out, long long value) -> void {
+    writeU64(out, static_cast<std::uint64_t>(value));
+}
+
+inline auto readI64(std::istream &in) -> long long {
+    return static_cast<long long>(readU64(in));
+}
+
+inline auto writeDouble(std::ostream &out, double value) -> void {
+    writeU64(out, std::bit_cast<std::uint64_t>(value));
+}
+
+inline auto readDouble(std::istream &in) -> double {
+    return std::bit_cast<double>(readU64(in));
+}
+
+// Liczba w kodzie zmiennej długości (7 bitów na bajt, najstarszy bit - ciąg dalszy); małe wartości zajmują 1 bajt.
+inline auto writeVarint(std::ostream &out, std::uint64_t value) -> void {
+    char bytes[10];
+    int size = 0;
+    do {
+        bytes[size] = static_cast<char>((value & 0x7F) | (value > 0x7F ? 0x80 : 0));
+        value >>= 7;
+        ++size;
+    } while (value != 0);
+    out.write(bytes, size);
+}
+
+inline auto readVarint(std::istream &in) -> std::uint64_t {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == std::char_traits<char>::eof()) {
+            throw std::runtime_error("Unexpected end of file");
+        }
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Corrupted file: varint too long");
+}
+
+inline auto writeString(std::ostream &out, const std::string &value) -> void {
+    writeU64(out, value.size());
+    out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+inline auto readString(std::istream &in) -> std::string {
+    std::uint64_t size = readU64(in);
+    if (size > (std::uint64_t{1} << 32)) {
+        throw std::runtime_error("Corrupted snapshot file: string too long");
+    }
+    std::string value(size, '\0');
+    if (size > 0 && !in.read(value.data(), static_cast<std::streamsize>(size))) {
+        throw std::runtime_error("Unexpected end of snapshot file");
+    }
+    return value;
+}
+
+#endif //DATABASE2_BINARYIO_H
@@ -0,0 +1,190 @@
+#include "BufferPool.h"
+
+PinnedPage::~PinnedPage() {
+    release();
+}
+
+PinnedPage::PinnedPage(PinnedPage &&other) noexcept: pool(other.pool), slot(other.slot), column(other.column) {
+    other.pool = nullptr;
+    other.column = nullptr;
+}
+
+auto PinnedPage::operator=(PinnedPage &&other) noexcept -> PinnedPage & {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        slot = other.slot;
+        column = other.column;
+        other.pool = nullptr;
+        other.column = nullptr;
+    }
+    return *this;
+}
+
+auto PinnedPage::release() -> void {
+    if (pool != nullptr) {
+        pool->unpin(slot);
+        pool = nullptr;
+        column = nullptr;
+    }
+}
+
+
+auto BufferPool::instance() -> BufferPool & {
+    static BufferPool pool;
+    return pool;
+}
+
+auto BufferPool::setCapacity(std::size_t bytes) -> void {
+    if (bytes < PAGE_SIZE) {
+        throw std::runtime_error("Buffer pool must hold at least one page (" + std::to_string(PAGE_SIZE) + " bytes)");
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    capacityPages = bytes / PAGE_SIZE;
+    evictLocked(0);
+}
+
+auto BufferPool::capacity() const -> std::size_t {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacityPages * PAGE_SIZE;
+}
+
+auto BufferPool::pin(const PageFile &file, const Extent &extent, std::span<const Extent> readAhead) -> PinnedPage {
+    FrameKey key{file.id(), extent.firstPage};
+    std::vector<Extent> run{extent};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto it = index.find(key); it != index.end()) {
+            Frame &frame = frames[it->second];
+            ++frame.pins;
+            frame.referenced = true;
+            ++hits;
+            return PinnedPage(this, it->second, frame.column.get());
+        }
+        ++misses;
+        for (const Extent &next: readAhead) {
+            if (next.empty() || next.firstPage != run.back().endPage() || index.contains({file.id(), next.firstPage})) {
+                break;
+            }
+            run.push_back(next);
+        }
+    }
+
+    // Odczyt i dekodowanie poza blokadą - inne wątki (np. równoległy SAVE) korzystają w tym czasie z puli.
+    std::string bytes = file.read(run.front().firstPage, run.back().endPage() - run.front().firstPage);
+    std::vector<std::unique_ptr<EncodedColumn>> columns;
+    for (const Extent &part: run) {
+        std::istringstream in(bytes.substr((part.firstPage - run.front().firstPage) * PAGE_SIZE, part.byteLength));
+        columns.push_back(std::make_unique<EncodedColumn>(readEncodedColumn(in)));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t slot;
+    if (auto it = index.find(key); it != index.end()) {
+        slot = it->second;
+    } else {
+        slot = insertLocked(key, extent.pageCount, std::move(columns.front()), true);
+    }
+    Frame &frame = frames[slot];
+    ++frame.pins;
+    frame.referenced = true;
+    const EncodedColumn *pinned = frame.column.get();
+    for (std::size_t i = 1; i < run.size(); ++i) {
+        FrameKey ahead{file.id(), run[i].firstPage};
+        if (!index.contains(ahead)) {
+            insertLocked(ahead, run[i].pageCount, std::move(columns[i]), false);
+            readAheadPages += run[i].pageCount;
+        }
+    }
+    return PinnedPage(this, slot, pinned);
+}
+
+auto BufferPool::install(const PageFile &file, const Extent &extent, EncodedColumn column) -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+    FrameKey key{file.id(), extent.firstPage};
+    if (!index.contains(key)) {
+        insertLocked(key, extent.pageCount, std::make_unique<EncodedColumn>(std::move(column)), false);
+    }
+}
+
+auto BufferPool::dropFile(std::uint64_t fileId) -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t slot = 0; slot < frames.size(); ++slot) {
+        if (frames[slot].column && frames[slot].key.fileId == fileId && frames[slot].pins == 0) {
+            removeLocked(slot);
+        }
+    }
+}
+
+auto BufferPool::stats() const -> BufferPoolStats {
+    std::lock_guard<std::mutex> lock(mutex);
+    BufferPoolStats result;
+    result.capacityBytes = capacityPages * PAGE_SIZE;
+    result.usedBytes = usedPages * PAGE_SIZE;
+    result.frames = index.size();
+    result.pinnedFrames = static_cast<std::size_t>(std::ranges::count_if(frames, [](const Frame &frame) {
+        return frame.column && frame.pins > 0;
+    }));
+    result.hits = hits;
+    result.misses = misses;
+    result.readAheadPages = readAheadPages;
+    result.evictions = evictions;
+    return result;
+}
+
+auto BufferPool::unpin(std::size_t slot) -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+    --frames[slot].pins;
+    if (usedPages > capacityPages) {
+        evictLocked(0);
+    }
+}
+
+auto BufferPool::insertLocked(const FrameKey &key, std::uint32_t pages, std::unique_ptr<EncodedColumn> column,
+                              bool referenced) -> std::size_t {
+    evictLocked(pages);
+    std::size_t slot;
+    if (freeSlots.empty()) {
+        slot = frames.size();
+        frames.emplace_back();
+    } else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    Frame &frame = frames[slot];
+    frame.key = key;
+    frame.pages = pages;
+    frame.column = std::move(column);
+    frame.pins = 0;
+    frame.referenced = referenced;
+    index.emplace(key, slot);
+    usedPages += pages;
+    return slot;
+}
+
+// Dwa pełne obroty wskazówki wystarczą, żeby zdjąć każdy bit odwołania; dalej zostają już tylko przypięte ramki.
+auto BufferPool::evictLocked(std::size_t incomingPages) -> void {
+    for (std::size_t step = 0; usedPages + incomingPages > capacityPages && step < 2 * frames.size(); ++step) {
+        std::size_t slot = hand;
+        hand = (hand + 1) % frames.size();
+        Frame &frame = frames[slot];
+        if (!frame.column || frame.pins > 0) {
+            continue;
+        }
+        if (frame.referenced) {
+            frame.referenced = false;
+            continue;
+        }
+        removeLocked(slot);
+        ++evictions;
+    }
+}
+
+auto BufferPool::removeLocked(std::size_t slot) -> void {
+    Frame &frame = frames[slot];
+    index.erase(frame.key);
+    usedPages -= frame.pages;
+    frame.column.reset();
+    frame.referenced = false;
+    freeSlots.push_back(slot);
+}
@@ -0,0 +1,123 @@
+#ifndef DATABASE2_BUFFERPOOL_H
+#define DATABASE2_BUFFERPOOL_H
+#pragma once
+#include "Prerequestion.h"
+#include "Compression.h"
+#include "PageFile.h"
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+constexpr std::size_t DEFAULT_BUFFER_POOL_BYTES = std::size_t(64) << 20;
+
+struct BufferPoolStats {
+    std::size_t capacityBytes = 0;
+    std::size_t usedBytes = 0;
+    std::size_t frames = 0;
+    std::size_t pinnedFrames = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t readAheadPages = 0;
+    std::uint64_t evictions = 0;
+};
+
+class BufferPool;
+
+// Przypięty blok kolumny - pula nie wyrzuci go, dopóki ten obiekt istnieje.
+class PinnedPage {
+public:
+    PinnedPage() = default;
+    ~PinnedPage();
+    PinnedPage(PinnedPage &&other) noexcept;
+    auto operator=(PinnedPage &&other) noexcept -> PinnedPage &;
+
+    explicit operator bool() const {
+        return column != nullptr;
+    }
+
+    auto operator*() const -> const EncodedColumn & {
+        return *column;
+    }
+
+    auto operator->() const -> const EncodedColumn * {
+        return column;
+    }
+
+private:
+    friend class BufferPool;
+    PinnedPage(BufferPool *pool, std::size_t slot, const EncodedColumn *column)
+            : pool(pool), slot(slot), column(column) {}
+    auto release() -> void;
+
+    BufferPool *pool = nullptr;
+    std::size_t slot = 0;
+    const EncodedColumn *column = nullptr;
+};
+
+/*
+ * Wspólna pula zdekodowanych bloków tabel stronicowanych, o pojemności liczonej w stronach pliku
+ * (SET BUFFER POOL). Wymiana algorytmem CLOCK: wskazówka pomija przypięte ramki, a ramkom z bitem odwołania
+ * daje drugą szansę. Bloki wczytane z wyprzedzeniem nie mają bitu odwołania, więc nieużyte wypadają pierwsze.
+ * Gdy wszystkie ramki są przypięte, pula chwilowo przekracza pojemność i oddaje nadmiar przy odpinaniu.
+ */
+class BufferPool {
+public:
+    static auto instance() -> BufferPool &;
+
+    auto setCapacity(std::size_t bytes) -> void;
+    auto capacity() const -> std::size_t;
+    // readAhead - kolejne bloki skanu sekwencyjnego; te, które leżą w pliku tuż za extent i nie ma ich w puli,
+    // są wczytywane tym samym odczytem.
+    auto pin(const PageFile &file, const Extent &extent, std::span<const Extent> readAhead = {}) -> PinnedPage;
+    // Blok właśnie zapisany do pliku trafia od razu do puli, bez ponownego odczytu.
+    auto install(const PageFile &file, const Extent &extent, EncodedColumn column) -> void;
+    auto dropFile(std::uint64_t fileId) -> void;
+    auto stats() const -> BufferPoolStats;
+
+private:
+    friend class PinnedPage;
+
+    struct FrameKey {
+        std::uint64_t fileId = 0;
+        std::uint64_t firstPage = 0;
+
+        auto operator==(const FrameKey &other) const -> bool = default;
+    };
+
+    struct FrameKeyHash {
+        auto operator()(const FrameKey &key) const -> std::size_t {
+            return std::hash<std::uint64_t>()(key.fileId * 0x9e3779b97f4a7c15ULL ^ key.firstPage);
+        }
+    };
+
+    // Ramka bez column jest wolna.
+    struct Frame {
+        FrameKey key;
+        std::uint32_t pages = 0;
+        std::unique_ptr<EncodedColumn> column;
+        std::size_t pins = 0;
+        bool referenced = false;
+    };
+
+    BufferPool() = default;
+    auto unpin(std::size_t slot) -> void;
+    auto insertLocked(const FrameKey &key, std::uint32_t pages, std::unique_ptr<EncodedColumn> column,
+                      bool referenced) -> std::size_t;
+    auto evictLocked(std::size_t incomingPages) -> void;
+    auto removeLocked(std::size_t slot) -> void;
+
+    mutable std::mutex mutex;
+    std::vector<Frame> frames;
+    std::vector<std::size_t> freeSlots;
+    std::unordered_map<FrameKey, std::size_t, FrameKeyHash> index;
+    std::size_t hand = 0;
+    std::size_t usedPages = 0;
+    std::size_t capacityPages = DEFAULT_BUFFER_POOL_BYTES / PAGE_SIZE;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t readAheadPages = 0;
+    std::uint64_t evictions = 0;
+};
+
+#endif //DATABASE2_BUFFERPOOL_H
@@ -1,11 +1,47 @@
 #include "CLI.h"
 
+namespace {
+    // Bufor wyjścia REPLAY: wyniki odtwarzanych poleceń są odrzucane, a liczy się tylko wiersze błędów.
+    class DiscardBuffer : public std::streambuf {
+    public:
+        auto lines() const -> std::size_t {
+            return newlines.load();
+        }
+
+    protected:
+        auto overflow(int ch) -> int override {
+            if (ch == '\n') {
+                newlines.fetch_add(1, std::memory_order_relaxed);
+            }
+            return ch == traits_type::eof() ? 0 : ch;
+        }
+
+        auto xsputn(const char *data, std::streamsize size) -> std::streamsize override {
+            newlines.fetch_add(static_cast<std::size_t>(std::count(data, data + size, '\n')),
+                               std::memory_order_relaxed);
+            return size;
+        }
+
+    private:
+        std::atomic<std::size_t> newlines{0};
+    };
+
+    // Polecenia, które REPLAY pomija: zapis i wczytanie plików, replikacja i nagrywanie miałyby prawdziwe skutki.
+    auto skippedInReplay(const std::string &type) -> bool {
+        return type == "SAVE" || type == "LOAD" || type == "PAGE" || type == "REPLICATE" || type == "CAPTURE";
+    }
+}
 
 auto CLI::run() -> void {
     std::string input;
+    installInterruptHandlers();
     while (true) {
-        std::cout << ">> ";
-        std::getline(std::cin, input);
+        out << ">> ";
+        // Koniec wejścia (Ctrl-D, koniec skryptu) kończy jak exit.
+        if (!std::getline(std::cin, input)) {
+            break;
+        }
+        acknowledgeInterrupts();
 
         if (input == "quit" || input == "exit") {
             break;
@@ -14,68 +50,424 @@ auto CLI::run() -> void {
 
         try {
             Command command = parser.parseSQLCommand(input);
-            executeCommand(command);
+            // Nagranie nie obejmuje samych poleceń nagrywania i odtwarzania.
+            bool captured = capture.active() && command.type != "CAPTURE" && command.type != "REPLAY";
+            auto started = std::chrono::steady_clock::now();
+            StopWatch timer;
+            submit(std::move(command));
+            if (captured) {
+                capture.record(input, started, timer.elapsedNanos());
+            }
         } catch (const std::exception &e) {
-            std::cerr << "Error: " << e.what() << std::endl;
+            err << "Error: " << e.what() << std::endl;
         }
     }
 }
 
 
-auto CLI::executeCommand(const Command &command) -> void {
-    FileOps fileops;
-    try {
-        if (command.type == "CREATE") {
+auto CLI::submit(Command command) -> void {
+    if (command.type == "REPLAY") {
+        replay(command);
+        return;
+    }
+    // Bez blokady bazy - mają działać także wtedy, gdy inne polecenie ją trzyma.
+    if (command.type == "SHOW" && command.value == "STATEMENTS") {
+        out << runningStatements();
+        return;
+    }
+    if (command.type == "CANCEL") {
+        std::uint64_t id = std::stoull(command.value);
+        out << (cancelStatement(id) ? "Cancel requested for statement " : "No running statement ") << id
+            << std::endl;
+        return;
+    }
+    if (transaction.active() && Transaction::isWrite(command.type)) {
+        transaction.add(std::move(command));
+        return;
+    }
+    executeCommand(command);
+}
+
+auto CLI::applyWrite(const Command &command) -> void {
+    if (command.type == "CREATE") {
+        if (command.value == "VIEW") {
+            ViewDefinition view;
+            view.base = command.additionalData[0];
+            for (const auto &column: command.columns) {
+                view.columns.push_back(column.name);
+            }
+            view.whereClause = command.whereClause;
+            db.createView(command.tableName, std::move(view));
+        } else if (command.value == "INDEX") {
+            db.createIndex(command.tableName, command.columnName);
+        } else if (command.additionalData.empty()) {
             db.createTable(command.tableName, command.columns);
-        } else if (command.type == "DROP") {
+        } else {
+            PartitionScheme scheme;
+            scheme.method = command.additionalData[0] == "RANGE" ? PartitionMethod::Range : PartitionMethod::Hash;
+            scheme.column = command.additionalData[1];
+            if (scheme.method == PartitionMethod::Range) {
+                scheme.width = std::stoll(command.additionalData[2]);
+            } else {
+                scheme.count = std::stoull(command.additionalData[2]);
+            }
+            db.createTable(command.tableName, command.columns, scheme);
+        }
+    } else if (command.type == "DROP") {
+        if (command.value == "INDEX") {
+            db.dropIndex(command.tableName, command.columnName);
+        } else if (command.additionalData.empty()) {
             db.deleteTable(command.tableName);
-        } else if (command.type == "ADD") {
-            for (const auto &column: command.columns) {
-                db.addColumn(command.tableName, column);
+        } else {
+            std::size_t dropped = db.dropPartitions(command.tableName, std::stoll(command.additionalData[1]));
+            out << "Dropped " << dropped << " partitions" << std::endl;
+        }
+    } else if (command.type == "ADD") {
+        for (const auto &column: command.columns) {
+            db.addColumn(command.tableName, column);
+        }
+    } else if (command.type == "INSERT") {
+        // Assuming INSERT command inserts a new row
+        db.insertInto(command.tableName, command.columnName,Row(command.data));
+    } else if (command.type == "UPDATE") {
+        db.update(command.tableName, command.columnName, command.assignment, command.whereExpression);
+    } else if (command.type == "DELETE") {
+        if (command.columnName.empty()) {
+            db.deleteRows(command.tableName, command.whereExpression);
+        } else {
+            db.deleteDataFromColumn(command.tableName, command.columnName, command.dataToDelete);
+        }
+    } else if (command.type == "REMOVE") {
+        db.removeColumn(command.tableName, command.columnName);
+    }
+}
+
+// Wywołujący trzyma blokadę bazy.
+auto CLI::applyBatch(const std::vector<Command> &commands) -> void {
+    db.saveTables(Transaction::tableNames(commands));
+    std::size_t applied = 0;
+    try {
+        for (const auto &command: commands) {
+            applyWrite(command);
+            ++applied;
+        }
+        db.discardUndo();
+    } catch (const std::exception &e) {
+        db.restoreTables();
+        throw std::runtime_error("Transaction rolled back: statement " + std::to_string(applied + 1) + " of " +
+                                 std::to_string(commands.size()) + " (" + commands[applied].type + ") failed: " +
+                                 e.what());
+    }
+}
+
+// Cały zbiór zapisów wykonuje się pod jedną blokadą (wywołujący ją trzyma) i trafia do replik jako jeden rekord.
+auto CLI::commitTransaction() -> void {
+    std::vector<Command> writes = transaction.commit();
+    applyBatch(writes);
+    if (primary.active() && !writes.empty()) {
+        std::vector<std::string> statements;
+        for (const auto &write: writes) {
+            statements.push_back(write.text);
+        }
+        primary.publish(std::move(statements));
+    }
+    out << "Committed " << writes.size() << " statements" << std::endl;
+}
+
+auto CLI::replicate(const Command &command) -> void {
+    const std::string &mode = command.additionalData[0];
+    if (mode == "SERVE") {
+        if (follower.active()) {
+            throw std::runtime_error("A replica cannot serve other replicas");
+        }
+        primary.serve(command.value);
+    } else if (mode == "FROM") {
+        if (primary.active()) {
+            throw std::runtime_error("A primary serving replicas cannot become a replica");
+        }
+        if (transaction.active()) {
+            throw std::runtime_error("REPLICATE FROM is not allowed inside a transaction");
+        }
+        follower.follow(command.value);
+    } else if (mode == "STOP") {
+        primary.stop();
+        follower.stop();
+    } else {
+        out << (primary.active() ? primary.status() : follower.status());
+    }
+}
+
+auto CLI::replay(const Command &command) -> void {
+    if (command.additionalData[0] == "COMPARE") {
+        out << "Baseline " << command.additionalData[1] << ", replay " << command.additionalData[2] << "\n"
+            << describeReplayTimings(compareReplayReports(command.additionalData[1], command.additionalData[2]));
+        return;
+    }
+    if (transaction.active()) {
+        throw std::runtime_error("REPLAY is not allowed inside a transaction");
+    }
+    // Sesje odtwarzania nie publikują zmian, a replika przyjmuje tylko odczyty.
+    if (primary.active() || follower.active()) {
+        throw std::runtime_error("REPLAY is not allowed while replicating (REPLICATE STOP first)");
+    }
+
+    ReplayOptions options;
+    const std::string &speed = command.additionalData[1];
+    options.speed = speed == "MAX" ? 0.0 : std::stod(speed);
+    options.threads = std::stoull(command.additionalData[2]);
+    std::uint64_t interrupts = interruptCount();
+    options.canceled = [interrupts]() { return interruptCount() != interrupts; };
+    const std::string &reportPath = command.additionalData[3];
+    std::vector<CapturedStatement> statements = readCaptures(
+            std::vector<std::string>(command.additionalData.begin() + 4, command.additionalData.end()));
+
+    // Klasyfikacja przed odtwarzaniem, żeby pominięte polecenia nie trafiły do porównania czasów.
+    std::unordered_set<std::string> skipped;
+    std::size_t skippedCount = 0;
+    for (const CapturedStatement &statement: statements) {
+        bool skip = false;
+        try {
+            skip = skippedInReplay(parser.parseSQLCommand(statement.text).type);
+        } catch (const std::exception &) {
+        }
+        if (skip) {
+            skipped.insert(statement.text);
+            ++skippedCount;
+        }
+    }
+
+    // Każda sesja pisze do własnych strumieni nad wspólnymi buforami - wątki w tle nadal piszą do std::cout
+    // i std::cerr, a do błędów odtwarzania liczą się tylko wiersze błędów sesji.
+    DiscardBuffer discarded;
+    DiscardBuffer errors;
+    std::vector<std::unique_ptr<std::ostream>> streams;
+    std::vector<std::unique_ptr<CLI>> sessions;
+    auto openSession = [&](std::uint64_t) -> SessionExecutor {
+        std::ostream &sessionOut = *streams.emplace_back(std::make_unique<std::ostream>(&discarded));
+        std::ostream &sessionErr = *streams.emplace_back(std::make_unique<std::ostream>(&errors));
+        CLI *session = sessions.emplace_back(new CLI(db, parser, sessionOut, sessionErr, false)).get();
+        return [session, &skipped](const std::string &statement) {
+            if (skipped.contains(statement)) {
+                return;
             }
-        } else if (command.type == "INSERT") {
-            // Assuming INSERT command inserts a new row
-            db.insertInto(command.tableName, command.columnName,Row(command.data));
-        } else if (command.type == "UPDATE") {
-            if (command.updatedData.Data.empty()) {
-                throw std::runtime_error("No data provided for update");
+            try {
+                session->submit(session->parser.parseSQLCommand(statement));
+            } catch (const std::exception &e) {
+                session->err << "Error: " << e.what() << std::endl;
             }
-            std::string newValue = command.updatedData.Data[0];
-            db.update(command.tableName, command.columnName, newValue);
-        } else if (command.type == "DELETE") {
+        };
+    };
 
-            db.deleteDataFromColumn(command.tableName, command.columnName, command.dataToDelete);
-        } else if (command.type == "REMOVE") {
-            db.removeColumn(command.tableName, command.columnName);
+    StopWatch wall;
+    std::vector<std::uint64_t> latencies = replayWorkload(statements, options, openSession);
+    std::uint64_t wallNanos = wall.elapsedNanos();
+    if (options.canceled()) {
+        acknowledgeInterrupts();
+        throw StatementCanceled("Statement canceled: REPLAY interrupted");
+    }
+
+    std::vector<ReplayTiming> timings;
+    timings.reserve(statements.size());
+    for (std::size_t i = 0; i < statements.size(); ++i) {
+        if (skipped.contains(statements[i].text)) {
+            continue;
+        }
+        timings.push_back({statements[i].session, statements[i].latencyNanos, latencies[i], statements[i].text});
+    }
+    if (!reportPath.empty()) {
+        writeReplayReport(reportPath, timings);
+    }
+    out << "Replayed " << statements.size() << " statements from " << sessions.size() << " sessions in "
+        << wallNanos / 1000000 << " ms (speed " << (speed == "MAX" ? "MAX" : speed + "x") << ", threads "
+        << options.threads << "), errors " << errors.lines() << ", skipped " << skippedCount
+        << " (SAVE, LOAD, PAGE, REPLICATE, CAPTURE)\n"
+        << "Baseline: latencies recorded by CAPTURE\n" << describeReplayTimings(timings);
+}
+
+auto CLI::executeCommand(const Command &command) -> void {
+    FileOps fileops;
+    StopWatch timer;
+    // Limit czasu liczy się od przyjęcia polecenia, także czekania na blokadę bazy.
+    StatementContext statement(command.text, statementTimeout);
+    StatementOutput output(out);
+    std::lock_guard<std::recursive_mutex> lock(db.latch());
+    try {
+        if (follower.active() && (Transaction::isWrite(command.type) || command.type == "BEGIN" ||
+                                  command.type == "LOAD")) {
+            throw std::runtime_error("Read-only replica: " + command.type + " is not allowed (REPLICATE STOP first)");
+        }
+        if (Transaction::isWrite(command.type)) {
+            applyWrite(command);
+            if (primary.active()) {
+                primary.publish({command.text});
+            }
+        } else if (command.type == "BEGIN") {
+            transaction.begin();
+        } else if (command.type == "COMMIT") {
+            commitTransaction();
+        } else if (command.type == "ROLLBACK") {
+            out << "Rolled back " << transaction.rollback() << " statements" << std::endl;
         } else if (command.type == "SELECT") {
             std::vector<std::string> columnNames;
             for (const auto &column: command.columns) {
                 columnNames.push_back(column.name);
             }
 
-            auto rows = db.select(command.tableName, columnNames, command.whereClause);
-            displaySelectedRows(rows);
+            const TableSample *sample = command.sample ? &*command.sample : nullptr;
+            if (command.aggregate) {
+                ApproxResult result = db.approximate(command.tableName, *command.aggregate, command.whereClause,
+                                                     sample);
+                out << result.describe(*command.aggregate) << std::endl;
+            } else {
+                auto rows = db.select(command.tableName, columnNames, command.whereClause, nullptr, sample);
+                displaySelectedRows(rows);
+            }
         } else if (command.type == "SAVE") {
-            fileops.saveDatabase(db, command.value);
+            std::string mode = command.additionalData.empty() ? "" : command.additionalData[0];
+            if (mode == "ASYNC") {
+                saver->start(command.value);
+            } else if (mode == "STATUS") {
+                out << saver->status();
+            } else if (mode == "EVERY") {
+                saver->setInterval(command.value, std::chrono::seconds(std::stoll(command.additionalData[1])));
+            } else {
+                fileops.saveDatabase(db, command.value);
+            }
         }
         else if (command.type == "LOAD") {
-            fileops.loadDatabase(command.value);
+            if (transaction.active()) {
+                throw std::runtime_error("LOAD is not allowed inside a transaction");
+            }
+            // Repliki dostały snapshot starej bazy - dalsze zmiany stosowałyby do innych danych.
+            if (primary.active()) {
+                throw std::runtime_error("LOAD is not allowed while serving replicas (REPLICATE STOP first)");
+            }
+            db = fileops.loadDatabase(command.value);
+        }
+        else if (command.type == "ANALYZE") {
+            db.analyze(command.tableName);
+        }
+        else if (command.type == "COMPRESS") {
+            db.compressTable(command.tableName);
+        }
+        else if (command.type == "PAGE") {
+            db.pageTable(command.tableName, command.value);
+        }
+        else if (command.type == "REPLICATE") {
+            replicate(command);
+        }
+        else if (command.type == "TRACE") {
+            const std::string &mode = command.additionalData[0];
+            if (mode == "START") {
+                Tracer::start();
+            } else if (mode == "STOP") {
+                Tracer::stop();
+            } else if (mode == "DUMP") {
+                std::size_t spans = Tracer::dump(command.value);
+                out << "Wrote " << spans << " spans to " << command.value << std::endl;
+            } else {
+                out << Tracer::status();
+            }
+        }
+        else if (command.type == "CAPTURE") {
+            const std::string &mode = command.additionalData[0];
+            if (mode == "START") {
+                capture.start(command.value);
+            } else if (mode == "STOP") {
+                out << "Captured " << capture.stop() << " statements" << std::endl;
+            } else {
+                out << capture.status();
+            }
+        }
+        else if (command.type == "STATS") {
+            if (command.value == "JSON") {
+                out << Stats::instance().toJson() << std::endl;
+            } else if (command.value == "RESET") {
+                Stats::instance().reset();
+            } else {
+                out << Stats::instance().report();
+            }
+            return;
+        }
+        else if (command.type == "SHOW") {
+            out << (command.value == "PARTITIONS" ? db.partitionReport(command.tableName) : db.memoryReport());
+        }
+        else if (command.type == "SET" && command.value == "STATEMENT TIMEOUT") {
+            statementTimeout = std::chrono::milliseconds(std::stoll(command.additionalData[0]));
+        }
+        else if (command.type == "SET") {
+            std::size_t bytes = std::stoull(command.additionalData[0]);
+            if (command.value == "QUERY MEMORY LIMIT") {
+                MemoryBudget::instance().setQueryLimit(bytes);
+            } else if (command.value == "BUFFER POOL") {
+                BufferPool::instance().setCapacity(bytes);
+            } else {
+                MemoryBudget::instance().setLimit(bytes);
+            }
+        }
+        else if (command.type == "EXPLAIN") {
+            explainAnalyze(command.value);
+            return;
         }
         else {
             throw std::runtime_error("Invalid command");
         }
 
     } catch (const std::exception &e) {
-        std::cerr << "Database operation error: " << e.what() << std::endl;
+        err << "Database operation error: " << e.what() << std::endl;
+    }
+    Stats::instance().recordCommand(command.type, timer.elapsedNanos());
+}
+
+auto CLI::explainAnalyze(const std::string &statement) -> void {
+    QueryProfile profile;
+    StopWatch total;
+
+    StopWatch parseTimer;
+    Command command = parser.parseSQLCommand(statement);
+    profile.parseNanos = parseTimer.elapsedNanos();
+
+    if (command.type != "SELECT" || command.aggregate) {
+        StopWatch executeTimer;
+        submit(std::move(command));
+        out << "parse      " << profile.parseNanos << " ns\n"
+            << "execute    " << executeTimer.elapsedNanos() << " ns\n"
+            << "total      " << total.elapsedNanos() << " ns" << std::endl;
+        return;
+    }
+
+    std::vector<std::string> columnNames;
+    for (const auto &column: command.columns) {
+        columnNames.push_back(column.name);
     }
+    auto rows = db.select(command.tableName, columnNames, command.whereClause, &profile,
+                          command.sample ? &*command.sample : nullptr);
+
+    StopWatch outputTimer;
+    displaySelectedRows(rows);
+    profile.outputNanos = outputTimer.elapsedNanos();
+    profile.rowsOutput = rows.size();
+
+    std::uint64_t totalNanos = total.elapsedNanos();
+    Stats::instance().recordCommand(command.type, totalNanos);
+    out << "operator   time_ns      rows\n"
+        << "parse      " << std::setw(10) << std::left << profile.parseNanos << "   -\n"
+        << "predicate  " << std::setw(10) << profile.predicateNanos << "   scanned "
+        << profile.rowsScanned << ", matched " << profile.rowsMatched << " (blocks scanned "
+        << profile.blocksScanned << ", skipped " << profile.blocksSkipped << ")"
+        << (command.sample ? ", not sampled " + std::to_string(profile.rowsNotSampled) : "") << "\n"
+        << "plan       " << std::setw(10) << "" << "   " << profile.accessPath << "\n"
+        << "projection " << std::setw(10) << profile.projectionNanos << "   " << profile.rowsMatched << "\n"
+        << "output     " << std::setw(10) << profile.outputNanos << "   " << profile.rowsOutput << "\n"
+        << "total      " << std::setw(10) << totalNanos << std::right << std::endl;
 }
 
 auto CLI::displaySelectedRows(const std::vector<Row> &rows) -> void {
     for (const Row& row : rows) {
         for (const auto& value : row.Data) {
-            std::cout << value << " ";
+            out << value << " ";
         }
-        std::cout << std::endl;
+        out << std::endl;
     }
 }
 
@@ -4,19 +4,67 @@
 #include "Database.h"
 #include "Parser.h"
 #include "FileOps.h"
+#include "Compactor.h"
+#include "BackgroundSaver.h"
+#include "Transaction.h"
+#include "Replication.h"
+#include "Workload.h"
+#include "Trace.h"
+#include "Cancellation.h"
+#include <iomanip>
+#include <unordered_set>
 
 class CLI {
 public:
-    CLI(Database& Database, Parser& parser) : db(Database), parser(parser) {
+    CLI(Database& Database, Parser& parser) : CLI(Database, parser, std::cout, std::cerr, true) {
     }
     auto displaySelectedRows(const std::vector<Row> &rows) -> void;
     auto executeCommand(const Command &command) -> void;
+    // W otwartej transakcji polecenia zmieniające dane trafiają do jej zbioru zapisów, pozostałe wykonują się od razu.
+    auto submit(Command command) -> void;
+    auto explainAnalyze(const std::string &statement) -> void;
     auto run() -> void;
 
 
 private:
+    // Sesja REPLAY (background = false) pisze do własnych strumieni i nie uruchamia własnych wątków kompakcji
+    // i zapisu w tle - korzysta z kompaktora CLI, które odtwarza nagranie, a SAVE pomija.
+    CLI(Database& Database, Parser& parser, std::ostream &out, std::ostream &err, bool background)
+            : db(Database), parser(parser), out(out), err(err),
+                                              compactor(background ? std::make_unique<Compactor>(Database) : nullptr),
+                                              saver(background ? std::make_unique<BackgroundSaver>(Database) : nullptr),
+                                              primary(Database),
+                                              follower(Database, [this](const std::vector<Command> &batch) {
+                                                  // Pojedyncze polecenie - jak poza transakcją, bez kopii tabel.
+                                                  if (batch.size() == 1) {
+                                                      applyWrite(batch.front());
+                                                  } else {
+                                                      applyBatch(batch);
+                                                  }
+                                              }) {
+    }
+    auto applyWrite(const Command &command) -> void;
+    // Wykonuje polecenia razem; gdy któreś się nie powiedzie, przywraca ich tabele i rzuca wyjątek.
+    auto applyBatch(const std::vector<Command> &commands) -> void;
+    auto commitTransaction() -> void;
+    auto replicate(const Command &command) -> void;
+    // REPLAY wykonuje się poza blokadą bazy - każda sesja nagrania dostaje własne CLI (z własną transakcją).
+    // SAVE, LOAD, PAGE, REPLICATE i CAPTURE z nagrania są pomijane - zmieniałyby pliki i stan procesu.
+    auto replay(const Command &command) -> void;
+
     Database& db;
     Parser& parser;
+    std::ostream &out;
+    std::ostream &err;
+    std::unique_ptr<Compactor> compactor;
+    std::unique_ptr<BackgroundSaver> saver;
+    Transaction transaction;
+    WorkloadCapture capture;
+    // SET STATEMENT TIMEOUT; 0 - bez limitu.
+    std::chrono::milliseconds statementTimeout{0};
+    ReplicationPrimary primary;
+    // Ostatni - jego wątek stosuje zmiany przez applyBatch, więc kończy się przed resztą CLI.
+    ReplicationFollower follower;
 };
 
 #endif // CLI_H
@@ -0,0 +1,238 @@
+#include "Cancellation.h"
+#include "Memory.h"
+#include <csignal>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define DATABASE_INTERRUPT_MESSAGES 1
+#endif
+
+namespace {
+    std::atomic<std::uint64_t> interrupts{0};
+    std::atomic<std::uint64_t> acknowledged{0};
+    std::atomic<bool> progressRequested{false};
+    std::atomic<std::size_t> runningCount{0};
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "signal handlers need lock-free counters");
+
+    thread_local StatementContext *currentStatement = nullptr;
+
+    struct Registry {
+        std::mutex mutex;
+        std::map<std::uint64_t, StatementContext *> statements;
+        std::uint64_t nextId = 1;
+    };
+
+    auto registry() -> Registry & {
+        static Registry instance;
+        return instance;
+    }
+
+    auto registerStatement(StatementContext *statement) -> std::uint64_t {
+        Registry &shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        std::uint64_t id = shared.nextId++;
+        shared.statements[id] = statement;
+        runningCount.fetch_add(1);
+        return id;
+    }
+
+    auto nowNanos() -> std::int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    auto seconds(double nanos) -> std::string {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << nanos / 1e9 << " s";
+        return out.str();
+    }
+
+    auto writeMessage(const char *message) -> void {
+#ifdef DATABASE_INTERRUPT_MESSAGES
+        std::size_t length = 0;
+        while (message[length] != '\0') {
+            ++length;
+        }
+        // Wynik zapisu nie ma znaczenia - to tylko podpowiedź dla użytkownika.
+        [[maybe_unused]] auto written = write(STDERR_FILENO, message, length);
+#endif
+    }
+
+    // W funkcji obsługi sygnału wolno tylko operacje na atomikach bez blokad i funkcje async-signal-safe.
+    void onInterrupt(int) {
+        if (interrupts.load() != acknowledged.load()) {
+            std::signal(SIGINT, SIG_DFL);
+            std::raise(SIGINT);
+            return;
+        }
+        interrupts.fetch_add(1);
+        writeMessage(runningCount.load() > 0 ? "\nCanceling (Ctrl-C again terminates the process)\n"
+                                             : "\n(Ctrl-C again terminates the process; exit quits)\n");
+    }
+
+#ifdef SIGUSR1
+    void onProgressRequest(int) {
+        progressRequested.store(true);
+    }
+#endif
+}
+
+StatementContext::StatementContext(std::string text, std::chrono::milliseconds timeout)
+        : text(std::move(text)), startedAt(std::chrono::steady_clock::now()), timeout(timeout),
+          interruptsAtStart(interrupts.load()), previous(currentStatement) {
+    phaseStartNanos.store(nowNanos());
+    // Rejestracja na końcu - SHOW STATEMENTS z innego wątku widzi już kompletny obiekt.
+    statementId = registerStatement(this);
+    currentStatement = this;
+}
+
+StatementContext::~StatementContext() {
+    currentStatement = previous;
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.statements.erase(statementId);
+    runningCount.fetch_sub(1);
+}
+
+auto StatementContext::current() -> StatementContext * {
+    return currentStatement;
+}
+
+auto StatementContext::cancel(const std::string &reason) -> void {
+    std::lock_guard<std::mutex> lock(reasonMutex);
+    if (!canceled.load()) {
+        cancelReason = reason;
+        canceled.store(true);
+    }
+}
+
+auto StatementContext::checkpoint() -> void {
+    if (progressRequested.exchange(false)) {
+        std::cerr << runningStatements() << std::flush;
+    }
+    if (writing.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (interrupts.load() != interruptsAtStart) {
+        acknowledged.store(interrupts.load());
+        cancel("interrupted");
+    }
+    if (timeout.count() > 0 && std::chrono::steady_clock::now() - startedAt > timeout) {
+        cancel("timeout of " + std::to_string(timeout.count()) + " ms exceeded");
+    }
+    if (canceled.load()) {
+        std::lock_guard<std::mutex> lock(reasonMutex);
+        throw StatementCanceled("Statement canceled: " + cancelReason);
+    }
+}
+
+auto StatementContext::enterWritePhase() -> void {
+    // Ostatnia szansa na anulowanie - potem polecenie musi się dokończyć.
+    checkpoint();
+    writing.store(true);
+    enterPhase("write", 0);
+}
+
+auto StatementContext::enterPhase(const char *phase, std::uint64_t expectedRows) -> void {
+    this->phase.store(phase);
+    phaseStartNanos.store(nowNanos());
+    rowsDone.store(0);
+    rowsExpected.store(expectedRows);
+}
+
+auto StatementContext::addProgress(std::uint64_t rows, std::uint64_t bytes) -> void {
+    rowsDone.fetch_add(rows, std::memory_order_relaxed);
+    bytesDone.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+auto StatementContext::describe() const -> std::string {
+    std::int64_t now = nowNanos();
+    std::uint64_t done = rowsDone.load();
+    std::uint64_t expected = rowsExpected.load();
+    std::ostringstream out;
+    out << "#" << statementId << "  " << seconds(static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startedAt)
+                    .count()));
+    if (timeout.count() > 0) {
+        out << " (timeout " << seconds(static_cast<double>(timeout.count()) * 1e6) << ")";
+    }
+    out << "  " << phase.load() << ": " << done << " rows";
+    if (expected > 0) {
+        double fraction = std::min(1.0, static_cast<double>(done) / static_cast<double>(expected));
+        out << " of " << expected << " (" << std::fixed << std::setprecision(0) << fraction * 100.0 << "%)";
+        // Koniec fazy przy dotychczasowym tempie.
+        if (done > 0 && fraction < 1.0) {
+            double elapsed = static_cast<double>(now - phaseStartNanos.load());
+            out << ", about " << seconds(elapsed * (1.0 - fraction) / fraction) << " left";
+        }
+    }
+    if (std::uint64_t bytes = bytesDone.load(); bytes > 0) {
+        out << ", " << formatBytes(bytes);
+    }
+    if (writing.load()) {
+        out << ", not cancelable";
+    }
+    out << "  " << text << "\n";
+    return out.str();
+}
+
+auto parseDuration(const std::string &number, const std::string &unit) -> std::chrono::milliseconds {
+    if (number.empty() || !std::ranges::all_of(number, ::isdigit)) {
+        throw std::runtime_error("Invalid duration: " + number);
+    }
+    std::chrono::milliseconds::rep multiplier = 1;
+    if (unit == "S") {
+        multiplier = 1000;
+    } else if (unit == "MIN") {
+        multiplier = 60 * 1000;
+    } else if (!unit.empty() && unit != "MS") {
+        throw std::runtime_error("Unknown duration unit: " + unit);
+    }
+    return std::chrono::milliseconds(std::stoll(number) * multiplier);
+}
+
+auto runningStatements() -> std::string {
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    if (shared.statements.empty()) {
+        return "No running statements\n";
+    }
+    std::string report;
+    for (const auto &[id, statement]: shared.statements) {
+        report += statement->describe();
+    }
+    return report;
+}
+
+auto cancelStatement(std::uint64_t id) -> bool {
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    auto it = shared.statements.find(id);
+    if (it == shared.statements.end()) {
+        return false;
+    }
+    it->second->cancel("canceled by CANCEL " + std::to_string(id));
+    return true;
+}
+
+auto installInterruptHandlers() -> void {
+    std::signal(SIGINT, onInterrupt);
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, onProgressRequest);
+#endif
+}
+
+auto detachFromStatement() -> void {
+    currentStatement = nullptr;
+}
+
+auto acknowledgeInterrupts() -> void {
+    acknowledged.store(interrupts.load());
+}
+
+auto interruptCount() -> std::uint64_t {
+    return interrupts.load();
+}
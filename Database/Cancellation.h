@@ -0,0 +1,109 @@
+#ifndef DATABASE2_CANCELLATION_H
+#define DATABASE2_CANCELLATION_H
+#pragma once
+#include "Prerequestion.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+class StatementCanceled : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/*
+ * Wykonywane polecenie CLI: limit czasu (SET STATEMENT TIMEOUT), anulowanie (Ctrl-C, CANCEL id, kill -INT)
+ * i postęp (SHOW STATEMENTS, kill -USR1). Anulowanie jest kooperacyjne - skany, projekcja, SAVE i LOAD
+ * wołają checkpoint() co blok wierszy albo co tabelę/kolumnę, a ten rzuca StatementCanceled.
+ * Polecenie zmieniające dane woła enterWritePhase() tuż przed pierwszą zmianą - od tej chwili nie da się
+ * go przerwać, żeby nie zostawić tabeli zmienionej tylko częściowo (COMMIT przy błędzie i tak przywraca tabele).
+ * Konstruktor ustawia polecenie jako bieżące dla wątku (StatementContext::current), destruktor przywraca poprzednie.
+ */
+class StatementContext {
+public:
+    StatementContext(std::string text, std::chrono::milliseconds timeout);
+    ~StatementContext();
+
+    StatementContext(const StatementContext &) = delete;
+    auto operator=(const StatementContext &) -> StatementContext & = delete;
+
+    static auto current() -> StatementContext *;
+
+    auto id() const -> std::uint64_t {
+        return statementId;
+    }
+    auto cancel(const std::string &reason) -> void;
+    // Bezpieczne z wątków puli (przez wskaźnik z current() wątku polecenia).
+    auto checkpoint() -> void;
+    auto enterWritePhase() -> void;
+
+    // Nowa faza zeruje licznik postępu; expectedRows = 0 - nieznana liczba wierszy (bez szacowania końca).
+    auto enterPhase(const char *phase, std::uint64_t expectedRows) -> void;
+    auto addProgress(std::uint64_t rows, std::uint64_t bytes = 0) -> void;
+    auto describe() const -> std::string;
+
+private:
+    std::uint64_t statementId = 0;
+    const std::string text;
+    const std::chrono::steady_clock::time_point startedAt;
+    const std::chrono::milliseconds timeout;
+    const std::uint64_t interruptsAtStart;
+    StatementContext *previous;
+
+    std::atomic<bool> canceled{false};
+    std::atomic<bool> writing{false};
+    mutable std::mutex reasonMutex;
+    std::string cancelReason;
+    std::atomic<const char *> phase{"starting"};
+    std::atomic<std::int64_t> phaseStartNanos{0};
+    std::atomic<std::uint64_t> rowsDone{0};
+    std::atomic<std::uint64_t> rowsExpected{0};
+    std::atomic<std::uint64_t> bytesDone{0};
+};
+
+// Punkt anulowania dla kodu bez dostępu do polecenia; bez bieżącego polecenia (wątki tła, API osadzone) nic nie robi.
+inline auto checkCancellation() -> void {
+    if (StatementContext *statement = StatementContext::current()) {
+        statement->checkpoint();
+    }
+}
+
+inline auto enterWritePhase() -> void {
+    if (StatementContext *statement = StatementContext::current()) {
+        statement->enterWritePhase();
+    }
+}
+
+inline auto reportPhase(const char *phase, std::uint64_t expectedRows) -> void {
+    if (StatementContext *statement = StatementContext::current()) {
+        statement->enterPhase(phase, expectedRows);
+    }
+}
+
+inline auto reportProgress(std::uint64_t rows, std::uint64_t bytes = 0) -> void {
+    if (StatementContext *statement = StatementContext::current()) {
+        statement->addProgress(rows, bytes);
+    }
+}
+
+// "5000" albo "5000", "MS" / "5", "S" / "2", "MIN" (SET STATEMENT TIMEOUT).
+auto parseDuration(const std::string &number, const std::string &unit) -> std::chrono::milliseconds;
+
+// Lista wykonywanych poleceń z postępem (SHOW STATEMENTS).
+auto runningStatements() -> std::string;
+// false, gdy polecenie o tym id już się skończyło.
+auto cancelStatement(std::uint64_t id) -> bool;
+
+/*
+ * Ctrl-C (SIGINT) anuluje wszystkie trwające polecenia; drugi Ctrl-C, zanim pierwszy zostanie obsłużony
+ * (albo przy pustym wierszu poleceń), kończy proces. SIGUSR1 wypisuje postęp na stderr w najbliższym checkpoint.
+ */
+auto installInterruptHandlers() -> void;
+// Odłącza wątek od bieżącego polecenia - proces potomny SAVE ASYNC nie może być anulowany jego limitem czasu.
+auto detachFromStatement() -> void;
+// Zapomina obsłużone Ctrl-C - CLI woła to przed każdym poleceniem.
+auto acknowledgeInterrupts() -> void;
+auto interruptCount() -> std::uint64_t;
+
+#endif //DATABASE2_CANCELLATION_H
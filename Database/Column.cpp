@@ -0,0 +1,24 @@
+#include "Column.h"
+
+auto parseColumnType(const std::string &name) -> ColumnType {
+    if (name == "int") {
+        return ColumnType::Int;
+    } else if (name == "string") {
+        return ColumnType::String;
+    } else if (name == "bool") {
+        return ColumnType::Bool;
+    }
+    throw std::runtime_error("Unknown column type: " + name);
+}
+
+auto columnTypeName(ColumnType type) -> std::string {
+    switch (type) {
+        case ColumnType::Int:
+            return "int";
+        case ColumnType::String:
+            return "string";
+        case ColumnType::Bool:
+            return "bool";
+    }
+    throw std::runtime_error("Unknown column type");
+}
@@ -1,11 +1,27 @@
-
 #ifndef DATABASE2_COLUMN_H
 #define DATABASE2_COLUMN_H
 #pragma once
 #include "Prerequestion.h"
+#include <cstdint>
+
+// Typ kolumny ustalany raz przy CREATE/ADD/LOAD - gorące pętle nie porównują już nazw typów.
+enum class ColumnType : std::uint8_t {
+    Int,
+    String,
+    Bool
+};
+
+// "int", "string", "bool" <-> ColumnType (nazwy używane w poleceniach i w plikach snapshotu).
+auto parseColumnType(const std::string &name) -> ColumnType;
+auto columnTypeName(ColumnType type) -> std::string;
+
 struct Column {
     std::string name;
-    std::string type;
+    ColumnType type = ColumnType::String;
+    // Wartość dla wierszy zapisanych przed dodaniem kolumny (ADD nie przepisuje istniejących wierszy).
+    std::string defaultValue{};
+    // Stałe miejsce kolumny w Row::Data; usunięte kolumny zostawiają martwe miejsce do czasu kompakcji.
+    std::size_t ordinal = 0;
 };
 
 
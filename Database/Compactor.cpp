@@ -0,0 +1,33 @@
+#include "Compactor.h"
+#include "Database.h"
+
+Compactor::Compactor(Database &db) : db(db), worker([this]() { loop(); }) {
+}
+
+Compactor::~Compactor() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopRequested = true;
+    }
+    stopSignal.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+auto Compactor::loop() -> void {
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopRequested) {
+        bool moreWork;
+        lock.unlock();
+        {
+            std::lock_guard<std::recursive_mutex> dbLock(db.latch());
+            moreWork = db.compactStep(COMPACTION_ROWS);
+        }
+        lock.lock();
+        // Gdy jest jeszcze praca, oddajemy tylko blokadę bazy, inaczej czekamy na kolejny REMOVE.
+        if (!moreWork) {
+            stopSignal.wait_for(lock, IDLE_INTERVAL, [this]() { return stopRequested; });
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef DATABASE2_COMPACTOR_H
+#define DATABASE2_COMPACTOR_H
+#pragma once
+#include "Prerequestion.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class Database;
+
+/*
+ * Wątek w tle, który po REMOVE zwalnia martwe komórki usuniętych kolumn, a po DELETE ... WHERE
+ * przepisuje tabele z dużym udziałem usuniętych wierszy (Database::compactStep).
+ * Zwalnianie kolumn bierze blokadę bazy tylko na COMPACTION_ROWS wierszy, więc nie blokuje poleceń na długo.
+ */
+class Compactor {
+public:
+    explicit Compactor(Database &db);
+    ~Compactor();
+
+    Compactor(const Compactor &) = delete;
+    auto operator=(const Compactor &) -> Compactor & = delete;
+
+private:
+    static constexpr std::size_t COMPACTION_ROWS = 4096;
+    static constexpr std::chrono::milliseconds IDLE_INTERVAL{200};
+
+    auto loop() -> void;
+
+    Database &db;
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+    bool stopRequested = false;
+    std::thread worker;
+};
+
+#endif //DATABASE2_COMPACTOR_H
@@ -0,0 +1,485 @@
+#include "Compression.h"
+#include "Predicate.h"
+#include "BinaryIO.h"
+#include "TextSearch.h"
+#include <bit>
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+    auto wordsFor(std::size_t count, int width) -> std::size_t {
+        return (count * static_cast<std::size_t>(width) + 63) / 64;
+    }
+
+    auto packBits(std::vector<std::uint64_t> &packed, std::size_t index, int width, std::uint64_t value) -> void {
+        if (width == 0) {
+            return;
+        }
+        std::size_t bit = index * static_cast<std::size_t>(width);
+        std::size_t word = bit / 64;
+        int offset = static_cast<int>(bit % 64);
+        packed[word] |= value << offset;
+        if (offset + width > 64) {
+            packed[word + 1] |= value >> (64 - offset);
+        }
+    }
+
+    auto unpackBits(const std::vector<std::uint64_t> &packed, std::size_t index, int width) -> std::uint64_t {
+        if (width == 0) {
+            return 0;
+        }
+        std::size_t bit = index * static_cast<std::size_t>(width);
+        std::size_t word = bit / 64;
+        int offset = static_cast<int>(bit % 64);
+        std::uint64_t value = packed[word] >> offset;
+        if (offset + width > 64) {
+            value |= packed[word + 1] << (64 - offset);
+        }
+        return width == 64 ? value : value & ((std::uint64_t{1} << width) - 1);
+    }
+
+    // Tylko liczby, które po wypisaniu dają dokładnie ten sam napis, mogą być kodowane binarnie.
+    auto parseCanonicalInt(const std::string &value, long long &number) -> bool {
+        if (value.empty()) {
+            return false;
+        }
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), number);
+        return ec == std::errc() && ptr == value.data() + value.size() && std::to_string(number) == value;
+    }
+
+    auto zigzag(std::uint64_t delta) -> std::uint64_t {
+        auto value = static_cast<long long>(delta);
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    auto unzigzag(std::uint64_t value) -> std::uint64_t {
+        return (value >> 1) ^ (~(value & 1) + 1);
+    }
+
+    template<typename Compare>
+    auto scanIntegers(const EncodedColumn &column, std::size_t begin, std::size_t end, bool nullResult,
+                      Compare compare, std::vector<char> &selection) -> void {
+        if (column.encoding == Encoding::BitPacked) {
+            auto base = static_cast<std::uint64_t>(column.base);
+            for (std::size_t i = begin; i < end; ++i) {
+                std::uint64_t code = unpackBits(column.packed, i, column.bitWidth);
+                selection[i - begin] = code == 0 ? nullResult : compare(static_cast<long long>(base + code - 1));
+            }
+            return;
+        }
+
+        std::size_t start = (begin / EncodedColumn::DELTA_CHECKPOINT) * EncodedColumn::DELTA_CHECKPOINT;
+        auto value = static_cast<std::uint64_t>(column.checkpoints[begin / EncodedColumn::DELTA_CHECKPOINT]);
+        for (std::size_t i = start + 1; i <= begin; ++i) {
+            value += unzigzag(unpackBits(column.packed, i, column.bitWidth));
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            if (i > begin) {
+                value += unzigzag(unpackBits(column.packed, i, column.bitWidth));
+            }
+            selection[i - begin] = compare(static_cast<long long>(value));
+        }
+    }
+}
+
+auto encodingName(Encoding encoding) -> std::string {
+    switch (encoding) {
+        case Encoding::Plain:
+            return "plain";
+        case Encoding::RunLength:
+            return "rle";
+        case Encoding::Dictionary:
+            return "dictionary";
+        case Encoding::BitPacked:
+            return "bitpacked";
+        case Encoding::Delta:
+            return "delta";
+    }
+    return "unknown";
+}
+
+auto chooseEncoding(const std::vector<std::string> &values, ColumnType columnType) -> Encoding {
+    if (values.empty()) {
+        return Encoding::Plain;
+    }
+
+    std::size_t plainBytes = 0;
+    std::size_t runBytes = 0;
+    std::size_t runs = 0;
+    std::unordered_set<std::string_view> distinct;
+    std::size_t dictionaryBytes = 0;
+
+    bool integers = columnType == ColumnType::Int;
+    bool hasNulls = false;
+    long long minValue = std::numeric_limits<long long>::max();
+    long long maxValue = std::numeric_limits<long long>::min();
+    std::uint64_t maxDelta = 0;
+    long long previous = 0;
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const std::string &value = values[i];
+        plainBytes += value.size() + 8;
+        if (i == 0 || value != values[i - 1]) {
+            ++runs;
+            runBytes += value.size() + 16;
+        }
+        if (distinct.insert(value).second) {
+            dictionaryBytes += value.size() + 8;
+        }
+
+        if (!integers) {
+            continue;
+        }
+        long long number;
+        if (value.empty()) {
+            hasNulls = true;
+        } else if (parseCanonicalInt(value, number)) {
+            minValue = std::min(minValue, number);
+            maxValue = std::max(maxValue, number);
+            if (i > 0 && !hasNulls) {
+                maxDelta = std::max(maxDelta, zigzag(static_cast<std::uint64_t>(number) -
+                                                     static_cast<std::uint64_t>(previous)));
+            }
+            previous = number;
+        } else {
+            integers = false;
+        }
+    }
+
+    int dictionaryWidth = std::max(1, static_cast<int>(std::bit_width(distinct.size() - 1)));
+    dictionaryBytes += wordsFor(values.size(), dictionaryWidth) * 8;
+
+    Encoding best = Encoding::Plain;
+    std::size_t bestBytes = plainBytes;
+    auto consider = [&](Encoding encoding, std::size_t bytes) {
+        if (bytes < bestBytes) {
+            best = encoding;
+            bestBytes = bytes;
+        }
+    };
+    consider(Encoding::RunLength, runBytes);
+    consider(Encoding::Dictionary, dictionaryBytes);
+
+    if (integers && minValue <= maxValue) {
+        std::uint64_t range = static_cast<std::uint64_t>(maxValue) - static_cast<std::uint64_t>(minValue);
+        if (range < std::numeric_limits<std::uint64_t>::max()) {
+            int width = static_cast<int>(std::bit_width(range + 1));
+            consider(Encoding::BitPacked, wordsFor(values.size(), width) * 8 + 16);
+        }
+        if (!hasNulls) {
+            int width = static_cast<int>(std::bit_width(maxDelta));
+            consider(Encoding::Delta, wordsFor(values.size(), width) * 8 +
+                                      (values.size() / EncodedColumn::DELTA_CHECKPOINT + 1) * 8 + 16);
+        }
+    }
+    return best;
+}
+
+auto encodeColumn(const std::vector<std::string> &values, Encoding encoding) -> EncodedColumn {
+    EncodedColumn column;
+    column.encoding = encoding;
+    column.size = values.size();
+
+    switch (encoding) {
+        case Encoding::Plain:
+            column.values = values;
+            break;
+
+        case Encoding::RunLength:
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (i == 0 || values[i] != values[i - 1]) {
+                    column.values.push_back(values[i]);
+                    column.runEnds.push_back(i + 1);
+                } else {
+                    column.runEnds.back() = i + 1;
+                }
+            }
+            break;
+
+        case Encoding::Dictionary: {
+            column.values = values;
+            std::ranges::sort(column.values);
+            auto duplicates = std::ranges::unique(column.values);
+            column.values.erase(duplicates.begin(), duplicates.end());
+            column.bitWidth = std::max(1, static_cast<int>(std::bit_width(column.values.size() - 1)));
+            column.packed.assign(wordsFor(values.size(), column.bitWidth), 0);
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                auto code = std::ranges::lower_bound(column.values, values[i]) - column.values.begin();
+                packBits(column.packed, i, column.bitWidth, static_cast<std::uint64_t>(code));
+            }
+            break;
+        }
+
+        case Encoding::BitPacked: {
+            long long minValue = std::numeric_limits<long long>::max();
+            long long maxValue = std::numeric_limits<long long>::min();
+            std::vector<long long> numbers(values.size());
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (!values[i].empty()) {
+                    if (!parseCanonicalInt(values[i], numbers[i])) {
+                        throw std::runtime_error("Bit-packed column contains a non-integer value: " + values[i]);
+                    }
+                    minValue = std::min(minValue, numbers[i]);
+                    maxValue = std::max(maxValue, numbers[i]);
+                }
+            }
+            column.base = minValue <= maxValue ? minValue : 0;
+            std::uint64_t range = minValue <= maxValue
+                                  ? static_cast<std::uint64_t>(maxValue) - static_cast<std::uint64_t>(minValue) : 0;
+            column.bitWidth = static_cast<int>(std::bit_width(range + 1));
+            column.packed.assign(wordsFor(values.size(), column.bitWidth), 0);
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (!values[i].empty()) {
+                    packBits(column.packed, i, column.bitWidth,
+                             static_cast<std::uint64_t>(numbers[i]) - static_cast<std::uint64_t>(column.base) + 1);
+                }
+            }
+            break;
+        }
+
+        case Encoding::Delta: {
+            std::vector<std::uint64_t> deltas(values.size(), 0);
+            std::uint64_t maxDelta = 0;
+            long long previous = 0;
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                long long number;
+                if (!parseCanonicalInt(values[i], number)) {
+                    throw std::runtime_error("Delta column contains a non-integer value: " + values[i]);
+                }
+                if (i % EncodedColumn::DELTA_CHECKPOINT == 0) {
+                    column.checkpoints.push_back(number);
+                }
+                if (i > 0) {
+                    deltas[i] = zigzag(static_cast<std::uint64_t>(number) - static_cast<std::uint64_t>(previous));
+                    maxDelta = std::max(maxDelta, deltas[i]);
+                }
+                previous = number;
+            }
+            column.base = column.checkpoints.empty() ? 0 : column.checkpoints.front();
+            column.bitWidth = static_cast<int>(std::bit_width(maxDelta));
+            column.packed.assign(wordsFor(values.size(), column.bitWidth), 0);
+            for (std::size_t i = 1; i < values.size(); ++i) {
+                packBits(column.packed, i, column.bitWidth, deltas[i]);
+            }
+            break;
+        }
+    }
+    return column;
+}
+
+auto encodeColumn(const std::vector<std::string> &values, ColumnType columnType) -> EncodedColumn {
+    return encodeColumn(values, chooseEncoding(values, columnType));
+}
+
+
+auto EncodedColumn::valueAt(std::size_t index) const -> std::string {
+    if (index >= size) {
+        throw std::runtime_error("Encoded column index out of range");
+    }
+    switch (encoding) {
+        case Encoding::Plain:
+            return values[index];
+        case Encoding::RunLength:
+            return values[std::ranges::upper_bound(runEnds, index) - runEnds.begin()];
+        case Encoding::Dictionary:
+            return values[unpackBits(packed, index, bitWidth)];
+        case Encoding::BitPacked: {
+            std::uint64_t code = unpackBits(packed, index, bitWidth);
+            if (code == 0) {
+                return "";
+            }
+            return std::to_string(static_cast<long long>(static_cast<std::uint64_t>(base) + code - 1));
+        }
+        case Encoding::Delta: {
+            std::size_t start = (index / DELTA_CHECKPOINT) * DELTA_CHECKPOINT;
+            auto value = static_cast<std::uint64_t>(checkpoints[index / DELTA_CHECKPOINT]);
+            for (std::size_t i = start + 1; i <= index; ++i) {
+                value += unzigzag(unpackBits(packed, i, bitWidth));
+            }
+            return std::to_string(static_cast<long long>(value));
+        }
+    }
+    return "";
+}
+
+auto EncodedColumn::decode() const -> std::vector<std::string> {
+    std::vector<std::string> result;
+    result.reserve(size);
+    switch (encoding) {
+        case Encoding::RunLength: {
+            std::size_t start = 0;
+            for (std::size_t run = 0; run < values.size(); ++run) {
+                result.insert(result.end(), runEnds[run] - start, values[run]);
+                start = runEnds[run];
+            }
+            break;
+        }
+        case Encoding::Delta: {
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                value = i == 0 ? static_cast<std::uint64_t>(base)
+                               : value + unzigzag(unpackBits(packed, i, bitWidth));
+                result.push_back(std::to_string(static_cast<long long>(value)));
+            }
+            break;
+        }
+        default:
+            for (std::size_t i = 0; i < size; ++i) {
+                result.push_back(valueAt(i));
+            }
+    }
+    return result;
+}
+
+auto EncodedColumn::byteSize() const -> std::size_t {
+    std::size_t bytes = sizeof(EncodedColumn);
+    for (const auto &value: values) {
+        bytes += sizeof(std::string) + (value.size() > 15 ? value.capacity() : 0);
+    }
+    bytes += runEnds.size() * sizeof(std::uint64_t);
+    bytes += packed.size() * sizeof(std::uint64_t);
+    bytes += checkpoints.size() * sizeof(long long);
+    return bytes;
+}
+
+
+auto filterEncoded(const EncodedColumn &column, std::size_t begin, std::size_t end,
+                   const std::string &op, const std::string &value, std::vector<char> &selection) -> void {
+    selection.assign(end - begin, 0);
+
+    switch (column.encoding) {
+        case Encoding::RunLength: {
+            std::size_t run = std::ranges::upper_bound(column.runEnds, begin) - column.runEnds.begin();
+            for (std::size_t i = begin; i < end; ++run) {
+                std::size_t runEnd = std::min<std::size_t>(column.runEnds[run], end);
+                char match = compareValues(column.values[run], op, value);
+                std::fill(selection.begin() + static_cast<std::ptrdiff_t>(i - begin),
+                          selection.begin() + static_cast<std::ptrdiff_t>(runEnd - begin), match);
+                i = runEnd;
+            }
+            return;
+        }
+
+        case Encoding::Dictionary: {
+            // Predykat liczymy raz na wpis słownika, a potem tylko sprawdzamy kody.
+            std::vector<char> codeMatches(column.values.size());
+            for (std::size_t code = 0; code < column.values.size(); ++code) {
+                codeMatches[code] = compareValues(column.values[code], op, value);
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                selection[i - begin] = codeMatches[unpackBits(column.packed, i, column.bitWidth)];
+            }
+            return;
+        }
+
+        case Encoding::BitPacked:
+        case Encoding::Delta: {
+            long long literal;
+            if (op == "LIKE") {
+                break;
+            }
+            if (op == "=" || op == "!=") {
+                bool equal = op == "=";
+                if (value.empty()) {
+                    scanIntegers(column, begin, end, equal, [equal](long long) { return !equal; }, selection);
+                } else if (parseCanonicalInt(value, literal)) {
+                    scanIntegers(column, begin, end, !equal,
+                                 [literal, equal](long long v) { return (v == literal) == equal; }, selection);
+                } else {
+                    scanIntegers(column, begin, end, !equal, [equal](long long) { return !equal; }, selection);
+                }
+                return;
+            }
+            if (parseNumber(value, literal)) {
+                if (op == ">") {
+                    scanIntegers(column, begin, end, false, [literal](long long v) { return v > literal; }, selection);
+                } else if (op == ">=") {
+                    scanIntegers(column, begin, end, false, [literal](long long v) { return v >= literal; }, selection);
+                } else if (op == "<") {
+                    scanIntegers(column, begin, end, false, [literal](long long v) { return v < literal; }, selection);
+                } else if (op == "<=") {
+                    scanIntegers(column, begin, end, false, [literal](long long v) { return v <= literal; }, selection);
+                } else {
+                    throw std::runtime_error("Unknown or unhandled expression operator");
+                }
+                return;
+            }
+            break;
+        }
+
+        case Encoding::Plain:
+            break;
+    }
+
+    if (op == "LIKE") {
+        LikePattern pattern(value);
+        for (std::size_t i = begin; i < end; ++i) {
+            selection[i - begin] = pattern.matches(column.valueAt(i));
+        }
+        return;
+    }
+    // Typ kolumny nie jest tu znany, więc liczbowa stała porównywana jest jak w compareValues (tryb Mixed).
+    long long number;
+    CompareOp compareOp = parseCompareOp(op);
+    CompareMode mode = chooseCompareMode(ColumnType::String, compareOp, value, number);
+    dispatchComparison(mode, compareOp, [&]<CompareMode Mode, CompareOp Op>() {
+        for (std::size_t i = begin; i < end; ++i) {
+            selection[i - begin] = compareValue<Mode, Op>(column.valueAt(i), value, number);
+        }
+    });
+}
+
+
+auto writeEncodedColumn(std::ostream &out, const EncodedColumn &column) -> void {
+    writeU64(out, static_cast<std::uint64_t>(column.encoding));
+    writeU64(out, column.size);
+    writeU64(out, column.values.size());
+    for (const auto &value: column.values) {
+        writeString(out, value);
+    }
+    writeU64(out, column.runEnds.size());
+    for (auto runEnd: column.runEnds) {
+        writeU64(out, runEnd);
+    }
+    writeI64(out, column.base);
+    writeU64(out, static_cast<std::uint64_t>(column.bitWidth));
+    writeU64(out, column.packed.size());
+    for (auto word: column.packed) {
+        writeU64(out, word);
+    }
+    writeU64(out, column.checkpoints.size());
+    for (auto checkpoint: column.checkpoints) {
+        writeI64(out, checkpoint);
+    }
+}
+
+auto readEncodedColumn(std::istream &in) -> EncodedColumn {
+    EncodedColumn column;
+    std::uint64_t encoding = readU64(in);
+    if (encoding > static_cast<std::uint64_t>(Encoding::Delta)) {
+        throw std::runtime_error("Corrupted snapshot file: unknown column encoding");
+    }
+    column.encoding = static_cast<Encoding>(encoding);
+    column.size = readU64(in);
+    column.values.resize(readU64(in));
+    for (auto &value: column.values) {
+        value = readString(in);
+    }
+    column.runEnds.resize(readU64(in));
+    for (auto &runEnd: column.runEnds) {
+        runEnd = readU64(in);
+    }
+    column.base = readI64(in);
+    column.bitWidth = static_cast<int>(readU64(in));
+    column.packed.resize(readU64(in));
+    for (auto &word: column.packed) {
+        word = readU64(in);
+    }
+    column.checkpoints.resize(readU64(in));
+    for (auto &checkpoint: column.checkpoints) {
+        checkpoint = readI64(in);
+    }
+    return column;
+}
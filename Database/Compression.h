@@ -0,0 +1,52 @@
+#ifndef DATABASE2_COMPRESSION_H
+#define DATABASE2_COMPRESSION_H
+#pragma once
+#include "Prerequestion.h"
+#include "Column.h"
+#include <cstdint>
+
+enum class Encoding : std::uint8_t {
+    Plain = 0,
+    RunLength = 1,
+    Dictionary = 2,
+    BitPacked = 3,
+    Delta = 4
+};
+
+/*
+ * Jedna skompresowana kolumna. Kodowanie wybiera chooseEncoding na podstawie statystyk danych:
+ *  - RunLength: wartości + końce serii (bool, kolumny o małej liczbie serii),
+ *  - Dictionary: posortowany słownik + upakowane bitowo kody (napisy),
+ *  - BitPacked: frame-of-reference, kod = wartość - base + 1, kod 0 oznacza puste pole (int),
+ *  - Delta: pierwsza wartość + upakowane różnice w kodzie zigzag, z punktami kontrolnymi co DELTA_CHECKPOINT.
+ */
+struct EncodedColumn {
+    static constexpr std::size_t DELTA_CHECKPOINT = 128;
+
+    Encoding encoding = Encoding::Plain;
+    std::size_t size = 0;
+    std::vector<std::string> values;        // Plain, wartości serii (RunLength) albo słownik (Dictionary)
+    std::vector<std::uint64_t> runEnds;     // RunLength: indeks za ostatnim wierszem serii
+    long long base = 0;                     // BitPacked: minimum, Delta: pierwsza wartość
+    int bitWidth = 0;
+    std::vector<std::uint64_t> packed;      // Dictionary/BitPacked/Delta
+    std::vector<long long> checkpoints;     // Delta
+
+    auto valueAt(std::size_t index) const -> std::string;
+    auto decode() const -> std::vector<std::string>;
+    auto byteSize() const -> std::size_t;
+};
+
+auto encodingName(Encoding encoding) -> std::string;
+auto chooseEncoding(const std::vector<std::string> &values, ColumnType columnType) -> Encoding;
+auto encodeColumn(const std::vector<std::string> &values, Encoding encoding) -> EncodedColumn;
+auto encodeColumn(const std::vector<std::string> &values, ColumnType columnType) -> EncodedColumn;
+
+// Ustawia selection[i - begin] na wynik porównania wiersza i, bez rozpakowywania do napisów, gdzie się da.
+auto filterEncoded(const EncodedColumn &column, std::size_t begin, std::size_t end,
+                   const std::string &op, const std::string &value, std::vector<char> &selection) -> void;
+
+auto writeEncodedColumn(std::ostream &out, const EncodedColumn &column) -> void;
+auto readEncodedColumn(std::istream &in) -> EncodedColumn;
+
+#endif //DATABASE2_COMPRESSION_H
@@ -0,0 +1,94 @@
+#include "CostModel.h"
+#include "Table.h"
+#include <cmath>
+
+namespace {
+    auto cloneExpression(const Expression *expression) -> std::unique_ptr<Expression> {
+        if (expression == nullptr) {
+            return nullptr;
+        }
+        auto copy = std::make_unique<Expression>();
+        copy->column = expression->column;
+        copy->operators = expression->operators;
+        copy->value = expression->value;
+        copy->logicalOperator = expression->logicalOperator;
+        copy->left = cloneExpression(expression->left.get());
+        copy->right = cloneExpression(expression->right.get());
+        return copy;
+    }
+
+    // AND: najpierw strona najrzadziej prawdziwa, OR: najpierw strona najczęściej prawdziwa.
+    auto orderConjuncts(const TableStatistics *statistics, Expression *expression) -> void {
+        if (expression == nullptr || expression->logicalOperator.empty()) {
+            return;
+        }
+        orderConjuncts(statistics, expression->left.get());
+        orderConjuncts(statistics, expression->right.get());
+        double left = estimateSelectivity(statistics, expression->left.get());
+        double right = estimateSelectivity(statistics, expression->right.get());
+        if ((expression->logicalOperator == "AND" && right < left) ||
+            (expression->logicalOperator == "OR" && right > left)) {
+            std::swap(expression->left, expression->right);
+        }
+    }
+
+    auto leafCount(const Expression *expression) -> std::size_t {
+        if (expression == nullptr) {
+            return 0;
+        }
+        if (expression->logicalOperator.empty()) {
+            return 1;
+        }
+        return leafCount(expression->left.get()) + leafCount(expression->right.get());
+    }
+
+    /*
+     * Ułamek bloków, których mapy stref nie da się odrzucić. Dla kolumny uporządkowanej (correlation 1)
+     * pasujące wiersze leżą w sąsiednich blokach, dla losowej blok odpada tylko, gdy żaden z jego
+     * ZONE_BLOCK_ROWS wierszy nie pasuje.
+     */
+    auto blocksTouched(const TableStatistics *statistics, const Expression *expression, double blocks) -> double {
+        if (expression == nullptr) {
+            return 1.0;
+        }
+        if (expression->logicalOperator == "AND") {
+            return std::min(blocksTouched(statistics, expression->left.get(), blocks),
+                            blocksTouched(statistics, expression->right.get(), blocks));
+        }
+        if (expression->logicalOperator == "OR") {
+            return std::min(1.0, blocksTouched(statistics, expression->left.get(), blocks) +
+                                 blocksTouched(statistics, expression->right.get(), blocks));
+        }
+        const ColumnStatistics *column = statistics == nullptr ? nullptr : statistics->column(expression->column);
+        double selectivity = estimateSelectivity(statistics, expression);
+        double correlation = column == nullptr ? 0.0 : column->correlation;
+        double clustered = std::min(1.0, selectivity + 1.0 / std::max(blocks, 1.0));
+        double scattered = 1.0 - std::pow(1.0 - selectivity, static_cast<double>(ZONE_BLOCK_ROWS));
+        return correlation * clustered + (1.0 - correlation) * scattered;
+    }
+}
+
+auto AccessPlan::describe() const -> std::string {
+    std::ostringstream out;
+    out << (useZones ? "zone-map scan" : "full scan") << " (estimated rows " << std::llround(estimatedRows)
+        << ", cost scan " << std::llround(scanCost) << " / zones " << std::llround(zoneCost) << ")";
+    return out.str();
+}
+
+auto planAccess(const Table &table, const Expression *where) -> AccessPlan {
+    AccessPlan plan;
+    const TableStatistics *statistics = table.statistics.get();
+    const double rows = static_cast<double>(table.liveRowCount());
+    const double blocks = static_cast<double>(table.zones.size());
+
+    plan.predicate = cloneExpression(where);
+    orderConjuncts(statistics, plan.predicate.get());
+    plan.selectivity = estimateSelectivity(statistics, where);
+    plan.estimatedRows = plan.selectivity * rows;
+    plan.scanCost = rows * ROW_COST;
+    plan.zoneCost = blocks * ZONE_PROBE_COST * static_cast<double>(leafCount(where)) +
+                    blocksTouched(statistics, where, blocks) * rows * ROW_COST;
+    // Bez ANALYZE nie ma podstaw, by rezygnować z map stref - zostaje dotychczasowe zachowanie.
+    plan.useZones = where != nullptr && (statistics == nullptr || plan.zoneCost < plan.scanCost);
+    return plan;
+}
@@ -0,0 +1,31 @@
+#ifndef DATABASE2_COSTMODEL_H
+#define DATABASE2_COSTMODEL_H
+#pragma once
+#include "Prerequestion.h"
+#include "Expression.h"
+#include "TableStatistics.h"
+
+struct Table;
+
+// Koszt w umownych jednostkach: sprawdzenie jednego wiersza vs. sprawdzenie mapy stref jednego bloku.
+constexpr double ROW_COST = 1.0;
+constexpr double ZONE_PROBE_COST = 4.0;
+
+/*
+ * Plan dostępu do tabeli dla WHERE: pełny skan albo skan z odrzucaniem bloków po mapach stref,
+ * oraz predykat z koniunkcjami uporządkowanymi od najbardziej selektywnej (krótsze wartościowanie AND).
+ */
+struct AccessPlan {
+    bool useZones = true;
+    double selectivity = 1.0;
+    double estimatedRows = 0.0;
+    double scanCost = 0.0;
+    double zoneCost = 0.0;
+    std::unique_ptr<Expression> predicate;
+
+    auto describe() const -> std::string;
+};
+
+auto planAccess(const Table &table, const Expression *where) -> AccessPlan;
+
+#endif //DATABASE2_COSTMODEL_H
@@ -1,5 +1,12 @@
 #include "Database.h"
 #include "Row.h"
+#include "Trace.h"
+#include "Cancellation.h"
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <map>
 
 
 auto findTable(std::vector<Table> &tables, const std::string &tableName) {
@@ -14,6 +21,48 @@ auto Database::createTable(const std::string &tableName, const std::vector<Colum
     }
 
     tables.push_back({tableName, columns, {}});
+    touch(tables.back());
+}
+
+auto Database::createTable(const std::string &tableName, const std::vector<Column> &columns,
+                           const PartitionScheme &scheme) -> void {
+    auto key = std::ranges::find_if(columns, [&scheme](const Column &column) {
+        return column.name == scheme.column;
+    });
+    if (key == columns.end()) {
+        throw std::runtime_error("Partition key column not found: " + scheme.column);
+    }
+    if (scheme.method == PartitionMethod::Range && (key->type != ColumnType::Int || scheme.width <= 0)) {
+        throw std::runtime_error("RANGE partitioning needs an int key column and a positive EVERY width");
+    }
+    if (scheme.method == PartitionMethod::Hash && (scheme.count == 0 || scheme.count > MAX_HASH_PARTITIONS)) {
+        throw std::runtime_error("HASH partitioning needs between 1 and " + std::to_string(MAX_HASH_PARTITIONS) +
+                                 " partitions");
+    }
+
+    createTable(tableName, columns);
+    tables.back().partitioning = scheme;
+    if (scheme.method == PartitionMethod::Hash) {
+        for (std::size_t bucket = 0; bucket < scheme.count; ++bucket) {
+            ensurePartition({tableName, static_cast<long long>(bucket), false});
+        }
+    }
+}
+
+namespace {
+    thread_local std::ostream *currentOutput = nullptr;
+}
+
+auto statementOutput() -> std::ostream & {
+    return currentOutput != nullptr ? *currentOutput : std::cout;
+}
+
+StatementOutput::StatementOutput(std::ostream &stream) : previous(currentOutput) {
+    currentOutput = &stream;
+}
+
+StatementOutput::~StatementOutput() {
+    currentOutput = previous;
 }
 
 auto Database::deleteTable(const std::string &tableName) -> void {
@@ -22,163 +71,2183 @@ auto Database::deleteTable(const std::string &tableName) -> void {
         throw std::runtime_error("Table not found.");
     }
 
-    tables.erase(it);
+    for (const auto &table: tables) {
+        if (table.view && table.view->base == tableName) {
+            throw std::runtime_error("Materialized view " + table.name + " depends on " + tableName + "; DROP " +
+                                     table.name + " first");
+        }
+    }
+
+    auto partitionOf = [&tableName](const Table &table) {
+        return table.partition && table.partition->parent == tableName;
+    };
+    preserveDropped(*it);
+    for (auto &table: tables) {
+        if (partitionOf(table)) {
+            preserveDropped(table);
+        }
+    }
+    tables.erase(it);
+    std::erase_if(tables, partitionOf);
+}
+
+auto Database::addColumn(const std::string &tableName, const Column &column) -> void {
+    auto it = findTable(tables, tableName);
+    if (it == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    checkWritable(*it);
+    if (it->findColumn(column.name) != nullptr) {
+        throw std::runtime_error("Column already exists.");
+    }
+    if (!column.defaultValue.empty() && !matchesType(column.type, column.defaultValue)) {
+        throw std::runtime_error("Data type mismatch for default value of column: " + column.name);
+    }
+
+    // Tylko metadane: istniejące wiersze nie mają tego miejsca i zwracają defaultValue.
+    Column added = column;
+    added.ordinal = it->nextOrdinal++;
+    it->columns.push_back(added);
+    ++it->schemaVersion;
+    touch(*it);
+    for (Table *partition: partitionsOf(tableName)) {
+        addColumn(partition->name, column);
+    }
+}
+
+auto Database::removeColumn(const std::string &tableName, const std::string &columnName) -> void {
+    auto it = findTable(tables, tableName);
+    if (it == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+
+    auto colIt = std::ranges::find_if(it->columns.begin(), it->columns.end(), [&columnName](const Column &column) {
+        return column.name == columnName;
+    });
+
+    if (colIt == it->columns.end()) {
+        throw std::runtime_error("Column not found.");
+    }
+    checkWritable(*it);
+    if (it->partitioning && it->partitioning->column == columnName) {
+        throw std::runtime_error("Cannot remove partition key column: " + columnName);
+    }
+    for (const auto &table: tables) {
+        if (table.view && table.view->base == tableName && viewUsesColumn(*table.view, columnName)) {
+            throw std::runtime_error("Column " + columnName + " is used by materialized view " + table.name);
+        }
+    }
+    for (Table *partition: partitionsOf(tableName)) {
+        removeColumn(partition->name, columnName);
+    }
+
+    std::erase_if(it->indexes, [&columnName](const TrigramIndex &index) {
+        return index.column == columnName;
+    });
+    // Miejsce kolumny w wierszach staje się martwe; dane zwolni Compactor w tle.
+    it->deadOrdinals.push_back(colIt->ordinal);
+    it->columns.erase(colIt);
+    ++it->schemaVersion;
+    touch(*it);
+}
+
+
+auto Database::insertInto(const std::string &tableName, const std::string &columnName, Row inputRow) -> void {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+    checkMemory("INSERT");
+
+    checkWritable(*tableIt);
+    const Column *column = tableIt->findColumn(columnName);
+    if (column == nullptr) {
+        throw std::runtime_error("Column not found: " + columnName);
+    }
+
+    if (inputRow.Data.size() != 1) {
+        throw std::runtime_error("Input row should have exactly one value for the specified column");
+    }
+
+    std::string &data = inputRow.Data[0];
+    if (!matchesType(column->type, data)) {
+        throw std::runtime_error("Data type mismatch for column: " + columnName);
+    }
+    if (tableIt->partitioning) {
+        insertPartitioned(tableName, columnName, std::move(inputRow));
+        return;
+    }
+    touch(*tableIt);
+    if (fillEmptyCell(*tableIt, *column, data)) {
+        return;
+    }
+    if (tableIt->paged) {
+        std::vector<std::vector<std::string>> values{{data}};
+        appendPaged(*tableIt, {column}, values);
+    } else {
+        Row newRow(tableIt->columns);
+        newRow.widen(tableIt->nextOrdinal);
+        newRow.setValue(*column, data);
+        tableIt->rows.push_back(newRow);
+        noteRowAppended(*tableIt);
+    }
+    if (hasViews(*tableIt)) {
+        maintainViews(*tableIt, {}, rowImages(*tableIt, {tableIt->rowCount() - 1}));
+    }
+    statementOutput() << "Data inserting into columns in: " + tableName << std::endl;
+}
+
+// INSERT wypełnia pierwszą pustą komórkę kolumny w żywym wierszu; false - nie ma takiej komórki.
+auto Database::fillEmptyCell(Table &table, const Column &column, const std::string &value) -> bool {
+    std::optional<std::size_t> filled;
+    if (table.paged) {
+        filled = insertPaged(table, column, value);
+    } else {
+        materialize(table);
+        for (std::size_t i = 0; i < table.rows.size(); ++i) {
+            auto &row = table.rows[i];
+            if (!table.isDeleted(i) && row.canUpdate(column)) {
+                logCell(table, i, column);
+                row.setValue(column, value);
+                noteCellChanged(table, i, column, "", value);
+                filled = i;
+                break;
+            }
+        }
+    }
+    if (filled) {
+        reindexCells(table, column.name, {*filled});
+    }
+    if (filled && hasViews(table)) {
+        // Przed INSERT komórka była pusta - reszta wiersza się nie zmieniła.
+        std::vector<RowImage> after = rowImages(table, {*filled});
+        std::vector<RowImage> before = after;
+        before[0][&column - table.columns.data()].clear();
+        maintainViews(table, before, after);
+    }
+    return filled.has_value();
+}
+
+// Wstawianie wsadowe (API osadzone): każdy wiersz jest nowy, a kolumny spoza wsadu dostają pustą wartość
+// jak przy INSERT. Typy sprawdzane są przed pierwszą zmianą, więc błąd nie zostawia połowy wsadu.
+auto Database::appendRows(const std::string &tableName, const std::vector<std::string> &columnNames,
+                          std::vector<std::vector<std::string>> columnValues) -> std::size_t {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+    if (columnNames.size() != columnValues.size()) {
+        throw std::runtime_error("Each appended column needs its values");
+    }
+    if (columnNames.empty()) {
+        return 0;
+    }
+    checkWritable(*tableIt);
+    checkMemory("Append");
+    std::vector<const Column *> targets = appendTargets(*tableIt, columnNames, columnValues);
+
+    std::size_t count = columnValues.front().size();
+    if (tableIt->partitioning) {
+        appendPartitioned(tableName, columnNames, std::move(columnValues));
+        return count;
+    }
+    touch(*tableIt);
+    std::size_t first = tableIt->rowCount();
+    if (tableIt->paged) {
+        appendPaged(*tableIt, targets, columnValues);
+    } else {
+        materialize(*tableIt);
+        tableIt->rows.reserve(tableIt->rows.size() + count);
+        for (std::size_t r = 0; r < count; ++r) {
+            Row newRow(tableIt->columns);
+            newRow.widen(tableIt->nextOrdinal);
+            for (std::size_t c = 0; c < targets.size(); ++c) {
+                newRow.Data[targets[c]->ordinal] = std::move(columnValues[c][r]);
+            }
+            tableIt->rows.push_back(std::move(newRow));
+            noteRowAppended(*tableIt);
+        }
+    }
+    if (hasViews(*tableIt)) {
+        maintainViews(*tableIt, {}, rowImages(*tableIt, liveRows(*tableIt, first)));
+    }
+    return count;
+}
+
+auto Database::appendTargets(const Table &table, const std::vector<std::string> &columnNames,
+                             const std::vector<std::vector<std::string>> &columnValues)
+-> std::vector<const Column *> {
+    std::vector<const Column *> targets;
+    for (std::size_t c = 0; c < columnNames.size(); ++c) {
+        const Column *column = table.findColumn(columnNames[c]);
+        if (column == nullptr) {
+            throw std::runtime_error("Column not found: " + columnNames[c]);
+        }
+        if (std::ranges::find(targets, column) != targets.end()) {
+            throw std::runtime_error("Column appended twice: " + columnNames[c]);
+        }
+        if (columnValues[c].size() != columnValues.front().size()) {
+            throw std::runtime_error("Appended columns differ in length");
+        }
+        // Typ rozstrzygany raz na kolumnę wsadu; string przyjmuje każdą wartość.
+        bool valid = true;
+        if (column->type == ColumnType::Int) {
+            valid = std::ranges::all_of(columnValues[c], [this](const std::string &value) { return isInteger(value); });
+        } else if (column->type == ColumnType::Bool) {
+            valid = std::ranges::all_of(columnValues[c], [this](const std::string &value) { return isBoolean(value); });
+        }
+        if (!valid) {
+            throw std::runtime_error("Data type mismatch for column: " + column->name);
+        }
+        targets.push_back(column);
+    }
+    return targets;
+}
+
+
+auto
+Database::update(const std::string &tableName, const std::string &columnName, const std::string &newValue) -> void {
+    Assignment assignment;
+    assignment.value = newValue;
+    update(tableName, columnName, assignment, nullptr);
+}
+
+namespace {
+    // GCC i Clang mają wbudowane sprawdzanie przepełnienia; gdzie go nie ma (MSVC), porównujemy z granicami typu
+    // przed wykonaniem działania.
+    auto addOverflows(long long a, long long b, long long *result) -> bool {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_add_overflow(a, b, result);
+#else
+        if ((b > 0 && a > std::numeric_limits<long long>::max() - b) ||
+            (b < 0 && a < std::numeric_limits<long long>::min() - b)) {
+            return true;
+        }
+        *result = a + b;
+        return false;
+#endif
+    }
+
+    auto subOverflows(long long a, long long b, long long *result) -> bool {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_sub_overflow(a, b, result);
+#else
+        if ((b < 0 && a > std::numeric_limits<long long>::max() + b) ||
+            (b > 0 && a < std::numeric_limits<long long>::min() + b)) {
+            return true;
+        }
+        *result = a - b;
+        return false;
+#endif
+    }
+
+    auto mulOverflows(long long a, long long b, long long *result) -> bool {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_mul_overflow(a, b, result);
+#else
+        constexpr long long max = std::numeric_limits<long long>::max();
+        constexpr long long min = std::numeric_limits<long long>::min();
+        if (a > 0 ? (b > 0 ? a > max / b : b < min / a) : (b > 0 ? a < min / b : a != 0 && b < max / a)) {
+            return true;
+        }
+        *result = a * b;
+        return false;
+#endif
+    }
+
+    // Kernel arytmetyki UPDATE na już sparsowanych liczbach jednego wsadu; operation zwraca true przy przepełnieniu.
+    template<typename Operation>
+    auto computeArithmetic(std::vector<long long> &values, long long operand, Operation operation) -> bool {
+        bool overflow = false;
+        for (auto &value: values) {
+            overflow |= operation(value, operand, &value);
+        }
+        return overflow;
+    }
+
+    // true - któraś wartość się przepełniła (values są wtedy częściowo niepoprawne).
+    auto computeArithmetic(std::vector<long long> &values, const std::string &arithmeticOperator, long long operand)
+    -> bool {
+        if (arithmeticOperator == "+") {
+            return computeArithmetic(values, operand, addOverflows);
+        }
+        if (arithmeticOperator == "-") {
+            return computeArithmetic(values, operand, subOverflows);
+        }
+        if (arithmeticOperator == "*") {
+            return computeArithmetic(values, operand, mulOverflows);
+        }
+        if (arithmeticOperator == "/") {
+            // LLONG_MIN / -1 nie mieści się w long long (na x86 dzielenie kończy proces).
+            return computeArithmetic(values, operand, [](long long a, long long b, long long *result) {
+                if (b == -1 && a == std::numeric_limits<long long>::min()) {
+                    return true;
+                }
+                *result = a / b;
+                return false;
+            });
+        }
+        throw std::runtime_error("Unknown arithmetic operator: " + arithmeticOperator);
+    }
+
+    auto applyArithmetic(std::vector<long long> &values, const std::string &arithmeticOperator, long long operand)
+    -> void {
+        if (computeArithmetic(values, arithmeticOperator, operand)) {
+            throw std::runtime_error("Integer overflow in UPDATE");
+        }
+    }
+
+    auto zoneOf(const std::vector<std::string> &values) -> ColumnZone {
+        ColumnZone zone;
+        for (const auto &value: values) {
+            zone.add(value);
+        }
+        return zone;
+    }
+}
+
+auto Database::update(const std::string &tableName, const std::string &columnName, const Assignment &assignment,
+                      const std::unique_ptr<Expression> &where) -> void {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    checkWritable(*tableIt);
+    checkMemory("UPDATE");
+    ensureLoaded(*tableIt);
+
+    const Column *column = tableIt->findColumn(columnName);
+    if (column == nullptr) {
+        throw std::runtime_error("Column not found.");
+    }
+    const Column *source = nullptr;
+    if (assignment.isArithmetic()) {
+        source = tableIt->findColumn(assignment.sourceColumn);
+        if (source == nullptr) {
+            throw std::runtime_error("Column not found: " + assignment.sourceColumn);
+        }
+        if (column->type != ColumnType::Int || source->type != ColumnType::Int) {
+            throw std::runtime_error("Arithmetic UPDATE requires int columns");
+        }
+        if (assignment.arithmeticOperator == "/" && assignment.operand == 0) {
+            throw std::runtime_error("Division by zero in UPDATE");
+        }
+    } else if (!matchesType(column->type, assignment.value)) {
+        throw std::runtime_error("Data type mismatch for column: " + columnName);
+    }
+    if (tableIt->partitioning) {
+        // Zmiana klucza musiałaby przenosić wiersze między partycjami.
+        if (columnName == tableIt->partitioning->column) {
+            throw std::runtime_error("Cannot UPDATE partition key column: " + columnName);
+        }
+        std::vector<Table *> partitions = partitionsOf(tableName, where.get());
+        // Przepełnienie w dalszej partycji nie może zostawić wcześniejszych już zmienionych.
+        if (assignment.isArithmetic()) {
+            for (Table *partition: partitions) {
+                ensureLoaded(*partition);
+                checkArithmetic(*partition, assignment, where, nullptr);
+            }
+        }
+        for (Table *partition: partitions) {
+            update(partition->name, columnName, assignment, where);
+        }
+        return;
+    }
+
+    bool viewed = hasViews(*tableIt);
+    if (!where && !assignment.isArithmetic()) {
+        enterWritePhase();
+        touch(*tableIt);
+        std::vector<std::size_t> live = viewed ? liveRows(*tableIt) : std::vector<std::size_t>();
+        std::vector<RowImage> before = rowImages(*tableIt, live);
+        updateWholeColumn(*tableIt, *column, assignment.value);
+        if (TrigramIndex *index = tableIt->findIndex(columnName)) {
+            index->clear();
+        }
+        if (viewed) {
+            maintainViews(*tableIt, before, rowImages(*tableIt, live));
+        }
+        return;
+    }
+
+    // Pozycje wybieramy jeszcze przed materializacją - skompresowana tabela, w której nic nie pasuje,
+    // zostaje nietknięta.
+    QueryProfile counters;
+    std::vector<std::size_t> matches = matchingRows(*tableIt, where, counters);
+    Stats::instance().addRowsScanned(counters.rowsScanned);
+    Stats::instance().addRowsMatched(matches.size());
+    if (matches.empty()) {
+        return;
+    }
+    if (assignment.isArithmetic()) {
+        checkArithmetic(*tableIt, assignment, where, &matches);
+    }
+    enterWritePhase();
+    touch(*tableIt);
+    std::vector<RowImage> before = viewed ? rowImages(*tableIt, matches) : std::vector<RowImage>();
+    if (tableIt->paged) {
+        updatePaged(*tableIt, *column, source, assignment, matches);
+    } else {
+        updateRows(*tableIt, columnName, assignment, matches);
+    }
+    reindexCells(*tableIt, columnName, matches);
+    if (viewed) {
+        maintainViews(*tableIt, before, rowImages(*tableIt, matches));
+    }
+}
+
+// Zmiany zapisywane są wsadami po blokach, więc przepełnienie wykryte w dalszym bloku zostawiłoby wcześniejsze
+// zmienione. Zwykle wystarczą min/max stref kolumny źródłowej (+, -, * i / są monotoniczne względem wartości),
+// a wartości wierszy czytane są tylko wtedy, gdy strefy nie wykluczają przepełnienia.
+auto Database::checkArithmetic(Table &table, const Assignment &assignment, const std::unique_ptr<Expression> &where,
+                               const std::vector<std::size_t> *matches) -> void {
+    const Column *source = table.findColumn(assignment.sourceColumn);
+    if (source == nullptr) {
+        throw std::runtime_error("Column not found: " + assignment.sourceColumn);
+    }
+    if (zonesMatchRows(table)) {
+        auto blockFits = [&](std::size_t block) {
+            ColumnZone zone = zoneColumn(table, block, *source);
+            std::vector<long long> bounds{zone.minNumber, zone.maxNumber};
+            return zone.numericCount == 0 ||
+                   !computeArithmetic(bounds, assignment.arithmeticOperator, assignment.operand);
+        };
+        bool fits = true;
+        if (matches == nullptr) {
+            for (std::size_t block = 0; block < table.zones.size() && fits; ++block) {
+                fits = blockFits(block);
+            }
+        } else {
+            std::size_t checked = table.zones.size();
+            for (std::size_t row: *matches) {
+                if (row / ZONE_BLOCK_ROWS != checked) {
+                    checked = row / ZONE_BLOCK_ROWS;
+                    if (!blockFits(checked)) {
+                        fits = false;
+                        break;
+                    }
+                }
+            }
+        }
+        if (fits) {
+            return;
+        }
+    }
+
+    std::vector<std::size_t> selected;
+    if (matches == nullptr) {
+        QueryProfile counters;
+        selected = matchingRows(table, where, counters);
+        matches = &selected;
+    }
+    std::vector<long long> numbers;
+    numbers.reserve(matches->size());
+    for (std::size_t row: *matches) {
+        long long number;
+        if (parseNumber(table.valueAt(row, *source), number)) {
+            numbers.push_back(number);
+        }
+    }
+    applyArithmetic(numbers, assignment.arithmeticOperator, assignment.operand);
+}
+
+// Zmiany nakładamy wsadami po blokach stref, a arytmetykę liczymy na tablicy liczb, nie na napisach.
+auto Database::updateRows(Table &table, const std::string &columnName, const Assignment &assignment,
+                          const std::vector<std::size_t> &matches) -> void {
+    materialize(table);
+    // materialize mógł przenumerować miejsca kolumn.
+    const Column *column = table.findColumn(columnName);
+    const Column *source = assignment.isArithmetic() ? table.findColumn(assignment.sourceColumn) : nullptr;
+
+    std::vector<std::size_t> batch;
+    std::vector<long long> numbers;
+    for (std::size_t first = 0; first < matches.size();) {
+        std::size_t block = matches[first] / ZONE_BLOCK_ROWS;
+        batch.clear();
+        for (; first < matches.size() && matches[first] / ZONE_BLOCK_ROWS == block; ++first) {
+            batch.push_back(matches[first]);
+        }
+
+        if (source == nullptr) {
+            for (std::size_t rowIndex: batch) {
+                Row &row = table.rows[rowIndex];
+                std::string oldValue = row.value(*column);
+                logCell(table, rowIndex, *column);
+                row.setValue(*column, assignment.value);
+                noteCellChanged(table, rowIndex, *column, oldValue, assignment.value);
+            }
+            continue;
+        }
+
+        // Puste komórki (brak wartości) zostają puste.
+        std::size_t kept = 0;
+        numbers.clear();
+        for (std::size_t rowIndex: batch) {
+            long long number;
+            if (parseNumber(table.rows[rowIndex].value(*source), number)) {
+                batch[kept++] = rowIndex;
+                numbers.push_back(number);
+            }
+        }
+        batch.resize(kept);
+        applyArithmetic(numbers, assignment.arithmeticOperator, assignment.operand);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            Row &row = table.rows[batch[i]];
+            std::string oldValue = row.value(*column);
+            std::string newValue = std::to_string(numbers[i]);
+            logCell(table, batch[i], *column);
+            row.setValue(*column, newValue);
+            noteCellChanged(table, batch[i], *column, oldValue, newValue);
+        }
+    }
+}
+
+auto Database::updateWholeColumn(Table &table, const Column &column, const std::string &newValue) -> void {
+    if (table.paged) {
+        if (!zonesMatchRows(table)) {
+            rebuildZones(table);
+        }
+        for (std::size_t block = 0; block < table.zones.size(); ++block) {
+            std::size_t rows = table.paged->blockRows(block);
+            table.paged->writeBlock(column, block, std::vector<std::string>(rows, newValue));
+            ColumnZone zone;
+            zone.addRepeated(newValue, rows);
+            ensureZoneColumn(table, block, column) = zone;
+        }
+        return;
+    }
+    materialize(table);
+    const Column *target = table.findColumn(column.name);
+    for (std::size_t i = 0; i < table.rows.size(); ++i) {
+        logCell(table, i, *target);
+        table.rows[i].setValue(*target, newValue);
+    }
+
+    // Cała kolumna dostaje jedną wartość, więc strefy tej kolumny liczymy od nowa zamiast je poszerzać.
+    if (!zonesMatchRows(table)) {
+        rebuildZones(table);
+        return;
+    }
+    for (std::size_t block = 0; block < table.zones.size(); ++block) {
+        ColumnZone zone;
+        std::size_t begin = block * ZONE_BLOCK_ROWS;
+        zone.addRepeated(newValue, std::min(begin + ZONE_BLOCK_ROWS, table.rows.size()) - begin);
+        ensureZoneColumn(table, block, *target) = zone;
+    }
+}
+auto Database::deleteDataFromColumn(const std::string &tableName, const std::string &columnName,
+                                    const std::string &dataToDelete) -> void {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    checkWritable(*tableIt);
+    ensureLoaded(*tableIt);
+
+    const Column *column = tableIt->findColumn(columnName);
+    if (column == nullptr) {
+        throw std::runtime_error("Column not found.");
+    }
+    if (tableIt->partitioning) {
+        if (columnName == tableIt->partitioning->column) {
+            throw std::runtime_error("Cannot clear partition key values; DELETE FROM " + tableName +
+                                     " WHERE ... removes whole rows");
+        }
+        // Partycje, których strefy wykluczają tę wartość, nie są rozpakowywane ani przepisywane.
+        Expression probe{columnName, "=", dataToDelete, nullptr, nullptr, ""};
+        for (Table *partition: partitionsOf(tableName)) {
+            if (zonesMayMatch(*partition, &probe)) {
+                deleteDataFromColumn(partition->name, columnName, dataToDelete);
+            }
+        }
+        return;
+    }
+    touch(*tableIt);
+    std::vector<std::size_t> cleared;
+    if (hasViews(*tableIt)) {
+        for (std::size_t i: liveRows(*tableIt)) {
+            if (tableIt->valueAt(i, *column) == dataToDelete) {
+                cleared.push_back(i);
+            }
+        }
+    }
+    std::vector<RowImage> before = rowImages(*tableIt, cleared);
+    if (tableIt->paged) {
+        for (std::size_t block = 0; block < tableIt->zones.size(); ++block) {
+            std::vector<std::string> values = tableIt->paged->blockValues(*column, block);
+            bool changed = false;
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (!tableIt->isDeleted(block * ZONE_BLOCK_ROWS + i) && values[i] == dataToDelete) {
+                    values[i].clear();
+                    changed = true;
+                }
+            }
+            if (changed) {
+                tableIt->paged->writeBlock(*column, block, values);
+                ensureZoneColumn(*tableIt, block, *column) = zoneOf(values);
+            }
+        }
+    } else {
+        materialize(*tableIt);
+        column = tableIt->findColumn(columnName);
+
+        for (std::size_t i = 0; i < tableIt->rows.size(); ++i) {
+            auto &row = tableIt->rows[i];
+            if (!tableIt->isDeleted(i) && row.value(*column) == dataToDelete) {
+                logCell(*tableIt, i, *column);
+                row.setValue(*column, "");
+                noteCellChanged(*tableIt, i, *column, dataToDelete, "");
+            }
+        }
+    }
+    if (!cleared.empty()) {
+        maintainViews(*tableIt, before, rowImages(*tableIt, cleared));
+    }
+}
+
+
+auto Database::deleteRows(const std::string &tableName, const std::unique_ptr<Expression> &where) -> void {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    checkWritable(*tableIt);
+    if (tableIt->partitioning) {
+        for (Table *partition: partitionsOf(tableName, where.get())) {
+            deleteRows(partition->name, where);
+        }
+        return;
+    }
+    ensureLoaded(*tableIt);
+
+    // Wiersze tylko oznaczamy - także w tabeli skompresowanej, bez jej rozpakowywania.
+    QueryProfile counters;
+    std::vector<std::size_t> matches = matchingRows(*tableIt, where, counters);
+    Stats::instance().addRowsScanned(counters.rowsScanned);
+    Stats::instance().addRowsMatched(matches.size());
+    if (matches.empty()) {
+        return;
+    }
+    enterWritePhase();
+    if (tableIt->deleted.size() < tableIt->rowCount()) {
+        tableIt->deleted.resize(tableIt->rowCount(), false);
+    }
+    for (std::size_t rowIndex: matches) {
+        tableIt->deleted[rowIndex] = true;
+        ++tableIt->zones[rowIndex / ZONE_BLOCK_ROWS].deletedRows;
+    }
+    tableIt->deletedCount += matches.size();
+    touch(*tableIt);
+    if (hasViews(*tableIt)) {
+        maintainViews(*tableIt, rowImages(*tableIt, matches), {});
+    }
+}
+
+// Fizycznie usuwa wiersze oznaczone w bitmapie; indeksy wierszy się przesuwają, więc strefy liczymy od nowa.
+auto Database::purgeDeletedRows(Table &table) -> void {
+    for (auto &index: table.indexes) {
+        index.clear();
+    }
+    table.viewRows.reset();
+    if (table.paged) {
+        rebuildPaged(table);
+        return;
+    }
+    if (table.compressed) {
+        for (const auto &column: table.columns) {
+            if (!table.hasEncoded(column)) {
+                continue;
+            }
+            std::vector<std::string> values = table.encoded[column.ordinal].decode();
+            std::vector<std::string> live;
+            live.reserve(table.liveRowCount());
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (!table.isDeleted(i)) {
+                    live.push_back(std::move(values[i]));
+                }
+            }
+            table.encoded[column.ordinal] = encodeColumn(live, column.type);
+        }
+        table.encodedRowCount = table.liveRowCount();
+    } else {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < table.rows.size(); ++i) {
+            if (!table.isDeleted(i)) {
+                if (kept != i) {
+                    table.rows[kept] = std::move(table.rows[i]);
+                }
+                ++kept;
+            }
+        }
+        table.rows.erase(table.rows.begin() + static_cast<std::ptrdiff_t>(kept), table.rows.end());
+        table.rebindRows();
+        // Kursor kompakcji kolumn odnosi się do starych indeksów.
+        table.compactionCursor = 0;
+    }
+    table.deleted.clear();
+    table.deletedCount = 0;
+    rebuildZones(table);
+}
+
+auto Database::select(const std::string &tableName, const std::vector<std::string> &columns,
+                      const std::string &whereClause, QueryProfile *profile, const TableSample *sample)
+-> std::vector<Row> {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    checkMemory("SELECT");
+    Parser parser;
+
+    // EXPLAIN ANALYZE (profile) zawsze wykonuje zapytanie naprawdę, a próba za każdym razem jest inna.
+    std::string cacheKey;
+    if (profile == nullptr && sample == nullptr) {
+        cacheKey = ResultCache::key(tableName, columns, parser.tokenize(whereClause, ' '));
+        // Tabela partycjonowana nie ma własnych wpisów - wyniki trzymane są osobno dla każdej partycji.
+        if (auto cached = tableIt->partitioning ? std::nullopt : cachedRows(*tableIt, cacheKey)) {
+            return std::move(*cached);
+        }
+    }
+
+    std::unique_ptr<Expression> whereExpression;
+    if (!whereClause.empty()) {
+        whereExpression = parser.parseWhereClause(whereClause);
+    }
+    if (tableIt->partitioning) {
+        return selectPartitioned(tableName, columns, whereExpression, profile, cacheKey, sample);
+    }
+    return selectRows(*tableIt, columns, whereExpression, profile, cacheKey, sample);
+}
+
+auto Database::select(const std::string &tableName, const std::vector<std::string> &columns,
+                      const std::unique_ptr<Expression> &where, QueryProfile *profile) -> std::vector<Row> {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    checkMemory("SELECT");
+    std::string cacheKey;
+    if (profile == nullptr) {
+        cacheKey = ResultCache::key(tableName, columns, where.get());
+        if (auto cached = tableIt->partitioning ? std::nullopt : cachedRows(*tableIt, cacheKey)) {
+            return std::move(*cached);
+        }
+    }
+    if (tableIt->partitioning) {
+        return selectPartitioned(tableName, columns, where, profile, cacheKey);
+    }
+    return selectRows(*tableIt, columns, where, profile, cacheKey);
+}
+
+auto Database::approximate(const std::string &tableName, const ApproxAggregate &aggregate,
+                           const std::string &whereClause, const TableSample *sample) -> ApproxResult {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    const Column *column = tableIt->findColumn(aggregate.column);
+    if (column == nullptr) {
+        throw std::runtime_error("Error: Column name '" + aggregate.column + "' not found in Row::getValue");
+    }
+    if (aggregate.function == ApproxFunction::Quantile && column->type != ColumnType::Int) {
+        throw std::runtime_error("APPROX_QUANTILE needs an int column: " + aggregate.column);
+    }
+    checkMemory("SELECT");
+    Parser parser;
+    std::unique_ptr<Expression> where = parser.parseWhereClause(whereClause);
+
+    // Partycje wykluczone przez WHERE nie mają pasujących wierszy - liczą się tylko do wszystkich wierszy tabeli.
+    std::vector<Table *> targets;
+    std::size_t rowsTotal = 0;
+    if (tableIt->partitioning) {
+        targets = partitionsOf(tableName, where.get());
+        for (const Table *partition: partitionsOf(tableName)) {
+            rowsTotal += partition->liveRowCount();
+        }
+    } else {
+        targets.push_back(&*tableIt);
+        rowsTotal = tableIt->liveRowCount();
+    }
+
+    ApproxAccumulator accumulator(aggregate);
+    std::size_t rowsNotSampled = 0;
+    for (Table *table: targets) {
+        ensureLoaded(*table);
+        QueryProfile counters;
+        std::vector<std::size_t> matches = matchingRows(*table, where, counters, sample);
+        const Column &target = *table->findColumn(aggregate.column);
+        for (std::size_t i = 0; i < matches.size(); ++i) {
+            if (i % ZONE_BLOCK_ROWS == 0) {
+                checkCancellation();
+            }
+            accumulator.add(table->valueAt(matches[i], target));
+        }
+        rowsNotSampled += counters.rowsNotSampled;
+        Stats::instance().addRowsScanned(counters.rowsScanned);
+        Stats::instance().addRowsMatched(matches.size());
+    }
+    return accumulator.result(rowsNotSampled, rowsTotal);
+}
+
+auto Database::cachedRows(const Table &table, const std::string &cacheKey) -> std::optional<std::vector<Row>> {
+    const ResultCache::Rows *cached = resultCache.lookup(cacheKey, table.version);
+    if (cached == nullptr) {
+        return std::nullopt;
+    }
+    std::vector<Row> result;
+    result.reserve(cached->size());
+    for (const auto &data: *cached) {
+        Row row(table.columns);
+        row.Data = data;
+        result.push_back(std::move(row));
+    }
+    return result;
+}
+
+auto Database::selectRows(Table &table, const std::vector<std::string> &columns,
+                          const std::unique_ptr<Expression> &whereExpression, QueryProfile *profile,
+                          const std::string &cacheKey, const TableSample *sample) -> std::vector<Row> {
+    ensureLoaded(table);
+    std::vector<Row> result;
+
+    // Najpierw wybieramy pasujące wiersze, potem je projektujemy - dzięki temu obie fazy da się zmierzyć osobno.
+    StopWatch predicateTimer;
+    QueryProfile counters;
+    std::vector<std::size_t> matches = matchingRows(table, whereExpression, counters, sample);
+    counters.predicateNanos = predicateTimer.elapsedNanos();
+
+    StopWatch projectionTimer;
+    TRACE_SPAN("Database::project");
+    std::vector<const Column *> projected;
+    for (const auto &colName: columns) {
+        const Column *column = table.findColumn(colName);
+        if (column == nullptr) {
+            throw std::runtime_error("Error: Column name '" + colName + "' not found in Row::getValue");
+        }
+        projected.push_back(column);
+    }
+
+    // Wynik jest naliczany co blok wierszy, więc limit pamięci przerywa zapytanie, zanim urośnie za bardzo.
+    QueryMemory memory;
+    memory.charge(matches.size() * (sizeof(std::size_t) + sizeof(Row)));
+    std::size_t pendingBytes = 0;
+    result.reserve(matches.size());
+    reportPhase("project", matches.size());
+    // Tabela stronicowana: bloki projektowanych kolumn są przypięte, dopóki kopiujemy z nich wiersze.
+    std::vector<PinnedPage> pages;
+    std::size_t pinnedBlock = table.zones.size();
+    for (std::size_t index: matches) {
+        Row selectedRow(table.columns);
+        if (table.paged && index / ZONE_BLOCK_ROWS != pinnedBlock) {
+            pinnedBlock = index / ZONE_BLOCK_ROWS;
+            pages.clear();
+            for (const Column *column: projected) {
+                pages.push_back(table.paged->pin(*column, pinnedBlock, true));
+            }
+        }
+        for (std::size_t k = 0; k < projected.size(); ++k) {
+            if (!table.paged) {
+                selectedRow.Data.push_back(table.valueAt(index, *projected[k]));
+            } else if (pages[k]) {
+                selectedRow.Data.push_back(pages[k]->valueAt(index - pinnedBlock * ZONE_BLOCK_ROWS));
+            } else {
+                selectedRow.Data.push_back(projected[k]->defaultValue);
+            }
+        }
+        pendingBytes += measureRow(selectedRow) - sizeof(Row);
+        result.push_back(std::move(selectedRow));
+        if (result.size() % ZONE_BLOCK_ROWS == 0) {
+            memory.charge(pendingBytes);
+            pendingBytes = 0;
+            reportProgress(ZONE_BLOCK_ROWS);
+            checkCancellation();
+        }
+    }
+    memory.charge(pendingBytes);
+
+    Stats::instance().addRowsScanned(counters.rowsScanned);
+    Stats::instance().addRowsMatched(matches.size());
+    if (profile != nullptr) {
+        counters.parseNanos = profile->parseNanos;
+        counters.projectionNanos = projectionTimer.elapsedNanos();
+        counters.rowsMatched = matches.size();
+        *profile = counters;
+    } else if (!cacheKey.empty()) {
+        ResultCache::Rows rows;
+        rows.reserve(result.size());
+        for (const auto &row: result) {
+            rows.push_back(row.Data);
+        }
+        resultCache.store(cacheKey, table.version, std::move(rows));
+    }
+    return result;
+}
+
+
+// Bloki, których min/max wyklucza predykat, pomijamy bez dotykania wierszy (o ile planAccess uzna to za
+// tańsze od pełnego skanu); tabela skompresowana jest filtrowana bezpośrednio na zakodowanych kolumnach.
+auto Database::matchingRows(Table &table, const std::unique_ptr<Expression> &where, QueryProfile &counters,
+                            const TableSample *sample) -> std::vector<std::size_t> {
+    if (!zonesMatchRows(table)) {
+        rebuildZones(table);
+    }
+    // Próba losuje bloki, więc zawężanie indeksem przy niej nie pomaga - skan i tak czyta mało.
+    if (sample == nullptr) {
+        if (auto indexed = indexScan(table, where.get(), counters)) {
+            return std::move(*indexed);
+        }
+    }
+    AccessPlan plan = planAccess(table, where.get());
+    const std::unique_ptr<Expression> &predicate = plan.predicate;
+    counters.accessPath = where ? plan.describe() : "full scan";
+    if (sample != nullptr) {
+        std::ostringstream path;
+        path << counters.accessPath << ", TABLESAMPLE " << sample->percent << "%";
+        counters.accessPath = path.str();
+    }
+    // Tabela wierszowa: predykat kompilowany raz, potem filtrowany blokami przez wybrane kernele.
+    std::unique_ptr<CompiledPredicate> compiled;
+    if (!table.compressed && !table.paged) {
+        compiled = compilePredicate(table, predicate.get());
+    }
+
+    TRACE_SPAN("Database::scan");
+    reportPhase("scan", table.rowCount());
+    std::vector<std::size_t> matches;
+    std::vector<char> selection;
+    for (std::size_t block = 0; block < table.zones.size(); ++block) {
+        std::size_t begin = block * ZONE_BLOCK_ROWS;
+        std::size_t end = std::min(begin + ZONE_BLOCK_ROWS, table.rowCount());
+        checkCancellation();
+        reportProgress(end - begin);
+        if (sample != nullptr && !sample->includes(table.name, block)) {
+            counters.rowsNotSampled += end - begin - table.zones[block].deletedRows;
+            ++counters.blocksSkipped;
+            continue;
+        }
+        if (table.zones[block].deletedRows == end - begin ||
+            (plan.useZones && !zoneMayMatch(table, table.zones[block], predicate.get()))) {
+            ++counters.blocksSkipped;
+            continue;
+        }
+        bool hasDeleted = table.zones[block].deletedRows > 0;
+        ++counters.blocksScanned;
+        counters.rowsScanned += end - begin;
+        if (table.compressed || table.paged) {
+            if (table.paged) {
+                TRACE_SPAN("predicate batch (paged)");
+                evaluatePaged(table, predicate.get(), block, end - begin, selection);
+            } else {
+                TRACE_SPAN("predicate batch (encoded)");
+                evaluateEncoded(table, predicate.get(), begin, end, selection);
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                if (selection[i - begin] && !(hasDeleted && table.isDeleted(i))) {
+                    matches.push_back(i);
+                }
+            }
+            continue;
+        }
+        if (compiled) {
+            TRACE_SPAN("predicate batch");
+            filterRows(*compiled, table.rows, begin, end, selection);
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            if (hasDeleted && table.isDeleted(i)) {
+                continue;
+            }
+            if (!compiled || selection[i - begin]) {
+                matches.push_back(i);
+            }
+        }
+    }
+    return matches;
+}
+
+namespace {
+    // Składniki LIKE na kolumnach z indeksem, do których prowadzą tylko AND - każdy z nich musi być spełniony.
+    auto indexedLikes(Table &table, const Expression *expression, std::vector<const Expression *> &leaves) -> void {
+        if (expression == nullptr || expression->logicalOperator == "OR") {
+            return;
+        }
+        if (expression->logicalOperator == "AND") {
+            indexedLikes(table, expression->left.get(), leaves);
+            indexedLikes(table, expression->right.get(), leaves);
+        } else if (expression->operators == "LIKE" && table.findIndex(expression->column) != nullptr &&
+                   TrigramIndex::narrows(expression->value)) {
+            leaves.push_back(expression);
+        }
+    }
+
+    auto rowMatches(const Table &table, const Expression *expression, std::size_t row) -> bool {
+        if (expression->logicalOperator == "AND") {
+            return rowMatches(table, expression->left.get(), row) && rowMatches(table, expression->right.get(), row);
+        }
+        if (expression->logicalOperator == "OR") {
+            return rowMatches(table, expression->left.get(), row) || rowMatches(table, expression->right.get(), row);
+        }
+        const Column *column = table.findColumn(expression->column);
+        if (column == nullptr) {
+            throw std::runtime_error("Error: Column name '" + expression->column + "' not found in Row::getValue");
+        }
+        return compareValues(table.valueAt(row, *column), expression->operators, expression->value);
+    }
+}
+
+auto Database::indexScan(Table &table, const Expression *where, QueryProfile &counters)
+-> std::optional<std::vector<std::size_t>> {
+    std::vector<const Expression *> leaves;
+    if (!table.indexes.empty()) {
+        indexedLikes(table, where, leaves);
+    }
+    if (leaves.empty()) {
+        return std::nullopt;
+    }
+    const Expression *leaf = leaves.front();
+    TrigramIndex &index = *table.findIndex(leaf->column);
+    const Column &column = *table.findColumn(leaf->column);
+    for (; index.indexedRows < table.rowCount(); ++index.indexedRows) {
+        index.add(index.indexedRows, table.valueAt(index.indexedRows, column));
+    }
+
+    std::vector<std::size_t> candidates = index.candidates(leaf->value).value_or(std::vector<std::size_t>());
+    std::vector<std::size_t> matches;
+    reportPhase("index scan", candidates.size());
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (i % ZONE_BLOCK_ROWS == 0) {
+            checkCancellation();
+            reportProgress(std::min(ZONE_BLOCK_ROWS, candidates.size() - i));
+        }
+        std::size_t row = candidates[i];
+        if (!table.isDeleted(row) && rowMatches(table, where, row)) {
+            matches.push_back(row);
+        }
+    }
+    counters.accessPath = "trigram index on " + leaf->column + " (" + std::to_string(candidates.size()) +
+                          " candidates)";
+    counters.rowsScanned += candidates.size();
+    return matches;
+}
+
+auto Database::reindexCells(Table &table, const std::string &columnName, const std::vector<std::size_t> &rows)
+-> void {
+    TrigramIndex *index = table.findIndex(columnName);
+    if (index == nullptr) {
+        return;
+    }
+    const Column &column = *table.findColumn(columnName);
+    for (std::size_t row: rows) {
+        if (row < index->indexedRows) {
+            index->add(row, table.valueAt(row, column));
+        }
+    }
+}
+
+auto Database::createIndex(const std::string &tableName, const std::string &columnName) -> void {
+    auto it = findTable(tables, tableName);
+    if (it == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    const Column *column = it->findColumn(columnName);
+    if (column == nullptr) {
+        throw std::runtime_error("Column not found.");
+    }
+    if (column->type != ColumnType::String) {
+        throw std::runtime_error("Trigram index needs a string column: " + columnName);
+    }
+    if (it->findIndex(columnName) != nullptr) {
+        throw std::runtime_error("Index already exists on " + tableName + " (" + columnName + ")");
+    }
+    // Wiersze trafiają do indeksu przy pierwszym zapytaniu z LIKE, nie tutaj.
+    it->indexes.emplace_back(columnName);
+    for (Table *partition: partitionsOf(tableName)) {
+        partition->indexes.emplace_back(columnName);
+    }
+}
+
+auto Database::dropIndex(const std::string &tableName, const std::string &columnName) -> void {
+    auto it = findTable(tables, tableName);
+    if (it == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    if (it->findIndex(columnName) == nullptr) {
+        throw std::runtime_error("No index on " + tableName + " (" + columnName + ")");
+    }
+    auto unindexed = [&columnName](const TrigramIndex &index) {
+        return index.column == columnName;
+    };
+    std::erase_if(it->indexes, unindexed);
+    for (Table *partition: partitionsOf(tableName)) {
+        std::erase_if(partition->indexes, unindexed);
+    }
+}
+
+auto Database::compactStep(std::size_t rowBudget) -> bool {
+    for (auto &table: tables) {
+        // Tabela z LOAD jeszcze niewczytana - nie ma czego czyścić w pamięci.
+        if (table.deadOrdinals.empty() || table.lazySource) {
+            continue;
+        }
+        if (table.compressed) {
+            for (std::size_t ordinal: table.deadOrdinals) {
+                if (ordinal < table.encoded.size()) {
+                    table.encoded[ordinal] = EncodedColumn{};
+                }
+            }
+            table.compactionCursor = 0;
+        }
+        if (table.paged) {
+            for (std::size_t ordinal: table.deadOrdinals) {
+                table.paged->dropColumn(ordinal);
+            }
+            table.compactionCursor = 0;
+        }
+        std::size_t end = std::min(table.rows.size(), table.compactionCursor + rowBudget);
+        for (; table.compactionCursor < end; ++table.compactionCursor) {
+            auto &data = table.rows[table.compactionCursor].Data;
+            for (std::size_t ordinal: table.deadOrdinals) {
+                if (ordinal < data.size()) {
+                    std::string().swap(data[ordinal]);
+                }
+            }
+        }
+        if (table.compactionCursor < table.rows.size()) {
+            return true;
+        }
+        for (auto &zone: table.zones) {
+            for (std::size_t ordinal: table.deadOrdinals) {
+                if (ordinal < zone.columns.size()) {
+                    zone.columns[ordinal] = ColumnZone{};
+                }
+            }
+        }
+        table.deadOrdinals.clear();
+        table.compactionCursor = 0;
+        return true;
+    }
+    for (auto &table: tables) {
+        if (table.deletedCount > 0 && !table.lazySource &&
+            static_cast<double>(table.deletedCount) >= COMPACTION_DELETED_FRACTION * static_cast<double>(table.rowCount())) {
+            purgeDeletedRows(table);
+            return true;
+        }
+        // Plik stron, w którym nieaktualne wersje bloków zajmują więcej niż aktualne, przepisujemy od nowa.
+        if (table.paged && table.paged->stalePages > table.paged->livePages()) {
+            rebuildPaged(table);
+            return true;
+        }
+    }
+    // Tylko w bezczynnym przebiegu (Compactor czeka potem IDLE_INTERVAL), więc tabela musi być wolna od zapisów
+    // przez co najmniej jeden taki odstęp. PAGE i partycjonowanie wykluczają własne wiersze w pamięci.
+    for (auto &table: tables) {
+        if (!table.recompress || table.compressed || table.paged || table.partitioning) {
+            table.recompress = false;
+            continue;
+        }
+        if (table.version != table.recompressVersion) {
+            table.recompressVersion = table.version;
+            continue;
+        }
+        // Dane się nie zmieniają, więc wersja (i wyniki w ResultCache) zostaje.
+        encodeRows(table, false);
+        return true;
+    }
+    return false;
+}
+
+auto Database::touch(Table &table) -> void {
+    table.version = ++versionClock;
+}
+
+// Przy przekroczonym limicie najpierw oddajemy pamięć cache wyników, a dopiero potem odmawiamy operacji.
+auto Database::checkMemory(const std::string &operation) -> void {
+    MemoryBudget &budget = MemoryBudget::instance();
+    if (budget.overLimit() && resultCache.bytes() > 0) {
+        resultCache.clear();
+    }
+    budget.check(operation);
+}
+
+auto Database::memoryReport() const -> std::string {
+    auto limitText = [](std::size_t bytes) {
+        return bytes == 0 ? std::string("none") : formatBytes(bytes);
+    };
+    std::ostringstream out;
+    out << std::left << std::setw(16) << "table" << std::right << std::setw(10) << "rows"
+        << std::setw(12) << "rows mem" << std::setw(12) << "zones" << std::setw(12) << "encoded"
+        << std::setw(12) << "statistics" << std::setw(12) << "indexes" << std::setw(12) << "total" << "\n";
+    std::size_t attributed = 0;
+    for (const auto &table: tables) {
+        TableMemory memory = measureTable(table);
+        attributed += memory.total();
+        std::string label = memory.name + (!memory.loaded ? " (disk)" : memory.paged ? " (paged)" : "");
+        out << std::left << std::setw(16) << label << std::right
+            << std::setw(10) << memory.rows << std::setw(12) << formatBytes(memory.rowBytes)
+            << std::setw(12) << formatBytes(memory.zoneBytes) << std::setw(12) << formatBytes(memory.encodedBytes)
+            << std::setw(12) << formatBytes(memory.statisticsBytes) << std::setw(12) << formatBytes(memory.indexBytes)
+            << std::setw(12) << formatBytes(memory.total())
+            << "\n";
+    }
+    const MemoryBudget &budget = MemoryBudget::instance();
+    BufferPoolStats pool = BufferPool::instance().stats();
+    attributed += resultCache.bytes() + budget.queryBytes() + pool.usedBytes;
+    out << "result cache:  " << formatBytes(resultCache.bytes()) << " of " << formatBytes(resultCache.capacity())
+        << "\n"
+        << "buffer pool:   " << formatBytes(pool.usedBytes) << " of " << formatBytes(pool.capacityBytes) << " ("
+        << pool.frames << " blocks, " << pool.pinnedFrames << " pinned, hits " << pool.hits << ", misses "
+        << pool.misses << ", read ahead " << pool.readAheadPages << " pages, evictions " << pool.evictions << ")\n"
+        << "queries:       " << formatBytes(budget.queryBytes()) << "\n"
+        << "attributed:    " << formatBytes(attributed) << "\n"
+        << "heap:          " << formatBytes(budget.heapBytes()) << "\n"
+        << "limit:         " << limitText(budget.limit()) << "\n"
+        << "query limit:   " << limitText(budget.queryLimit()) << "\n";
+    return out.str();
+}
+
+auto Database::latch() -> std::recursive_mutex & {
+    return databaseLatch.mutex;
+}
+
+auto Database::getTables() const -> const std::vector<Table> & {
+    return tables;
+}
+
+auto Database::saveTables(const std::vector<std::string> &tableNames) -> void {
+    std::vector<std::string> names;
+    auto addName = [&names](const std::string &name) {
+        if (std::ranges::find(names, name) == names.end()) {
+            names.push_back(name);
+        }
+    };
+    for (const auto &name: tableNames) {
+        addName(name);
+        auto it = findTable(tables, name);
+        if (it != tables.end() && it->partitioning) {
+            for (Table *partition: partitionsOf(name)) {
+                addName(partition->name);
+            }
+        }
+        // Widoki zmieniają się razem ze swoją tabelą, więc wracają razem z nią.
+        for (const auto &table: tables) {
+            if (table.view && table.view->base == name) {
+                addName(table.name);
+            }
+        }
+    }
+    undoLog.emplace();
+    for (const auto &name: names) {
+        TableUndo entry;
+        entry.name = name;
+        auto it = findTable(tables, name);
+        entry.position = static_cast<std::size_t>(it - tables.begin());
+        if (it != tables.end()) {
+            // Sekcję z LOAD można odebrać tylko raz, więc tabela musi mieć już wczytane dane.
+            ensureLoaded(*it);
+            // Kopia bez wierszy i kolumn skompresowanych; indeksy i viewRows budują się po cofnięciu od nowa.
+            std::vector<Row> rows = std::move(it->rows);
+            std::vector<EncodedColumn> encoded = std::move(it->encoded);
+            std::vector<TrigramIndex> indexes = std::move(it->indexes);
+            std::optional<ViewRowIndex> viewRows;
+            viewRows.swap(it->viewRows);
+            entry.table = *it;
+            for (const auto &index: indexes) {
+                entry.table->indexes.emplace_back(index.column);
+            }
+            it->rows = std::move(rows);
+            it->encoded = std::move(encoded);
+            it->indexes = std::move(indexes);
+            it->viewRows.swap(viewRows);
+            entry.rowCount = it->rows.size();
+        }
+        undoLog->push_back(std::move(entry));
+    }
+}
+
+auto Database::discardUndo() -> void {
+    undoLog.reset();
+}
+
+auto Database::undoEntry(const Table &table) -> TableUndo * {
+    if (!undoLog) {
+        return nullptr;
+    }
+    for (auto &entry: *undoLog) {
+        // Po DROP tabela o tej nazwie jest już inną tabelą - cofnięcie i tak bierze wiersze z entry.rows.
+        if (entry.name == table.name) {
+            return entry.table && !entry.rows ? &entry : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+auto Database::logCell(const Table &table, std::size_t row, const Column &column) -> void {
+    TableUndo *undo = undoEntry(table);
+    // Wiersze dopisane po saveTables znikają przy cofnięciu w całości.
+    if (undo == nullptr || row >= undo->rowCount) {
+        return;
+    }
+    const auto &data = table.rows[row].Data;
+    CellUndo cell{.row = row, .ordinal = column.ordinal, .dataSize = data.size()};
+    if (column.ordinal < data.size()) {
+        cell.value = data[column.ordinal];
+    }
+    undo->cells.push_back(std::move(cell));
 }
 
-auto Database::addColumn(const std::string &tableName, const Column &column) -> void {
-    auto it = findTable(tables, tableName);
-    if (it == tables.end()) {
-        throw std::runtime_error("Table not found.");
+auto Database::preserveDropped(Table &table) -> void {
+    if (TableUndo *undo = undoEntry(table)) {
+        undo->rows = std::move(table.rows);
+        if (!undo->encoded) {
+            undo->encoded = std::move(table.encoded);
+        }
     }
+}
 
-    it->columns.push_back(column);
+auto Database::restoreTables() -> void {
+    if (!undoLog) {
+        return;
+    }
+    std::vector<TableUndo> undo = std::move(*undoLog);
+    undoLog.reset();
+    // Partycje utworzone po saveTables (nowy przedział RANGE, nowa tabela) nie mają wpisu - znikają.
+    std::erase_if(tables, [&undo](const Table &table) {
+        return table.partition && std::ranges::none_of(undo, [&table](const TableUndo &entry) {
+            return entry.name == table.name;
+        }) && std::ranges::any_of(undo, [&table](const TableUndo &entry) {
+            return entry.name == table.partition->parent;
+        });
+    });
+    for (auto &entry: undo) {
+        auto it = findTable(tables, entry.name);
+        if (!entry.table) {
+            if (it != tables.end()) {
+                tables.erase(it);
+            }
+            continue;
+        }
+        Table restored = std::move(*entry.table);
+        if (entry.rows) {
+            restored.rows = std::move(*entry.rows);
+        } else if (it != tables.end()) {
+            restored.rows = std::move(it->rows);
+        }
+        if (entry.encoded) {
+            restored.encoded = std::move(*entry.encoded);
+        } else if (it != tables.end()) {
+            restored.encoded = std::move(it->encoded);
+        }
+        if (restored.rows.size() > entry.rowCount) {
+            restored.rows.erase(restored.rows.begin() + static_cast<std::ptrdiff_t>(entry.rowCount),
+                                restored.rows.end());
+        }
+        // Tabela skompresowana albo stronicowana wraca bez wierszy rozpakowanych w transakcji.
+        if (restored.rows.empty()) {
+            restored.rows.shrink_to_fit();
+        }
+        // Od końca - każdy wpis przywraca stan sprzed swojej zmiany.
+        for (auto cell = entry.cells.rbegin(); cell != entry.cells.rend(); ++cell) {
+            auto &data = restored.rows[cell->row].Data;
+            if (data.size() > cell->dataSize) {
+                data.resize(cell->dataSize);
+            }
+            if (cell->ordinal < cell->dataSize) {
+                data[cell->ordinal] = std::move(cell->value);
+            }
+        }
+        if (it == tables.end()) {
+            it = tables.insert(tables.begin() + static_cast<std::ptrdiff_t>(std::min(entry.position, tables.size())),
+                               std::move(restored));
+        } else {
+            *it = std::move(restored);
+        }
+        touch(*it);
+    }
 }
 
-auto Database::removeColumn(const std::string &tableName, const std::string &columnName) -> void {
-    auto it = findTable(tables, tableName);
-    if (it == tables.end()) {
+auto Database::analyze(const std::string &tableName) -> void {
+    auto tableIt = findTable(tables, tableName);
+    if (!tableName.empty() && tableIt == tables.end()) {
         throw std::runtime_error("Table not found.");
     }
+    // Statystyki ma każda partycja - to jej wiersze czyta planAccess.
+    if (tableIt != tables.end() && tableIt->partitioning) {
+        for (Table *partition: partitionsOf(tableName)) {
+            analyze(partition->name);
+        }
+        return;
+    }
+    std::ostream &out = statementOutput();
+    for (auto &table: tables) {
+        if ((!tableName.empty() && table.name != tableName) || table.partitioning) {
+            continue;
+        }
+        ensureLoaded(table);
+        auto statistics = std::make_shared<TableStatistics>(analyzeTable(table));
+        out << "Table " << table.name << ": " << statistics->rowCount << " rows" << std::endl;
+        for (const auto &column: statistics->columns) {
+            out << "  " << column.name << ": nulls " << column.nullCount
+                << ", distinct ~" << std::llround(column.distinct)
+                << ", correlation " << std::setprecision(2) << column.correlation << std::setprecision(6);
+            if (!column.bounds.empty()) {
+                out << ", range [" << column.bounds.front() << ", " << column.bounds.back() << "]";
+            }
+            out << std::endl;
+        }
+        table.statistics = std::move(statistics);
+    }
+}
 
-    auto colIt = std::ranges::find_if(it->columns.begin(), it->columns.end(), [&columnName](const Column &column) {
-        return column.name == columnName;
-    });
+auto Database::compressTable(const std::string &tableName) -> void {
+    auto tableIt = findTable(tables, tableName);
+    if (tableIt == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    if (tableIt->partitioning) {
+        for (Table *partition: partitionsOf(tableName)) {
+            compressTable(partition->name);
+        }
+        return;
+    }
+    ensureLoaded(*tableIt);
+    if (tableIt->compressed) {
+        return;
+    }
+    if (tableIt->paged) {
+        throw std::runtime_error("Table " + tableName + " is paged - its blocks are already compressed.");
+    }
+    auto [rawBytes, encodedBytes] = encodeRows(*tableIt, true);
+    statementOutput() << "Table " << tableName << " compressed: " << rawBytes << " -> " << encodedBytes
+                      << " bytes" << std::endl;
+}
 
-    if (colIt == it->columns.end()) {
-        throw std::runtime_error("Column not found.");
+auto Database::encodeRows(Table &table, bool verbose) -> std::pair<std::size_t, std::size_t> {
+    // Usunięte wiersze i tak trzeba by przepisać - nie ma sensu ich kodować.
+    if (table.deletedCount > 0) {
+        purgeDeletedRows(table);
+    }
+    if (!zonesMatchRows(table)) {
+        rebuildZones(table);
     }
 
-    it->columns.erase(colIt);
+    std::size_t rawBytes = 0;
+    std::size_t encodedBytes = 0;
+    std::vector<EncodedColumn> encoded(table.nextOrdinal);
+    // Przerwanie przed podmianą zostawia tabelę nieskompresowaną, ale niezmienioną.
+    reportPhase("compress", table.rows.size() * table.columns.size());
+    for (const auto &column: table.columns) {
+        checkCancellation();
+        reportProgress(table.rows.size());
+        std::vector<std::string> values;
+        values.reserve(table.rows.size());
+        for (const auto &row: table.rows) {
+            values.push_back(row.value(column));
+            rawBytes += sizeof(std::string) + (values.back().size() > 15 ? values.back().capacity() : 0);
+        }
+        EncodedColumn &target = encoded[column.ordinal];
+        target = encodeColumn(values, column.type);
+        encodedBytes += target.byteSize();
+        if (verbose) {
+            statementOutput() << "Column " << column.name << ": " << encodingName(target.encoding)
+                              << ", " << target.byteSize() << " bytes" << std::endl;
+        }
+    }
+
+    table.encodedRowCount = table.rows.size();
+    table.encoded = std::move(encoded);
+    table.rows.clear();
+    table.rows.shrink_to_fit();
+    table.compressed = true;
+    table.recompress = false;
+    table.deadOrdinals.clear();
+    table.compactionCursor = 0;
+    return {rawBytes, encodedBytes};
 }
 
+auto Database::materialize(Table &table) -> void {
+    ensureLoaded(table);
+    if (!table.compressed) {
+        return;
+    }
+    table.recompress = true;
+    table.recompressVersion = table.version;
+
+    // Pełne przepisanie wierszy i tak następuje, więc przy okazji numerujemy miejsca kolumn od nowa
+    // i pozbywamy się martwych miejsc po usuniętych kolumnach.
+    std::vector<std::vector<std::string>> decoded;
+    std::vector<ZoneMap> zones(table.zones.size());
+    // Bitmapa usuniętych wierszy zostaje, więc ich liczniki w strefach też muszą zostać.
+    for (std::size_t block = 0; block < zones.size(); ++block) {
+        zones[block].deletedRows = table.zones[block].deletedRows;
+    }
+    for (std::size_t c = 0; c < table.columns.size(); ++c) {
+        const Column &column = table.columns[c];
+        decoded.push_back(table.hasEncoded(column) ? table.encoded[column.ordinal].decode()
+                                                   : std::vector<std::string>(table.encodedRowCount,
+                                                                              column.defaultValue));
+        for (std::size_t block = 0; block < zones.size(); ++block) {
+            zones[block].columns.push_back(zoneColumn(table, block, column));
+        }
+    }
 
-auto Database::insertInto(const std::string &tableName, const std::string &columnName, Row inputRow) -> void {
+    table.rows.clear();
+    table.rows.reserve(table.encodedRowCount);
+    for (std::size_t i = 0; i < table.encodedRowCount; ++i) {
+        Row row(table.columns);
+        row.Data.reserve(decoded.size());
+        for (auto &values: decoded) {
+            row.Data.push_back(std::move(values[i]));
+        }
+        table.rows.push_back(std::move(row));
+    }
+    table.assignOrdinals();
+    table.zones = std::move(zones);
+    if (TableUndo *undo = undoEntry(table); undo != nullptr && !undo->encoded) {
+        undo->encoded = std::move(table.encoded);
+    }
+    table.encoded.clear();
+    table.encodedRowCount = 0;
+    table.compressed = false;
+}
+
+auto Database::pageTable(const std::string &tableName, const std::string &path) -> void {
     auto tableIt = findTable(tables, tableName);
     if (tableIt == tables.end()) {
-        throw std::runtime_error("Table not found: " + tableName);
+        throw std::runtime_error("Table not found.");
+    }
+    // Każda partycja dostaje własny plik stron: path.<nazwa partycji po '#'>.
+    if (tableIt->partitioning) {
+        for (Table *partition: partitionsOf(tableName)) {
+            pageTable(partition->name,
+                      path.empty() ? "" : path + "." + partition->name.substr(partition->name.find('#') + 1));
+        }
+        return;
+    }
+    if (tableIt->view) {
+        throw std::runtime_error("Materialized view " + tableName + " is kept in memory and cannot be paged");
+    }
+    ensureLoaded(*tableIt);
+    if (tableIt->paged) {
+        return;
+    }
+    if (tableIt->deletedCount > 0) {
+        purgeDeletedRows(*tableIt);
+    }
+    if (!zonesMatchRows(*tableIt)) {
+        rebuildZones(*tableIt);
+    }
+
+    // Kolumny zapisujemy po kolei w całości, więc skan jednej kolumny czyta plik sekwencyjnie.
+    PagedStorage storage;
+    storage.file = std::make_shared<PageFile>(path.empty() ? tableName + ".pages" : path);
+    storage.rowCount = tableIt->rowCount();
+    std::vector<ZoneMap> zones(tableIt->zones.size());
+    for (std::size_t c = 0; c < tableIt->columns.size(); ++c) {
+        const Column &column = tableIt->columns[c];
+        Column stored = column;
+        stored.ordinal = c;
+        std::vector<std::string> values;
+        for (std::size_t block = 0; block < zones.size(); ++block) {
+            values.clear();
+            std::size_t begin = block * ZONE_BLOCK_ROWS;
+            for (std::size_t i = begin; i < begin + storage.blockRows(block); ++i) {
+                values.push_back(tableIt->valueAt(i, column));
+            }
+            storage.writeBlock(stored, block, values);
+            zones[block].columns.push_back(zoneColumn(*tableIt, block, column));
+        }
     }
 
+    tableIt->rows.clear();
+    tableIt->rows.shrink_to_fit();
+    tableIt->encoded.clear();
+    tableIt->encodedRowCount = 0;
+    tableIt->compressed = false;
+    tableIt->paged = std::move(storage);
+    tableIt->assignOrdinals();
+    tableIt->zones = std::move(zones);
+    touch(*tableIt);
+    statementOutput() << "Table " << tableName << " paged: " << tableIt->paged->file->pageCount() << " pages of "
+                      << PAGE_SIZE << " bytes in " << tableIt->paged->file->path() << std::endl;
+}
 
-    size_t columnIndex = 0;
-    bool columnFound = false;
-    for (; columnIndex < tableIt->columns.size(); ++columnIndex) {
-        if (tableIt->columns[columnIndex].name == columnName) {
-            columnFound = true;
-            break;
+// Przepisuje tabelę stronicowaną do nowego pliku blok po bloku, pomijając usunięte wiersze, martwe kolumny
+// i nieaktualne wersje bloków; w pamięci jest naraz tylko jeden blok każdej kolumny.
+auto Database::rebuildPaged(Table &table) -> void {
+    for (auto &index: table.indexes) {
+        index.clear();
+    }
+    const PagedStorage &old = *table.paged;
+    PagedStorage rebuilt;
+    rebuilt.generation = old.generation + 1;
+    std::string basePath = old.file->path();
+    if (old.generation > 0) {
+        basePath.erase(basePath.rfind('.'));
+    }
+    rebuilt.file = std::make_shared<PageFile>(basePath + "." + std::to_string(rebuilt.generation));
+    rebuilt.rowCount = table.liveRowCount();
+
+    for (std::size_t c = 0; c < table.columns.size(); ++c) {
+        const Column &column = table.columns[c];
+        Column stored = column;
+        stored.ordinal = c;
+        std::vector<std::string> pending;
+        std::size_t written = 0;
+        for (std::size_t block = 0; block * ZONE_BLOCK_ROWS < old.rowCount; ++block) {
+            if (table.zones.size() > block && table.zones[block].deletedRows == old.blockRows(block)) {
+                continue;
+            }
+            std::vector<std::string> values = old.blockValues(column, block);
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (!table.isDeleted(block * ZONE_BLOCK_ROWS + i)) {
+                    pending.push_back(std::move(values[i]));
+                }
+            }
+            while (pending.size() >= ZONE_BLOCK_ROWS) {
+                std::vector<std::string> full(std::make_move_iterator(pending.begin()),
+                                              std::make_move_iterator(pending.begin() + ZONE_BLOCK_ROWS));
+                pending.erase(pending.begin(), pending.begin() + ZONE_BLOCK_ROWS);
+                rebuilt.writeBlock(stored, written++, full);
+            }
+        }
+        if (!pending.empty()) {
+            rebuilt.writeBlock(stored, written, pending);
         }
     }
 
-    if (!columnFound) {
-        throw std::runtime_error("Column not found: " + columnName);
+    table.paged = std::move(rebuilt);
+    table.assignOrdinals();
+    table.deleted.clear();
+    table.deletedCount = 0;
+    table.viewRows.reset();
+    rebuildZones(table);
+}
+
+auto Database::evaluatePaged(const Table &table, const Expression *expression, std::size_t block, std::size_t rows,
+                             std::vector<char> &selection) -> void {
+    if (expression == nullptr) {
+        selection.assign(rows, 1);
+        return;
+    }
+    if (expression->logicalOperator == "AND" || expression->logicalOperator == "OR") {
+        std::vector<char> right;
+        evaluatePaged(table, expression->left.get(), block, rows, selection);
+        evaluatePaged(table, expression->right.get(), block, rows, right);
+        bool isAnd = expression->logicalOperator == "AND";
+        for (std::size_t i = 0; i < selection.size(); ++i) {
+            selection[i] = isAnd ? (selection[i] && right[i]) : (selection[i] || right[i]);
+        }
+        return;
     }
 
-    if (inputRow.Data.size() != 1) {
-        throw std::runtime_error("Input row should have exactly one value for the specified column");
+    const Column *column = table.findColumn(expression->column);
+    if (column == nullptr) {
+        throw std::runtime_error("Error: Column name '" + expression->column + "' not found in Row::getValue");
     }
+    PinnedPage page = table.paged->pin(*column, block, true);
+    if (!page) {
+        selection.assign(rows, compareValues(column->defaultValue, expression->operators, expression->value));
+        return;
+    }
+    filterEncoded(*page, 0, rows, expression->operators, expression->value, selection);
+}
 
-    std::string columnType = getColumnType(tableIt->name, columnName);
-    std::string &data = inputRow.Data[0];
-    if ((columnType == "int" && !isInteger(data)) ||
-        (columnType == "string" && !isString(data)) ||
-        (columnType == "bool" && !isBoolean(data))) {
-        throw std::runtime_error("Data type mismatch for column: " + columnName);
+// Ostatni niepełny blok dostaje nową wersję z dopisanymi wierszami, a kolejne bloki zapisywane są od razu całe,
+// kolumna po kolumnie (jak w PAGE). Kolumny spoza targets dostają wartość domyślną, jak w Row::widen.
+auto Database::appendPaged(Table &table, const std::vector<const Column *> &targets,
+                           std::vector<std::vector<std::string>> &values) -> void {
+    PagedStorage &storage = *table.paged;
+    if (!zonesMatchRows(table)) {
+        rebuildZones(table);
+    }
+    std::size_t first = storage.rowCount;
+    std::size_t end = first + values.front().size();
+    std::size_t firstBlock = first / ZONE_BLOCK_ROWS;
+    for (const auto &column: table.columns) {
+        auto target = std::ranges::find(targets, &column);
+        for (std::size_t block = firstBlock; block * ZONE_BLOCK_ROWS < end; ++block) {
+            std::size_t begin = std::max(block * ZONE_BLOCK_ROWS, first);
+            std::size_t blockEnd = std::min((block + 1) * ZONE_BLOCK_ROWS, end);
+            std::vector<std::string> blockValues;
+            if (begin > block * ZONE_BLOCK_ROWS) {
+                blockValues = storage.blockValues(column, block);
+            }
+            for (std::size_t row = begin; row < blockEnd; ++row) {
+                blockValues.push_back(target == targets.end() ? column.defaultValue
+                                                              : std::move(values[target - targets.begin()][row - first]));
+            }
+            storage.writeBlock(column, block, blockValues);
+        }
     }
-    bool rowUpdated = false;
-    for (auto &row: tableIt->rows) {
-        if (row.canUpdate(columnIndex)) {
-            row.setValue(columnIndex, inputRow);
-            rowUpdated = true;
-            break;
+    storage.rowCount = end;
+    for (std::size_t block = firstBlock; block * ZONE_BLOCK_ROWS < end; ++block) {
+        if (block < table.zones.size()) {
+            table.zones[block] = buildZone(table, block);
+        } else {
+            table.zones.push_back(buildZone(table, block));
         }
     }
+}
 
-    if (!rowUpdated) {
-        Row newRow(tableIt->columns);
-        newRow.setValue(columnIndex, inputRow);
-        tableIt->rows.push_back(newRow);
-        std::cout << "Data inserting into columns in: " + tableName << std::endl;
+// INSERT do tabeli stronicowanej: pierwsza pusta komórka kolumny; bloki bez pustych wartości pomija mapa stref.
+auto Database::insertPaged(Table &table, const Column &column, const std::string &value)
+-> std::optional<std::size_t> {
+    if (!zonesMatchRows(table)) {
+        rebuildZones(table);
+    }
+    for (std::size_t block = 0; block < table.zones.size(); ++block) {
+        if (zoneColumn(table, block, column).nullCount == 0) {
+            continue;
+        }
+        std::vector<std::string> values = table.paged->blockValues(column, block);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (values[i].empty() && !table.isDeleted(block * ZONE_BLOCK_ROWS + i)) {
+                values[i] = value;
+                table.paged->writeBlock(column, block, values);
+                ensureZoneColumn(table, block, column) = zoneOf(values);
+                return block * ZONE_BLOCK_ROWS + i;
+            }
+        }
     }
+    return std::nullopt;
 }
 
+auto Database::updatePaged(Table &table, const Column &column, const Column *source, const Assignment &assignment,
+                           const std::vector<std::size_t> &matches) -> void {
+    std::vector<long long> numbers;
+    std::vector<std::size_t> batch;
+    for (std::size_t first = 0; first < matches.size();) {
+        std::size_t block = matches[first] / ZONE_BLOCK_ROWS;
+        std::size_t begin = block * ZONE_BLOCK_ROWS;
+        std::vector<std::string> values = table.paged->blockValues(column, block);
+        if (source == nullptr) {
+            for (; first < matches.size() && matches[first] / ZONE_BLOCK_ROWS == block; ++first) {
+                values[matches[first] - begin] = assignment.value;
+            }
+        } else {
+            std::vector<std::string> sourceValues = source == &column ? values
+                                                                      : table.paged->blockValues(*source, block);
+            batch.clear();
+            numbers.clear();
+            for (; first < matches.size() && matches[first] / ZONE_BLOCK_ROWS == block; ++first) {
+                long long number;
+                if (parseNumber(sourceValues[matches[first] - begin], number)) {
+                    batch.push_back(matches[first] - begin);
+                    numbers.push_back(number);
+                }
+            }
+            applyArithmetic(numbers, assignment.arithmeticOperator, assignment.operand);
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                values[batch[i]] = std::to_string(numbers[i]);
+            }
+        }
+        table.paged->writeBlock(column, block, values);
+        ensureZoneColumn(table, block, column) = zoneOf(values);
+    }
+}
 
-auto
-Database::update(const std::string &tableName, const std::string &columnName, const std::string &newValue) -> void {
-    auto tableIt = findTable(tables, tableName);
-    if (tableIt == tables.end()) {
-        throw std::runtime_error("Table not found.");
+auto Database::ensurePartition(const PartitionSlot &slot) -> std::string {
+    std::string name = partitionTableName(slot, *findTable(tables, slot.parent)->partitioning);
+    auto it = findTable(tables, name);
+    if (it != tables.end()) {
+        if (!it->partition || it->partition->parent != slot.parent) {
+            throw std::runtime_error("Table " + name + " is in the way of a partition of " + slot.parent);
+        }
+        return name;
     }
+    Table partition(name, findTable(tables, slot.parent)->columns, {});
+    partition.partition = slot;
+    partition.indexes = findTable(tables, slot.parent)->indexes;
+    tables.push_back(std::move(partition));
+    touch(tables.back());
+    return name;
+}
 
+auto Database::partitionsOf(const std::string &parentName, const Expression *where) -> std::vector<Table *> {
+    std::vector<Table *> partitions;
+    auto parent = findTable(tables, parentName);
+    if (parent == tables.end() || !parent->partitioning) {
+        return partitions;
+    }
+    for (auto &table: tables) {
+        if (table.partition && table.partition->parent == parentName &&
+            partitionMayMatch(*parent->partitioning, *table.partition, where)) {
+            partitions.push_back(&table);
+        }
+    }
+    // Przedziały w kolejności kluczy, partycja domyślna na końcu.
+    std::ranges::sort(partitions, [](const Table *left, const Table *right) {
+        return std::pair(left->partition->fallback, left->partition->bucket) <
+               std::pair(right->partition->fallback, right->partition->bucket);
+    });
+    return partitions;
+}
 
-    auto columnIt = std::ranges::find_if(tableIt->columns.begin(), tableIt->columns.end(), [&columnName](const Column &col) {
-        return col.name == columnName;
+auto Database::zonesMayMatch(Table &table, const Expression *expression) -> bool {
+    ensureLoaded(table);
+    if (!zonesMatchRows(table)) {
+        rebuildZones(table);
+    }
+    return std::ranges::any_of(table.zones, [&](const ZoneMap &zone) {
+        return zoneMayMatch(table, zone, expression);
     });
-    if (columnIt == tableIt->columns.end()) {
-        throw std::runtime_error("Column not found.");
+}
+
+// Nowy wiersz trafia do partycji swojego klucza. INSERT do innej kolumny najpierw - jak w zwykłej tabeli -
+// wypełnia pustą komórkę (partycje po kolei), a gdy jej nie ma, zaczyna wiersz bez klucza. INSERT klucza
+// nie wypełnia wierszy spoza partycji tego klucza, bo wiersz musiałby ją zmienić.
+auto Database::insertPartitioned(const std::string &parentName, const std::string &columnName, Row inputRow) -> void {
+    PartitionScheme scheme = *findTable(tables, parentName)->partitioning;
+    bool key = columnName == scheme.column;
+    if (!key) {
+        Expression emptyCell{columnName, "=", "", nullptr, nullptr, ""};
+        for (Table *partition: partitionsOf(parentName)) {
+            if (zonesMayMatch(*partition, &emptyCell) &&
+                fillEmptyCell(*partition, *partition->findColumn(columnName), inputRow.Data[0])) {
+                touch(*partition);
+                return;
+            }
+        }
     }
-    std::size_t columnIndex = std::distance(tableIt->columns.begin(), columnIt);
+    std::string partition = ensurePartition(partitionSlot(parentName, scheme, key ? inputRow.Data[0] : ""));
+    insertInto(partition, columnName, std::move(inputRow));
+}
 
-    for (auto &row: tableIt->rows) {
-        if (row.Data.size() > columnIndex) {
-            row.Data[columnIndex] = newValue;
+auto Database::appendPartitioned(const std::string &parentName, const std::vector<std::string> &columnNames,
+                                 std::vector<std::vector<std::string>> columnValues) -> void {
+    PartitionScheme scheme = *findTable(tables, parentName)->partitioning;
+    auto keyIt = std::ranges::find(columnNames, scheme.column);
+    std::size_t count = columnValues.front().size();
+
+    // Wiersze grupowane po partycji; w każdej zostają w kolejności wsadu.
+    std::map<std::pair<bool, long long>, std::vector<std::size_t>> groups;
+    for (std::size_t r = 0; r < count; ++r) {
+        const std::string &key = keyIt == columnNames.end() ? std::string()
+                                                             : columnValues[keyIt - columnNames.begin()][r];
+        PartitionSlot slot = partitionSlot(parentName, scheme, key);
+        groups[{slot.fallback, slot.bucket}].push_back(r);
+    }
+    for (const auto &[slot, rows]: groups) {
+        std::vector<std::vector<std::string>> values(columnNames.size());
+        for (std::size_t c = 0; c < columnNames.size(); ++c) {
+            values[c].reserve(rows.size());
+            for (std::size_t r: rows) {
+                values[c].push_back(std::move(columnValues[c][r]));
+            }
         }
+        appendRows(ensurePartition({parentName, slot.second, slot.first}), columnNames, std::move(values));
     }
 }
-auto Database::deleteDataFromColumn(const std::string &tableName, const std::string &columnName,
-                                    const std::string &dataToDelete) -> void {
-    auto tableIt = findTable(tables, tableName);
-    if (tableIt == tables.end()) {
+
+// Każda partycja, której WHERE nie wyklucza, jest czytana osobno, ze swoimi strefami, statystykami i wpisem cache.
+auto Database::selectPartitioned(const std::string &parentName, const std::vector<std::string> &columns,
+                                 const std::unique_ptr<Expression> &where, QueryProfile *profile,
+                                 const std::string &cacheKey, const TableSample *sample) -> std::vector<Row> {
+    const Table &parent = *findTable(tables, parentName);
+    for (const auto &colName: columns) {
+        if (parent.findColumn(colName) == nullptr) {
+            throw std::runtime_error("Error: Column name '" + colName + "' not found in Row::getValue");
+        }
+    }
+
+    std::vector<Table *> partitions = partitionsOf(parentName, where.get());
+    std::vector<Row> result;
+    QueryProfile total;
+    std::string partitionPath;
+    for (Table *partition: partitions) {
+        std::string partitionKey = cacheKey.empty() ? "" : partition->name + "\n" + cacheKey;
+        std::vector<Row> rows;
+        if (auto cached = profile == nullptr ? cachedRows(*partition, partitionKey) : std::nullopt) {
+            rows = std::move(*cached);
+        } else {
+            QueryProfile counters;
+            rows = selectRows(*partition, columns, where, profile != nullptr ? &counters : nullptr, partitionKey,
+                              sample);
+            total.predicateNanos += counters.predicateNanos;
+            total.projectionNanos += counters.projectionNanos;
+            total.blocksScanned += counters.blocksScanned;
+            total.blocksSkipped += counters.blocksSkipped;
+            total.rowsScanned += counters.rowsScanned;
+            total.rowsMatched += counters.rowsMatched;
+            total.rowsNotSampled += counters.rowsNotSampled;
+            if (partitionPath.empty()) {
+                partitionPath = counters.accessPath;
+            }
+        }
+        result.insert(result.end(), std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+    }
+    if (profile != nullptr) {
+        total.parseNanos = profile->parseNanos;
+        total.accessPath = "partitions " + std::to_string(partitions.size()) + " of " +
+                           std::to_string(partitionsOf(parentName).size()) +
+                           (partitionPath.empty() ? "" : ", " + partitionPath);
+        *profile = total;
+    }
+    return result;
+}
+
+// Całe przedziały poniżej granicy znikają bez czytania ich wierszy (pliki stron usuwa PageFile).
+auto Database::dropPartitions(const std::string &tableName, long long below) -> std::size_t {
+    auto parent = findTable(tables, tableName);
+    if (parent == tables.end()) {
         throw std::runtime_error("Table not found.");
     }
+    if (!parent->partitioning || parent->partitioning->method != PartitionMethod::Range) {
+        throw std::runtime_error("DROP PARTITIONS needs a table partitioned by RANGE");
+    }
+    long long width = parent->partitioning->width;
+    auto droppable = [&](const Table &table) {
+        return table.partition && table.partition->parent == tableName && !table.partition->fallback &&
+               (table.partition->bucket + 1) * width <= below;
+    };
+    // Widoki tabeli muszą wycofać wiersze usuwanych przedziałów, więc tylko wtedy są one czytane.
+    std::vector<RowImage> removed;
+    if (hasViews(*parent)) {
+        for (Table *partition: partitionsOf(tableName)) {
+            if (droppable(*partition)) {
+                ensureLoaded(*partition);
+                std::vector<RowImage> images = rowImages(*partition, liveRows(*partition));
+                removed.insert(removed.end(), std::make_move_iterator(images.begin()),
+                               std::make_move_iterator(images.end()));
+            }
+        }
+    }
+    for (auto &table: tables) {
+        if (droppable(table)) {
+            preserveDropped(table);
+        }
+    }
+    std::size_t dropped = std::erase_if(tables, droppable);
+    parent = findTable(tables, tableName);
+    touch(*parent);
+    maintainViews(*parent, removed, {});
+    return dropped;
+}
 
-    auto columnIt = std::ranges::find_if(tableIt->columns.begin(), tableIt->columns.end(), [&columnName](const Column &col) {
-        return col.name == columnName;
-    });
-    if (columnIt == tableIt->columns.end()) {
-        throw std::runtime_error("Column not found.");
+auto Database::partitionReport(const std::string &tableName) -> std::string {
+    auto parent = findTable(tables, tableName);
+    if (parent == tables.end()) {
+        throw std::runtime_error("Table not found.");
+    }
+    if (!parent->partitioning) {
+        throw std::runtime_error("Table " + tableName + " is not partitioned");
     }
-    std::size_t columnIndex = std::distance(tableIt->columns.begin(), columnIt);
+    PartitionScheme scheme = *parent->partitioning;
+    std::vector<Table *> partitions = partitionsOf(tableName);
+    std::ostringstream out;
+    out << tableName << ": " << describeScheme(scheme) << ", " << partitions.size() << " partitions\n";
+    for (const Table *partition: partitions) {
+        out << "  " << std::left << std::setw(20) << partition->name << std::setw(28)
+            << describePartition(scheme, *partition->partition) << std::right << std::setw(10)
+            << partition->liveRowCount() << " rows" << (partition->paged ? " (paged)" : "")
+            << (partition->compressed ? " (compressed)" : "") << "\n";
+    }
+    return out.str();
+}
 
-    for (auto &row: tableIt->rows) {
-        if (row.Data.size() > columnIndex && row.Data[columnIndex] == dataToDelete) {
-            row.Data[columnIndex] = "";
+auto Database::createView(const std::string &viewName, ViewDefinition definition) -> void {
+    if (findTable(tables, viewName) != tables.end()) {
+        throw std::runtime_error("Table already exists.");
+    }
+    auto base = findTable(tables, definition.base);
+    if (base == tables.end()) {
+        throw std::runtime_error("Table not found: " + definition.base);
+    }
+    if (base->view || base->partition) {
+        throw std::runtime_error("A materialized view needs a base table, not " + definition.base);
+    }
+    std::vector<Column> columns;
+    for (const auto &name: definition.columns) {
+        const Column *column = base->findColumn(name);
+        if (column == nullptr) {
+            throw std::runtime_error("Column not found: " + name);
         }
+        if (std::ranges::any_of(columns, [&name](const Column &added) { return added.name == name; })) {
+            throw std::runtime_error("Column listed twice in materialized view: " + name);
+        }
+        columns.push_back(Column{.name = name, .type = column->type});
+    }
+
+    // Jedyne pełne wykonanie zapytania - później widok dostaje tylko zmiany wierszy tabeli bazowej.
+    definition.where = parseViewWhere(definition.whereClause);
+    std::vector<Row> result = select(definition.base, definition.columns, definition.whereClause);
+    Table view(viewName, columns, {});
+    view.rows.reserve(result.size());
+    for (auto &row: result) {
+        Row viewRow(view.columns);
+        viewRow.Data = std::move(row.Data);
+        view.rows.push_back(std::move(viewRow));
+    }
+    view.view = std::move(definition);
+    rebuildZones(view);
+    tables.push_back(std::move(view));
+    touch(tables.back());
+}
+
+auto Database::checkWritable(const Table &table) const -> void {
+    if (table.view) {
+        throw std::runtime_error("Materialized view " + table.name + " is read-only; change " + table.view->base +
+                                 " instead");
     }
 }
 
+auto Database::hasViews(const Table &table) const -> bool {
+    // Widok partycjonowanej tabeli odnosi się do tabeli nadrzędnej, a zmiany przychodzą z jej partycji.
+    const std::string &base = table.partition ? table.partition->parent : table.name;
+    return std::ranges::any_of(tables, [&base](const Table &view) {
+        return view.view && view.view->base == base;
+    });
+}
 
-auto Database::select(const std::string &tableName, const std::vector<std::string> &columns,
-                      const std::string &whereClause) -> std::vector<Row> {
-    auto tableIt = findTable(tables, tableName);
-    if (tableIt == tables.end()) {
-        throw std::runtime_error("Table not found.");
+auto Database::rowImages(const Table &table, const std::vector<std::size_t> &rows) const -> std::vector<RowImage> {
+    std::vector<RowImage> images;
+    images.reserve(rows.size());
+    for (std::size_t row: rows) {
+        RowImage image;
+        image.reserve(table.columns.size());
+        for (const auto &column: table.columns) {
+            image.push_back(table.valueAt(row, column));
+        }
+        images.push_back(std::move(image));
     }
-    std::vector<Row> result;
-    Parser parser;
+    return images;
+}
 
-    std::unique_ptr<Expression> whereExpression;
-    if (!whereClause.empty()) {
-        whereExpression = parser.parseWhereClause(whereClause);
+auto Database::liveRows(const Table &table, std::size_t first) const -> std::vector<std::size_t> {
+    std::vector<std::size_t> rows;
+    for (std::size_t i = first; i < table.rowCount(); ++i) {
+        if (!table.isDeleted(i)) {
+            rows.push_back(i);
+        }
     }
+    return rows;
+}
+
+// Widok to wielozbiór wierszy wyniku: wiersz wypadający z wyniku usuwa jeden równy wiersz widoku (znaleziony
+// w viewRows), a wiersz trafiający do wyniku jest dopisywany na końcu. Koszt zależy od wielkości zmiany;
+// cały widok czytany jest tylko przy budowie viewRows.
+auto Database::maintainViews(const Table &base, const std::vector<RowImage> &removed,
+                             const std::vector<RowImage> &added) -> void {
+    if (removed.empty() && added.empty()) {
+        return;
+    }
+    const std::string &baseName = base.partition ? base.partition->parent : base.name;
+    for (auto &view: tables) {
+        if (!view.view || view.view->base != baseName) {
+            continue;
+        }
+        ViewProjection projection(*view.view, base.columns);
+        std::map<std::vector<std::string>, std::size_t> removals;
+        for (const auto &image: removed) {
+            if (projection.matches(image)) {
+                ++removals[projection.project(image)];
+            }
+        }
+        // Wiersz, który wypada i wraca z tymi samymi wartościami (np. UPDATE kolumny spoza widoku), się znosi.
+        std::vector<std::vector<std::string>> additions;
+        for (const auto &image: added) {
+            if (!projection.matches(image)) {
+                continue;
+            }
+            std::vector<std::string> values = projection.project(image);
+            auto it = removals.find(values);
+            if (it != removals.end() && it->second > 0) {
+                --it->second;
+            } else {
+                additions.push_back(std::move(values));
+            }
+        }
+        std::erase_if(removals, [](const auto &entry) { return entry.second == 0; });
+        if (removals.empty() && additions.empty()) {
+            continue;
+        }
 
-    for (Row &row: tableIt->rows) {
-        if (whereClause.empty() || (whereExpression && evaluateExpression(row, whereExpression))) {
-            Row selectedRow(tableIt->columns);
-            for (const auto &colName: columns) {
-                selectedRow.Data.push_back(row.getValue(colName));
+        materialize(view);
+        touch(view);
+        if (!view.viewRows) {
+            ViewRowIndex index;
+            for (std::size_t i = 0; i < view.rows.size(); ++i) {
+                if (view.isDeleted(i)) {
+                    continue;
+                }
+                std::vector<std::string> values(view.columns.size());
+                for (std::size_t c = 0; c < view.columns.size(); ++c) {
+                    values[c] = view.rows[i].value(view.columns[c]);
+                }
+                index[std::move(values)].push_back(i);
+            }
+            view.viewRows = std::move(index);
+        }
+        ViewRowIndex &index = *view.viewRows;
+        if (!removals.empty()) {
+            if (!zonesMatchRows(view)) {
+                rebuildZones(view);
+            }
+            view.deleted.resize(std::max(view.deleted.size(), view.rows.size()), false);
+            for (const auto &[values, count]: removals) {
+                auto it = index.find(values);
+                for (std::size_t n = 0; n < count && it != index.end() && !it->second.empty(); ++n) {
+                    std::size_t i = it->second.back();
+                    it->second.pop_back();
+                    view.deleted[i] = true;
+                    ++view.deletedCount;
+                    ++view.zones[i / ZONE_BLOCK_ROWS].deletedRows;
+                }
+                if (it != index.end() && it->second.empty()) {
+                    index.erase(it);
+                }
+            }
+        }
+        for (auto &values: additions) {
+            Row row(view.columns);
+            row.widen(view.nextOrdinal);
+            for (std::size_t c = 0; c < view.columns.size(); ++c) {
+                row.setValue(view.columns[c], values[c]);
             }
-            result.push_back(selectedRow);
+            index[std::move(values)].push_back(view.rows.size());
+            view.rows.push_back(std::move(row));
+            noteRowAppended(view);
         }
     }
-    return result;
 }
 
+auto Database::addTable(Table table) -> void {
+    tables.push_back(std::move(table));
+    touch(tables.back());
+    if (!tables.back().lazySource && !zonesMatchRows(tables.back())) {
+        rebuildZones(tables.back());
+    }
+}
 
-auto Database::getTables() const -> const std::vector<Table> {
-    return tables;
+auto Database::ensureLoaded(Table &table) -> void {
+    if (!table.lazySource) {
+        return;
+    }
+    TableSection section = table.lazySource->take();
+    table.zones = std::move(section.zones);
+    table.encoded = std::move(section.encoded);
+    table.compressed = true;
+    table.lazySource.reset();
+    if (!zonesMatchRows(table)) {
+        rebuildZones(table);
+    }
+}
+
+auto Database::loadAllTables() -> void {
+    for (auto &table: tables) {
+        ensureLoaded(table);
+    }
 }
 
-auto Database::addTable(const Table &table) -> void {
-    tables.push_back(table);
+auto Database::startBackgroundLoad() -> void {
+    std::vector<std::shared_ptr<LazyTableSource>> sources;
+    for (const auto &table: tables) {
+        if (table.lazySource) {
+            sources.push_back(table.lazySource);
+        }
+    }
+    if (!sources.empty()) {
+        backgroundLoader = std::make_shared<BackgroundLoader>(std::move(sources));
+    }
 }
 
 
@@ -207,6 +2276,8 @@ auto Database::matchCondition(Row &row, const std::unique_ptr<Expression> &expre
         return columnValue >= expression->value;
     } else if (expression->operators == "<=") {
         return columnValue <= expression->value;
+    } else if (expression->operators == "LIKE") {
+        return likeMatches(columnValue, expression->value);
     }
 
 
@@ -219,38 +2290,41 @@ auto Database::evaluateExpression(Row &row, const std::unique_ptr<Expression> &e
         return true;
     }
 
-    std::string columnValue = row.getValue(expression->column);
-
-
-    bool isColumnValueNumeric = isNumeric(columnValue);
-    bool isExpressionValueNumeric = isNumeric(expression->value);
+    if (expression->logicalOperator == "AND") {
+        return evaluateExpression(row, expression->left) && evaluateExpression(row, expression->right);
+    } else if (expression->logicalOperator == "OR") {
+        return evaluateExpression(row, expression->left) || evaluateExpression(row, expression->right);
+    }
 
-    if (expression->operators == "=") {
-        return columnValue == expression->value;
-    } else if (expression->operators == "!=") {
-        return columnValue != expression->value;
-    } else if (isColumnValueNumeric && isExpressionValueNumeric) {
-        int numColumnValue = std::stoi(columnValue);
-        int numExpressionValue = std::stoi(expression->value);
+    return compareValues(row.getValue(expression->column), expression->operators, expression->value);
+}
 
-        if (expression->operators == ">") {
-            return numColumnValue > numExpressionValue;
-        } else if (expression->operators == ">=") {
-            return numColumnValue >= numExpressionValue;
-        } else if (expression->operators == "<") {
-            return numColumnValue < numExpressionValue;
-        } else if (expression->operators == "<=") {
-            return numColumnValue <= numExpressionValue;
+auto Database::evaluateEncoded(const Table &table, const Expression *expression, std::size_t begin, std::size_t end,
+                               std::vector<char> &selection) -> void {
+    if (expression == nullptr) {
+        selection.assign(end - begin, 1);
+        return;
+    }
+    if (expression->logicalOperator == "AND" || expression->logicalOperator == "OR") {
+        std::vector<char> right;
+        evaluateEncoded(table, expression->left.get(), begin, end, selection);
+        evaluateEncoded(table, expression->right.get(), begin, end, right);
+        bool isAnd = expression->logicalOperator == "AND";
+        for (std::size_t i = 0; i < selection.size(); ++i) {
+            selection[i] = isAnd ? (selection[i] && right[i]) : (selection[i] || right[i]);
         }
+        return;
     }
 
-    if (expression->logicalOperator == "AND") {
-        return evaluateExpression(row, expression->left) && evaluateExpression(row, expression->right);
-    } else if (expression->logicalOperator == "OR") {
-        return evaluateExpression(row, expression->right) || evaluateExpression(row, expression->left);
+    const Column *column = table.findColumn(expression->column);
+    if (column == nullptr) {
+        throw std::runtime_error("Error: Column name '" + expression->column + "' not found in Row::getValue");
     }
-
-    throw std::runtime_error("Unknown or unhandled expression operator");
+    if (!table.hasEncoded(*column)) {
+        selection.assign(end - begin, compareValues(column->defaultValue, expression->operators, expression->value));
+        return;
+    }
+    filterEncoded(table.encoded[column->ordinal], begin, end, expression->operators, expression->value, selection);
 }
 
 bool Database::isNumeric(const std::string &str) {
@@ -266,38 +2340,50 @@ auto Row::getValue(const std::string &columnName) -> std::string const {
         throw std::runtime_error("ERROR: Nie istniejąca kolumna:  " + columnName);
     }
 
-    for (size_t i = 0; i < columns->size(); ++i) {
-        if ((*columns)[i].name == columnName) {
-            if (i < Data.size()) {
-                return Data[i];
-
-            } else {
-                return "Data not faund";
-            }
+    for (const auto &column: *columns) {
+        if (column.name == columnName) {
+            return value(column);
         }
     }
     throw std::runtime_error("Error: Column name '" + columnName + "' not found in Row::getValue");
 }
 
+auto Row::value(const Column &column) const -> std::string {
+    if (column.ordinal < Data.size()) {
+        return Data[column.ordinal];
+    }
+    return column.defaultValue;
+}
+
+
+auto Row::canUpdate(const Column &column) const -> bool {
+    return value(column).empty();
+}
 
-auto Row::canUpdate(size_t columnIndex) -> bool {
-    return columnIndex < Data.size() && Data[columnIndex].empty();
+auto Row::setValue(const Column &column, const std::string &newValue) -> void {
+    widen(column.ordinal + 1);
+    Data[column.ordinal] = newValue;
 }
 
-auto Row::setValue(size_t columnIndex, const Row &inputRow) -> void {
-    if (columnIndex >= columns->size()) {
-        throw std::runtime_error("Column index out of range");
+// Dopisuje brakujące miejsca, wypełniając je wartościami domyślnymi kolumn dodanych po zapisaniu wiersza.
+auto Row::widen(size_t width) -> void {
+    if (Data.size() >= width) {
+        return;
     }
-    if (Data.size() <= columnIndex) {
-        Data.resize(columns->size(), "");
+    size_t oldSize = Data.size();
+    Data.resize(width, "");
+    if (columns == nullptr) {
+        return;
     }
-    if (!inputRow.Data.empty()) {
-        Data[columnIndex] = inputRow.Data[0];
+    for (const auto &column: *columns) {
+        if (column.ordinal >= oldSize && column.ordinal < width) {
+            Data[column.ordinal] = column.defaultValue;
+        }
     }
 }
 
 
-auto Database::getColumnType(const std::string &tableName, const std::string &columnName) const -> std::string {
+auto Database::getColumnType(const std::string &tableName, const std::string &columnName) const -> ColumnType {
     for (const auto &table: tables) {
         if (table.name == tableName) {
             for (const auto &column: table.columns) {
@@ -320,6 +2406,18 @@ auto Database::isInteger(const std::string &value) -> bool {
     return (*p == 0);
 }
 
+auto Database::matchesType(ColumnType columnType, const std::string &value) -> bool {
+    switch (columnType) {
+        case ColumnType::Int:
+            return isInteger(value);
+        case ColumnType::String:
+            return isString(value);
+        case ColumnType::Bool:
+            return isBoolean(value);
+    }
+    return false;
+}
+
 auto Database::isBoolean(const std::string &value) -> bool {
     return value == "true" || value == "false";
 }
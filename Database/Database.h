@@ -8,6 +8,65 @@
 #include "Column.h"
 #include "Row.h"
 #include "Table.h"
+#include "Stats.h"
+#include "LazyTable.h"
+#include "ResultCache.h"
+#include "CostModel.h"
+#include "RowFilter.h"
+#include "Memory.h"
+#include "Approximate.h"
+
+// Udział usuniętych wierszy, po którego przekroczeniu Compactor przepisuje tabelę.
+constexpr double COMPACTION_DELETED_FRACTION = 0.2;
+
+/*
+ * Blokada całej bazy: jedno polecenie CLI albo jeden krok pracy w tle na raz.
+ * Kopiowanie/przenoszenie Database (np. db = loadDatabase(...)) zostawia tę samą blokadę.
+ */
+struct DatabaseLatch {
+    DatabaseLatch() = default;
+    DatabaseLatch(const DatabaseLatch &) {}
+    auto operator=(const DatabaseLatch &) -> DatabaseLatch & { return *this; }
+
+    std::recursive_mutex mutex;
+};
+
+// Komórka sprzed zapisu w transakcji: rozmiar Row::Data wiersza i wartość miejsca (gdy mieściło się w dataSize).
+struct CellUndo {
+    std::size_t row = 0;
+    std::size_t ordinal = 0;
+    std::size_t dataSize = 0;
+    std::string value{};
+};
+
+// Stan jednej tabeli sprzed COMMIT; table == nullopt oznacza, że tabeli wtedy nie było. Kopia nie ma wierszy,
+// kolumn skompresowanych ani indeksów - wiersze wracają przez obcięcie do rowCount i stare wartości z cells,
+// a rows i encoded trafiają tu dopiero wtedy, gdy zapis usuwa tabelę (DROP) albo ją rozpakowuje.
+struct TableUndo {
+    std::string name;
+    std::size_t position = 0;
+    std::optional<Table> table;
+    std::size_t rowCount = 0;
+    std::vector<CellUndo> cells;
+    std::optional<std::vector<Row>> rows;
+    std::optional<std::vector<EncodedColumn>> encoded;
+};
+
+// Komunikaty poleceń wypisywane przez silnik (INSERT, ANALYZE, COMPRESS, PAGE) trafiają do strumienia bieżącego
+// wątku - domyślnie std::cout, a na czas polecenia CLI ustawia swój (sesje REPLAY - bufor, który je odrzuca).
+auto statementOutput() -> std::ostream &;
+
+class StatementOutput {
+public:
+    explicit StatementOutput(std::ostream &stream);
+    ~StatementOutput();
+
+    StatementOutput(const StatementOutput &) = delete;
+    auto operator=(const StatementOutput &) -> StatementOutput & = delete;
+
+private:
+    std::ostream *previous;
+};
 
 class Database {
 public:
@@ -16,34 +75,161 @@ public:
     auto isBoolean(const std::string &value) -> bool;
     auto isInteger(const std::string &value) -> bool;
     bool isString(const std::string &value);
+    auto matchesType(ColumnType columnType, const std::string &value) -> bool;
 
     // DDL Operations
     auto createTable(const std::string &tableName, const std::vector<Column> &columns) -> void;
+    // Tabela partycjonowana: operacje na niej trafiają tylko do partycji, których WHERE nie wyklucza.
+    auto createTable(const std::string &tableName, const std::vector<Column> &columns,
+                     const PartitionScheme &scheme) -> void;
+    // DROP PARTITIONS FROM t BELOW bound - usuwa przedziały RANGE w całości leżące poniżej bound.
+    auto dropPartitions(const std::string &tableName, long long below) -> std::size_t;
+    // CREATE MATERIALIZED VIEW - wynik zapytania zapisany jako tabela viewName i odtąd poprawiany przyrostowo.
+    auto createView(const std::string &viewName, ViewDefinition definition) -> void;
+    // CREATE INDEX ON t (column) - indeks trigramów zawężający LIKE; DROP INDEX go usuwa.
+    auto createIndex(const std::string &tableName, const std::string &columnName) -> void;
+    auto dropIndex(const std::string &tableName, const std::string &columnName) -> void;
     auto deleteTable(const std::string &tableName) -> void;
     auto addColumn(const std::string &tableName, const Column &column) -> void;
     auto removeColumn(const std::string &tableName, const std::string &columnName) -> void;
 
     // Operacje DML
     auto insertInto(const std::string &tableName, const std::string &columnName, Row inputRow) -> void;
+    // Wartości podane kolumnami (columnValues[i] dla columnNames[i]); zwraca liczbę dopisanych wierszy.
+    auto appendRows(const std::string &tableName, const std::vector<std::string> &columnNames,
+                    std::vector<std::vector<std::string>> columnValues) -> std::size_t;
     auto update(const std::string &tableName, const std::string &columnName, const std::string &newValue) -> void;
+    auto update(const std::string &tableName, const std::string &columnName, const Assignment &assignment,
+                const std::unique_ptr<Expression> &where) -> void;
     auto deleteDataFromColumn(const std::string &tableName, const std::string &columnName,
                               const std::string &dataToDelete) -> void;
 
+    // DELETE FROM ... WHERE - oznacza całe wiersze jako usunięte.
+    auto deleteRows(const std::string &tableName, const std::unique_ptr<Expression> &where) -> void;
+
     // Operacje DQL
+    // sample - TABLESAMPLE: tylko wylosowane bloki (wynik nie trafia do ResultCache).
     auto select(const std::string &tableName, const std::vector<std::string> &columns,
-                const std::string &whereClause) -> std::vector<Row>;
-
-    auto getTables() const -> const std::vector<Table>;
-    auto addTable(const Table &table) -> void;
+                const std::string &whereClause, QueryProfile *profile = nullptr,
+                const TableSample *sample = nullptr) -> std::vector<Row>;
+    // To samo dla gotowego predykatu (API osadzone) - bez tokenizacji i parsowania WHERE.
+    auto select(const std::string &tableName, const std::vector<std::string> &columns,
+                const std::unique_ptr<Expression> &where, QueryProfile *profile = nullptr) -> std::vector<Row>;
+
+    // APPROX_COUNT_DISTINCT / APPROX_QUANTILE - szkic z wartości pasujących wierszy (albo ich próby).
+    auto approximate(const std::string &tableName, const ApproxAggregate &aggregate, const std::string &whereClause,
+                     const TableSample *sample = nullptr) -> ApproxResult;
+
+    // SHOW MEMORY - szacunek pamięci tabel, cache wyników i trwających zapytań oraz stan limitów.
+    auto memoryReport() const -> std::string;
+    // SHOW PARTITIONS - schemat partycjonowania oraz granice i liczba wierszy każdej partycji.
+    auto partitionReport(const std::string &tableName) -> std::string;
+
+    // ANALYZE - statystyki kolumn dla modelu kosztów; pusta nazwa oznacza wszystkie tabele.
+    auto analyze(const std::string &tableName) -> void;
+
+    // Kompresja kolumnowa - tabela wraca do postaci wierszowej przy pierwszym zapisie, a Compactor
+    // kompresuje ją ponownie, gdy zapisy ucichną.
+    auto compressTable(const std::string &tableName) -> void;
+    // Przenosi dane tabeli do pliku stron (pusta ścieżka - table_name.pages); dalej czyta je BufferPool.
+    auto pageTable(const std::string &tableName, const std::string &path) -> void;
+
+    // Czyści do rowBudget martwych komórek po usuniętych kolumnach, usuwa fizycznie wiersze z tabeli,
+    // w której usunięte wiersze przekroczyły COMPACTION_DELETED_FRACTION, albo ponownie kompresuje tabelę
+    // rozpakowaną przez zapis; false gdy nie ma nic do zrobienia.
+    auto compactStep(std::size_t rowBudget) -> bool;
+    auto latch() -> std::recursive_mutex &;
+
+    auto getTables() const -> const std::vector<Table> &;
+    // Do restoreTables albo discardUndo zapisy tych tabel zapamiętują stare wartości zmienianych komórek
+    // (tabele stronicowane kopiują tylko katalog bloków) - koszt zależy od wielkości zmiany, nie tabel.
+    auto saveTables(const std::vector<std::string> &tableNames) -> void;
+    auto restoreTables() -> void;
+    auto discardUndo() -> void;
+    auto addTable(Table table) -> void;
+    // Wczytuje w tle tabele z LOAD, które nie zostały jeszcze użyte.
+    auto startBackgroundLoad() -> void;
+    // Wczytuje od razu wszystkie tabele z LOAD (np. przed fork() w SAVE ASYNC).
+    auto loadAllTables() -> void;
     auto matchCondition(Row &row, const std::unique_ptr<Expression> &expression) -> bool;
     auto evaluateExpression(Row &row, const std::unique_ptr<Expression> &expression) -> bool;
-    auto getColumnType(const std::string &tableName, const std::string &columnName) const -> std::string;
+    auto getColumnType(const std::string &tableName, const std::string &columnName) const -> ColumnType;
     auto isNumeric(const std::string &str) -> bool;
+    auto evaluateEncoded(const Table &table, const Expression *expression, std::size_t begin, std::size_t end,
+                         std::vector<char> &selection) -> void;
 
 
 
 private:
+    auto matchingRows(Table &table, const std::unique_ptr<Expression> &where, QueryProfile &counters,
+                      const TableSample *sample = nullptr) -> std::vector<std::size_t>;
+    // WHERE z LIKE na kolumnie z indeksem (sam albo w AND): sprawdzane są tylko wiersze wskazane przez indeks.
+    auto indexScan(Table &table, const Expression *where, QueryProfile &counters)
+    -> std::optional<std::vector<std::size_t>>;
+    // Nowe wartości komórek istniejących wierszy trafiają do indeksu kolumny (nowe wiersze dopisuje indexedRows).
+    auto reindexCells(Table &table, const std::string &columnName, const std::vector<std::size_t> &rows) -> void;
+    auto purgeDeletedRows(Table &table) -> void;
+    // Wpis undo tabeli, której zmiany trzeba zapamiętać; nullptr poza saveTables i dla tabeli po DROP.
+    auto undoEntry(const Table &table) -> TableUndo *;
+    // Przed zmianą komórki istniejącego wiersza.
+    auto logCell(const Table &table, std::size_t row, const Column &column) -> void;
+    // Przed usunięciem tabeli z tables (DROP, DROP PARTITIONS).
+    auto preserveDropped(Table &table) -> void;
+    // Operacje zwiększające dane odmawiają pracy po przekroczeniu limitu pamięci procesu.
+    auto checkMemory(const std::string &operation) -> void;
+    auto cachedRows(const Table &table, const std::string &cacheKey) -> std::optional<std::vector<Row>>;
+    auto selectRows(Table &table, const std::vector<std::string> &columns,
+                    const std::unique_ptr<Expression> &whereExpression, QueryProfile *profile,
+                    const std::string &cacheKey, const TableSample *sample = nullptr) -> std::vector<Row>;
+    // Każda zmiana danych lub schematu tabeli dostaje nową wersję - unieważnia wpisy ResultCache.
+    auto touch(Table &table) -> void;
+    auto updateWholeColumn(Table &table, const Column &column, const std::string &newValue) -> void;
+    // UPDATE z arytmetyką rzuca przy przepełnieniu przed pierwszym zapisem (matches == nullptr - wiersze z where).
+    auto checkArithmetic(Table &table, const Assignment &assignment, const std::unique_ptr<Expression> &where,
+                         const std::vector<std::size_t> *matches) -> void;
+    auto updateRows(Table &table, const std::string &columnName, const Assignment &assignment,
+                    const std::vector<std::size_t> &matches) -> void;
+    // Tabela stronicowana: zmiany zapisywane są jako nowe wersje bloków kolumn, bez wczytywania całej tabeli.
+    auto evaluatePaged(const Table &table, const Expression *expression, std::size_t block, std::size_t rows,
+                       std::vector<char> &selection) -> void;
+    auto appendPaged(Table &table, const std::vector<const Column *> &targets,
+                     std::vector<std::vector<std::string>> &values) -> void;
+    auto insertPaged(Table &table, const Column &column, const std::string &value) -> std::optional<std::size_t>;
+    auto updatePaged(Table &table, const Column &column, const Column *source, const Assignment &assignment,
+                     const std::vector<std::size_t> &matches) -> void;
+    auto rebuildPaged(Table &table) -> void;
+    auto materialize(Table &table) -> void;
+    // Koduje wiersze tabeli (bez usuniętych) do encoded; zwraca rozmiar danych przed i po kodowaniu.
+    auto encodeRows(Table &table, bool verbose) -> std::pair<std::size_t, std::size_t>;
+    auto fillEmptyCell(Table &table, const Column &column, const std::string &value) -> bool;
+    auto appendTargets(const Table &table, const std::vector<std::string> &columnNames,
+                       const std::vector<std::vector<std::string>> &columnValues) -> std::vector<const Column *>;
+    // Partycje: zwykłe tabele w tables, tworzone przy pierwszym wierszu swojego przedziału (HASH - od razu).
+    auto ensurePartition(const PartitionSlot &slot) -> std::string;
+    auto partitionsOf(const std::string &parentName, const Expression *where = nullptr) -> std::vector<Table *>;
+    auto zonesMayMatch(Table &table, const Expression *expression) -> bool;
+    auto insertPartitioned(const std::string &parentName, const std::string &columnName, Row inputRow) -> void;
+    auto appendPartitioned(const std::string &parentName, const std::vector<std::string> &columnNames,
+                           std::vector<std::vector<std::string>> columnValues) -> void;
+    auto selectPartitioned(const std::string &parentName, const std::vector<std::string> &columns,
+                           const std::unique_ptr<Expression> &where, QueryProfile *profile,
+                           const std::string &cacheKey, const TableSample *sample = nullptr) -> std::vector<Row>;
+    // Widoki: zapisy do tabeli bazowej zbierają obrazy zmienionych wierszy sprzed i po zmianie
+    // (tylko gdy tabela ma widoki), a maintainViews nakłada różnicę na każdy widok tej tabeli.
+    auto checkWritable(const Table &table) const -> void;
+    auto hasViews(const Table &table) const -> bool;
+    auto rowImages(const Table &table, const std::vector<std::size_t> &rows) const -> std::vector<RowImage>;
+    auto liveRows(const Table &table, std::size_t first = 0) const -> std::vector<std::size_t>;
+    auto maintainViews(const Table &base, const std::vector<RowImage> &removed,
+                       const std::vector<RowImage> &added) -> void;
+    auto ensureLoaded(Table &table) -> void;
+
     std::vector<Table> tables;
+    std::shared_ptr<BackgroundLoader> backgroundLoader;
+    DatabaseLatch databaseLatch;
+    ResultCache resultCache;
+    std::uint64_t versionClock = 0;
+    std::optional<std::vector<TableUndo>> undoLog;
 
 
 
@@ -0,0 +1,161 @@
+#include "Embedded.h"
+#include <charconv>
+
+namespace {
+    auto combine(const std::string &logicalOperator, std::unique_ptr<Expression> left,
+                 std::unique_ptr<Expression> right) -> std::unique_ptr<Expression> {
+        auto expression = std::make_unique<Expression>();
+        expression->logicalOperator = logicalOperator;
+        expression->left = std::move(left);
+        expression->right = std::move(right);
+        return expression;
+    }
+
+    auto findTableOrThrow(const Database &db, const std::string &tableName) -> const Table & {
+        const auto &tables = db.getTables();
+        auto it = std::ranges::find_if(tables, [&tableName](const Table &table) {
+            return table.name == tableName;
+        });
+        if (it == tables.end()) {
+            throw std::runtime_error("Table not found: " + tableName);
+        }
+        return *it;
+    }
+}
+
+auto operator&&(Condition left, Condition right) -> Condition {
+    return Condition(combine("AND", std::move(left.root), std::move(right.root)));
+}
+
+auto operator||(Condition left, Condition right) -> Condition {
+    return Condition(combine("OR", std::move(left.root), std::move(right.root)));
+}
+
+auto ColumnRef::compare(const std::string &op, const QueryValue &value) const -> Condition {
+    auto expression = std::make_unique<Expression>();
+    expression->column = name;
+    expression->operators = op;
+    expression->value = value.text;
+    return Condition(std::move(expression));
+}
+
+auto ColumnRef::operator==(const QueryValue &value) const -> Condition {
+    return compare("=", value);
+}
+
+auto ColumnRef::operator!=(const QueryValue &value) const -> Condition {
+    return compare("!=", value);
+}
+
+auto ColumnRef::operator<(const QueryValue &value) const -> Condition {
+    return compare("<", value);
+}
+
+auto ColumnRef::operator<=(const QueryValue &value) const -> Condition {
+    return compare("<=", value);
+}
+
+auto ColumnRef::operator>(const QueryValue &value) const -> Condition {
+    return compare(">", value);
+}
+
+auto ColumnRef::operator>=(const QueryValue &value) const -> Condition {
+    return compare(">=", value);
+}
+
+auto ColumnRef::like(const std::string &pattern) const -> Condition {
+    return compare("LIKE", QueryValue(pattern));
+}
+
+auto col(std::string name) -> ColumnRef {
+    return ColumnRef(std::move(name));
+}
+
+
+// Zamiana na tekst odbywa się tutaj, poza blokadą bazy - append() tylko przenosi gotowe wartości.
+auto BatchAppender::column(const std::string &name, std::span<const std::int64_t> values) -> BatchAppender & {
+    std::vector<std::string> texts;
+    texts.reserve(values.size());
+    char buffer[24];
+    for (std::int64_t value: values) {
+        auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        texts.emplace_back(buffer, end);
+    }
+    columnNames.push_back(name);
+    columnValues.push_back(std::move(texts));
+    return *this;
+}
+
+auto BatchAppender::column(const std::string &name, std::span<const std::string_view> values) -> BatchAppender & {
+    columnNames.push_back(name);
+    columnValues.emplace_back(values.begin(), values.end());
+    return *this;
+}
+
+auto BatchAppender::column(const std::string &name, std::span<const bool> values) -> BatchAppender & {
+    std::vector<std::string> texts;
+    texts.reserve(values.size());
+    for (bool value: values) {
+        texts.emplace_back(value ? "true" : "false");
+    }
+    columnNames.push_back(name);
+    columnValues.push_back(std::move(texts));
+    return *this;
+}
+
+auto BatchAppender::append() -> std::size_t {
+    std::vector<std::string> names = std::move(columnNames);
+    std::vector<std::vector<std::string>> values = std::move(columnValues);
+    columnNames.clear();
+    columnValues.clear();
+    std::scoped_lock lock(db->latch());
+    return db->appendRows(tableName, names, std::move(values));
+}
+
+
+auto TableHandle::columns() const -> std::vector<Column> {
+    std::scoped_lock lock(db->latch());
+    return findTableOrThrow(*db, tableName).columns;
+}
+
+auto TableHandle::rowCount() const -> std::size_t {
+    std::scoped_lock lock(db->latch());
+    return findTableOrThrow(*db, tableName).liveRowCount();
+}
+
+auto TableHandle::appender() const -> BatchAppender {
+    return BatchAppender(*db, tableName);
+}
+
+auto TableHandle::select(const std::vector<std::string> &columns) const -> std::vector<Row> {
+    std::scoped_lock lock(db->latch());
+    return db->select(tableName, columns, std::unique_ptr<Expression>());
+}
+
+auto TableHandle::select(const std::vector<std::string> &columns, const Condition &where) const -> std::vector<Row> {
+    std::scoped_lock lock(db->latch());
+    return db->select(tableName, columns, where.expression());
+}
+
+auto TableHandle::deleteWhere(const Condition &where) const -> void {
+    std::scoped_lock lock(db->latch());
+    db->deleteRows(tableName, where.expression());
+}
+
+
+auto EmbeddedDatabase::createTable(const std::string &tableName, const std::vector<Column> &columns) -> TableHandle {
+    std::scoped_lock lock(db.latch());
+    db.createTable(tableName, columns);
+    return TableHandle(db, tableName);
+}
+
+auto EmbeddedDatabase::table(const std::string &tableName) -> TableHandle {
+    std::scoped_lock lock(db.latch());
+    findTableOrThrow(db, tableName);
+    return TableHandle(db, tableName);
+}
+
+auto EmbeddedDatabase::dropTable(const std::string &tableName) -> void {
+    std::scoped_lock lock(db.latch());
+    db.deleteTable(tableName);
+}
@@ -0,0 +1,134 @@
+#ifndef DATABASE2_EMBEDDED_H
+#define DATABASE2_EMBEDDED_H
+#pragma once
+#include "Prerequestion.h"
+#include "Database.h"
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+/*
+ * API do osadzania silnika w innym programie (biblioteka database_core) - bez tekstu SQL.
+ * Dane trafiają do tabel wsadami kolumn, a WHERE budowany jest w kodzie:
+ *
+ *   EmbeddedDatabase engine(db);
+ *   TableHandle orders = engine.createTable("orders", {{"id", ColumnType::Int}, {"city", ColumnType::String}});
+ *   orders.appender().column("id", ids).column("city", cities).append();
+ *   auto rows = orders.select({"id"}, col("id") > 100 && col("city") == "Gdansk");
+ *
+ * Każde wywołanie bierze blokadę bazy, tak jak jedno polecenie CLI.
+ */
+
+// Wartość po prawej stronie porównania, zapisana tak, jak przechowuje ją tabela.
+struct QueryValue {
+    template<std::integral T>
+    QueryValue(T value) {
+        if constexpr (std::same_as<T, bool>) {
+            text = value ? "true" : "false";
+        } else {
+            text = std::to_string(value);
+        }
+    }
+
+    QueryValue(std::string_view value) : text(value) {}
+    QueryValue(const char *value) : text(value) {}
+    QueryValue(const std::string &value) : text(value) {}
+
+    std::string text;
+};
+
+// Gotowy predykat WHERE; && i || łączą warunki tak jak AND i OR w zapytaniu tekstowym.
+class Condition {
+public:
+    explicit Condition(std::unique_ptr<Expression> expression) : root(std::move(expression)) {}
+
+    auto expression() const -> const std::unique_ptr<Expression> & {
+        return root;
+    }
+
+    friend auto operator&&(Condition left, Condition right) -> Condition;
+    friend auto operator||(Condition left, Condition right) -> Condition;
+
+private:
+    std::unique_ptr<Expression> root;
+};
+
+class ColumnRef {
+public:
+    explicit ColumnRef(std::string name) : name(std::move(name)) {}
+
+    auto operator==(const QueryValue &value) const -> Condition;
+    auto operator!=(const QueryValue &value) const -> Condition;
+    auto operator<(const QueryValue &value) const -> Condition;
+    auto operator<=(const QueryValue &value) const -> Condition;
+    auto operator>(const QueryValue &value) const -> Condition;
+    auto operator>=(const QueryValue &value) const -> Condition;
+    // Wzorzec jak w WHERE ... LIKE: % - dowolny ciąg, _ - jeden znak.
+    auto like(const std::string &pattern) const -> Condition;
+
+private:
+    auto compare(const std::string &op, const QueryValue &value) const -> Condition;
+
+    std::string name;
+};
+
+auto col(std::string name) -> ColumnRef;
+
+/*
+ * Zbiera kolumny wsadu i dopisuje je do tabeli jednym wywołaniem append().
+ * Wszystkie kolumny wsadu muszą mieć tę samą długość; pozostałe kolumny nowych wierszy zostają puste.
+ */
+class BatchAppender {
+public:
+    auto column(const std::string &name, std::span<const std::int64_t> values) -> BatchAppender &;
+    auto column(const std::string &name, std::span<const std::string_view> values) -> BatchAppender &;
+    auto column(const std::string &name, std::span<const bool> values) -> BatchAppender &;
+    // Zwraca liczbę dopisanych wierszy; po wywołaniu appender jest pusty i można go użyć ponownie.
+    auto append() -> std::size_t;
+
+private:
+    friend class TableHandle;
+    BatchAppender(Database &db, std::string tableName) : db(&db), tableName(std::move(tableName)) {}
+
+    Database *db;
+    std::string tableName;
+    std::vector<std::string> columnNames;
+    std::vector<std::vector<std::string>> columnValues;
+};
+
+// Uchwyt tabeli - pamięta tylko nazwę, więc po DROP kolejne wywołania zgłoszą brak tabeli.
+class TableHandle {
+public:
+    auto name() const -> const std::string & {
+        return tableName;
+    }
+
+    auto columns() const -> std::vector<Column>;
+    auto rowCount() const -> std::size_t;
+    auto appender() const -> BatchAppender;
+    auto select(const std::vector<std::string> &columns) const -> std::vector<Row>;
+    auto select(const std::vector<std::string> &columns, const Condition &where) const -> std::vector<Row>;
+    auto deleteWhere(const Condition &where) const -> void;
+
+private:
+    friend class EmbeddedDatabase;
+    TableHandle(Database &db, std::string tableName) : db(&db), tableName(std::move(tableName)) {}
+
+    Database *db;
+    std::string tableName;
+};
+
+class EmbeddedDatabase {
+public:
+    explicit EmbeddedDatabase(Database &db) : db(db) {}
+
+    auto createTable(const std::string &tableName, const std::vector<Column> &columns) -> TableHandle;
+    auto table(const std::string &tableName) -> TableHandle;
+    auto dropTable(const std::string &tableName) -> void;
+
+private:
+    Database &db;
+};
+
+#endif //DATABASE2_EMBEDDED_H
@@ -16,4 +16,16 @@ https://learn.microsoft.com/en-us/cpp/cpp/smart-pointers-modern-cpp?view=msvc-17
     std::string logicalOperator;
 };
 
+// Prawa strona UPDATE ... WITH [...]: stała albo "kolumna op liczba" (+, -, *, /).
+struct Assignment {
+    std::string value;
+    std::string sourceColumn;
+    std::string arithmeticOperator;
+    long long operand = 0;
+
+    auto isArithmetic() const -> bool {
+        return !arithmeticOperator.empty();
+    }
+};
+
 #endif // EXPRESSION_H
\ No newline at end of file
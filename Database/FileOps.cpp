@@ -1,48 +1,314 @@
 #include "FileOps.h"
+#include "Trace.h"
+#include "Cancellation.h"
+#include "LegacyImport.h"
+#include <numeric>
 /*
- * Format pseudo-json przy zapisie do pliku
- * https://kishoreganesh.com/post/writing-a-json-parser-in-cplusplus/
+ * Binarny, kolumnowy format snapshotu:
+ *   SNAPSHOT_MAGIC, wersja,
+ *   fragmenty tabel: mapy stref i osobno każda kolumna zakodowana przez encodeColumn,
+ *   katalog: nazwa, schemat, liczba wierszy, położenie fragmentu stref i fragmentów kolumn
+ *            oraz (od wersji 5) schemat partycjonowania albo miejsce partycji, (od wersji 6) definicja
+ *            widoku zmaterializowanego - jego wiersze zapisywane są jak wiersze zwykłej tabeli,
+ *            a (od wersji 7) kolumny z indeksem trigramów - sam indeks buduje się od nowa po LOAD,
+ *   stopka: offset katalogu + SNAPSHOT_MAGIC.
+ * LOAD czyta tylko stopkę i katalog, a fragmenty wczytywane są leniwie (LazyTableSource), równolegle
+ * po tabelach i kolumnach. Wersje 2 i 3 trzymały tabelę w jednej ciągłej sekcji i nadal są wczytywane.
+ * Stary format pseudo-json (Backup.txt) nadal jest wczytywany - przez importLegacyBackup (LegacyImport.h).
  */
-auto FileOps::saveDatabase(const Database &db, const std::string &filename) -> void {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Unable to open file for writing: " + filename);
+namespace {
+    // 0 - zwykła tabela, 1 - tabela partycjonowana, 2 - partycja.
+    auto writePartitioning(std::ostream &out, const Table &table) -> void {
+        if (table.partitioning) {
+            writeU64(out, 1);
+            writeU64(out, static_cast<std::uint64_t>(table.partitioning->method));
+            writeString(out, table.partitioning->column);
+            writeI64(out, table.partitioning->width);
+            writeU64(out, table.partitioning->count);
+        } else if (table.partition) {
+            writeU64(out, 2);
+            writeString(out, table.partition->parent);
+            writeI64(out, table.partition->bucket);
+            writeU64(out, table.partition->fallback);
+        } else {
+            writeU64(out, 0);
+        }
+    }
+
+    auto readPartitioning(std::istream &in, Table &table) -> void {
+        std::uint64_t kind = readU64(in);
+        if (kind == 1) {
+            PartitionScheme scheme;
+            scheme.method = static_cast<PartitionMethod>(readU64(in));
+            scheme.column = readString(in);
+            scheme.width = readI64(in);
+            scheme.count = readU64(in);
+            table.partitioning = scheme;
+        } else if (kind == 2) {
+            PartitionSlot slot;
+            slot.parent = readString(in);
+            slot.bucket = readI64(in);
+            slot.fallback = readU64(in) != 0;
+            table.partition = slot;
+        } else if (kind != 0) {
+            throw std::runtime_error("Corrupted snapshot file: unknown partitioning");
+        }
     }
 
-    file << "{\n";
-    for (const auto &table : db.getTables()) {
-        file << "  \"TABLE\": \"" << table.name << "\",\n";
-        file << "  \"COLUMNS\": [\n";
-        for (size_t i = 0; i < table.columns.size(); ++i) {
-            file << "    {\"name\": \"" << table.columns[i].name << "\", \"type\": \"" << table.columns[i].type << "\"}";
-            if (i < table.columns.size() - 1) {
-                file << ",";
+    // 0 - zwykła tabela, 1 - widok: tabela bazowa, kolumny i tekst WHERE (parsowany przy wczytaniu).
+    auto writeView(std::ostream &out, const Table &table) -> void {
+        writeU64(out, table.view.has_value());
+        if (table.view) {
+            writeString(out, table.view->base);
+            writeU64(out, table.view->columns.size());
+            for (const auto &column: table.view->columns) {
+                writeString(out, column);
             }
-            file << "\n";
-        }
-        file << "  ],\n";
-        file << "  \"ROWS\": [\n";
-        for (size_t j = 0; j < table.rows.size(); ++j) {
-            file << "    {";
-            for (size_t k = 0; k < table.rows[j].Data.size(); ++k) {
-                file << "\"" << table.columns[k].name << "\": \"" << table.rows[j].Data[k] << "\"";
-                if (k < table.rows[j].Data.size() - 1) {
-                    file << ", ";
-                }
+            writeString(out, table.view->whereClause);
+        }
+    }
+
+    auto readView(std::istream &in, Table &table) -> void {
+        if (readU64(in) == 0) {
+            return;
+        }
+        ViewDefinition view;
+        view.base = readString(in);
+        view.columns.resize(readU64(in));
+        for (auto &column: view.columns) {
+            column = readString(in);
+        }
+        view.whereClause = readString(in);
+        view.where = parseViewWhere(view.whereClause);
+        table.view = std::move(view);
+    }
+
+    auto writeIndexes(std::ostream &out, const Table &table) -> void {
+        writeU64(out, table.indexes.size());
+        for (const auto &index: table.indexes) {
+            writeString(out, index.column);
+        }
+    }
+
+    auto readIndexes(std::istream &in, Table &table) -> void {
+        std::uint64_t count = readU64(in);
+        for (std::uint64_t i = 0; i < count; ++i) {
+            table.indexes.emplace_back(readString(in));
+        }
+    }
+
+    // Plik tymczasowy SAVE; bez commit (błąd, anulowanie) jest usuwany.
+    struct PartialFile {
+        explicit PartialFile(std::string path) : path(std::move(path)) {}
+
+        ~PartialFile() {
+            if (!committed) {
+                std::error_code ignored;
+                std::filesystem::remove(path, ignored);
             }
-            file << "}";
-            if (j < table.rows.size() - 1) {
-                file << ",";
+        }
+
+        auto commit(const std::string &target) -> void {
+            std::filesystem::rename(path, target);
+            committed = true;
+        }
+
+        std::string path;
+        bool committed = false;
+    };
+}
+
+auto FileOps::saveDatabase(const Database &db, const std::string &filename, const SaveProgress &progress) -> void {
+    TRACE_SPAN("FileOps::saveDatabase");
+    // Sekcje tabel jeszcze niewczytanych mogą pochodzić z pliku, który zaraz nadpiszemy.
+    for (const auto &table: db.getTables()) {
+        if (table.lazySource) {
+            table.lazySource->load();
+        }
+    }
+
+    // Snapshot powstaje obok i zastępuje plik dopiero w całości - przerwany SAVE nie niszczy poprzedniego.
+    PartialFile partial(filename + ".partial");
+    std::vector<char> buffer(SNAPSHOT_WRITE_BUFFER);
+    std::ofstream file;
+    file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.open(partial.path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file for writing: " + partial.path);
+    }
+    StatementContext *statement = StatementContext::current();
+    std::uint64_t totalRows = 0;
+    for (const auto &table: db.getTables()) {
+        totalRows += table.lazySource ? table.encodedRowCount : table.liveRowCount();
+    }
+    reportPhase("save", totalRows);
+
+    file.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writeU64(file, SNAPSHOT_VERSION);
+
+    auto writeChunk = [&file](const std::string &bytes) -> ChunkRef {
+        ChunkRef chunk{static_cast<std::uint64_t>(file.tellp()), bytes.size()};
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        return chunk;
+    };
+
+    std::vector<TableChunks> tableChunks;
+    for (const auto &table: db.getTables()) {
+        TRACE_SPAN("FileOps::save table");
+        checkCancellation();
+        // Kolumny kodowane są równolegle, a zapis do pliku idzie po kolei, więc układ pliku nie zależy od wątków.
+        std::vector<std::string> columnBytes(table.columns.size());
+        std::string zoneBytes;
+        if (table.lazySource) {
+            const TableSection &section = table.lazySource->load();
+            zoneBytes = encodeZonesChunk(section.zones);
+            ThreadPool::shared().parallelFor(columnBytes.size(), [&](std::size_t c) {
+                TRACE_SPAN("FileOps::save encode column");
+                if (statement != nullptr) {
+                    statement->checkpoint();
+                }
+                columnBytes[c] = encodeColumnChunk(section.encoded[c]);
+            });
+        } else {
+            // Kolumny zapisujemy w kolejności logicznej, więc martwe miejsca po usuniętych kolumnach znikają.
+            // Nieaktualne strefy nie są zapisywane - przy wczytaniu zostaną odbudowane.
+            // Usunięte wiersze (DELETE ... WHERE) pomijamy, więc wtedy kolumny kodujemy od nowa bez stref.
+            std::vector<ZoneMap> zones;
+            bool zonesValid = zonesMatchRows(table) && table.deletedCount == 0;
+            for (size_t block = 0; zonesValid && block < table.zones.size(); ++block) {
+                ZoneMap zone;
+                for (const auto &column: table.columns) {
+                    zone.columns.push_back(zoneColumn(table, block, column));
+                }
+                zones.push_back(std::move(zone));
             }
-            file << "\n";
+            zoneBytes = encodeZonesChunk(zones);
+            ThreadPool::shared().parallelFor(columnBytes.size(), [&](std::size_t c) {
+                TRACE_SPAN("FileOps::save encode column");
+                if (statement != nullptr) {
+                    statement->checkpoint();
+                }
+                const Column &column = table.columns[c];
+                if (table.hasEncoded(column) && table.deletedCount == 0) {
+                    columnBytes[c] = encodeColumnChunk(table.encoded[column.ordinal]);
+                    return;
+                }
+                std::vector<std::string> values;
+                values.reserve(table.liveRowCount());
+                for (size_t i = 0; i < table.rowCount(); ++i) {
+                    if (!table.isDeleted(i)) {
+                        values.push_back(table.valueAt(i, column));
+                    }
+                }
+                columnBytes[c] = encodeColumnChunk(encodeColumn(values, column.type));
+            });
         }
-        file << "  ]\n";
-        if (&table != &db.getTables().back()) {
-            file << "},\n";
+
+        TableChunks chunks;
+        chunks.zones = writeChunk(zoneBytes);
+        for (const auto &bytes: columnBytes) {
+            chunks.columns.push_back(writeChunk(bytes));
+        }
+        tableChunks.push_back(std::move(chunks));
+        reportProgress(table.lazySource ? table.encodedRowCount : table.liveRowCount(),
+                       zoneBytes.size() + std::accumulate(columnBytes.begin(), columnBytes.end(), std::size_t{0},
+                                                          [](std::size_t sum, const std::string &bytes) {
+                                                              return sum + bytes.size();
+                                                          }));
+        if (progress) {
+            progress(tableChunks.size(), db.getTables().size());
         }
     }
-    file << "}\n";
+
+    TRACE_SPAN("FileOps::save directory");
+    auto directoryOffset = static_cast<std::uint64_t>(file.tellp());
+    writeU64(file, db.getTables().size());
+    for (size_t t = 0; t < db.getTables().size(); ++t) {
+        const auto &table = db.getTables()[t];
+        writeString(file, table.name);
+        writeU64(file, table.columns.size());
+        for (const auto &column: table.columns) {
+            writeString(file, column.name);
+            writeString(file, columnTypeName(column.type));
+            writeString(file, column.defaultValue);
+        }
+        writeU64(file, table.liveRowCount());
+        writeU64(file, tableChunks[t].zones.offset);
+        writeU64(file, tableChunks[t].zones.length);
+        for (const auto &chunk: tableChunks[t].columns) {
+            writeU64(file, chunk.offset);
+            writeU64(file, chunk.length);
+        }
+        writePartitioning(file, table);
+        writeView(file, table);
+        writeIndexes(file, table);
+    }
+    writeU64(file, directoryOffset);
+    file.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+
+    checkCancellation();
+    Stats::instance().addBytesWritten(static_cast<std::size_t>(file.tellp()));
     file.close();
+    if (!file) {
+        throw std::runtime_error("Unable to write file: " + partial.path);
+    }
+    partial.commit(filename);
+    saveStatistics(db, filename);
+}
+
+auto FileOps::saveStatistics(const Database &db, const std::string &filename) -> void {
+    TRACE_SPAN("FileOps::saveStatistics");
+    std::string statisticsFile = filename + ".stats";
+    std::size_t analyzed = std::ranges::count_if(db.getTables(), [](const Table &table) {
+        return table.statistics != nullptr;
+    });
+    // Bez statystyk nie zostawiamy starego pliku - opisywałby inne dane.
+    if (analyzed == 0) {
+        std::error_code ignored;
+        std::filesystem::remove(statisticsFile, ignored);
+        return;
+    }
+
+    std::ofstream file(statisticsFile, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file for writing: " + statisticsFile);
+    }
+    file.write(STATISTICS_MAGIC, sizeof(STATISTICS_MAGIC));
+    writeU64(file, analyzed);
+    for (const auto &table: db.getTables()) {
+        if (table.statistics != nullptr) {
+            writeString(file, table.name);
+            writeTableStatistics(file, *table.statistics);
+        }
+    }
+    Stats::instance().addBytesWritten(static_cast<std::size_t>(file.tellp()));
+}
+
+auto FileOps::loadStatistics(const std::string &filename) -> StatisticsMap {
+    StatisticsMap statistics;
+    std::ifstream file(filename + ".stats", std::ios::binary);
+    if (!file.is_open()) {
+        return statistics;
+    }
+    char magic[sizeof(STATISTICS_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    if (!file || !std::equal(magic, magic + sizeof(magic), STATISTICS_MAGIC)) {
+        std::cerr << "Ignoring corrupted statistics file: " << filename << ".stats" << std::endl;
+        return statistics;
+    }
+    try {
+        std::uint64_t tables = readU64(file);
+        for (std::uint64_t t = 0; t < tables; ++t) {
+            std::string name = readString(file);
+            statistics[name] = std::make_shared<const TableStatistics>(readTableStatistics(file));
+        }
+    } catch (const std::exception &e) {
+        // Statystyki są tylko podpowiedzią dla planu - bez nich baza działa jak przed ANALYZE.
+        std::cerr << "Ignoring corrupted statistics file: " << e.what() << std::endl;
+        statistics.clear();
+    }
+    Stats::instance().addBytesRead(static_cast<std::size_t>(file.tellg()));
+    return statistics;
 }
 
 auto FileOps::trim(const std::string &str) -> std::string {
@@ -53,99 +319,101 @@ auto FileOps::trim(const std::string &str) -> std::string {
 
 
 auto FileOps::loadDatabase(const std::string &filename) -> Database {
-    std::ifstream file(filename);
+    TRACE_SPAN("FileOps::loadDatabase");
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         throw std::runtime_error("Unable to open file for reading: " + filename);
     }
 
+    char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    StatisticsMap statistics = loadStatistics(filename);
+    if (file.gcount() == sizeof(magic) && std::equal(magic, magic + sizeof(magic), SNAPSHOT_MAGIC)) {
+        Database db = loadSnapshotDirectory(file, filename, statistics);
+        db.startBackgroundLoad();
+        return db;
+    }
+
+    file.clear();
+    file.seekg(0, std::ios::end);
+    Stats::instance().addBytesRead(static_cast<std::size_t>(file.tellg()));
+    file.close();
+    return loadLegacyDatabase(filename, statistics);
+}
+
+auto FileOps::loadSnapshotDirectory(std::istream &file, const std::string &filename,
+                                    const StatisticsMap &statistics) -> Database {
+    TRACE_SPAN("FileOps::load directory");
+    std::uint64_t version = readU64(file);
+    if (version < 2 || version > SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version");
+    }
+
+    char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    file.seekg(-static_cast<std::streamoff>(sizeof(std::uint64_t) + sizeof(magic)), std::ios::end);
+    std::uint64_t directoryOffset = readU64(file);
+    file.read(magic, sizeof(magic));
+    if (!file || !std::equal(magic, magic + sizeof(magic), SNAPSHOT_MAGIC)) {
+        throw std::runtime_error("Corrupted snapshot file: missing footer");
+    }
+    file.seekg(static_cast<std::streamoff>(directoryOffset));
+
     Database db;
-    std::string line;
-    Table currentTable;
-    bool inTable = false;
-
-    while (getline(file, line)) {
-        line = trim(line);
-
-        if (line.starts_with("\"TABLE\":")) {
-            std::string tableName = extractValue(line, "\"TABLE\":");
-            if (!tableName.empty()) {
-                currentTable.name = tableName;
-                currentTable.columns.clear();
-                currentTable.rows.clear();
-                inTable = true;
+    std::uint64_t tableCount = readU64(file);
+    for (std::uint64_t t = 0; t < tableCount; ++t) {
+        Table table;
+        table.name = readString(file);
+        table.columns.resize(readU64(file));
+        for (auto &column: table.columns) {
+            column.name = readString(file);
+            column.type = parseColumnType(readString(file));
+            // Wersja 2 nie zapisywała wartości domyślnych kolumn.
+            if (version > 2) {
+                column.defaultValue = readString(file);
             }
         }
-        else if (inTable && line.starts_with("\"COLUMNS\":")) {
-            while (getline(file, line) && !line.starts_with("  ],")) {
-                line = trim(line);
-                std::cout << "Column line: " << line << std::endl;
-
-                if (line.starts_with("{")) {
-                    std::string columnName = extractValue(line, "\"name\":");
-                    std::string columnType = extractValue(line, "\"type\":");
-
-                    if (!columnName.empty() && !columnType.empty()) {
-                        Column column;
-                        column.name = columnName;
-                        column.type = columnType;
-                        currentTable.columns.push_back(column);
-                        std::cout << "Added column: " << columnName << " of type " << columnType << std::endl;
-                    } else {
-                        std::cerr << "Failed to parse column from line: " << line << std::endl;
-                    }
-                }
+        table.assignOrdinals();
+        table.encodedRowCount = readU64(file);
+        table.compressed = true;
+        TableChunks chunks;
+        chunks.zones.offset = readU64(file);
+        chunks.zones.length = readU64(file);
+        // Od wersji 4 każda kolumna ma własny fragment; wcześniej fragment stref obejmował całą sekcję.
+        if (version > 3) {
+            chunks.columns.resize(table.columns.size());
+            for (auto &chunk: chunks.columns) {
+                chunk.offset = readU64(file);
+                chunk.length = readU64(file);
             }
         }
-        else if (inTable && line.starts_with("\"ROWS\":")) {
-            std::vector<Row> tempRows;
-
-            int currentRowIndex = 0;
-            while (getline(file, line)) {
-                line = trim(line);
-                if (line.starts_with("{")) {
-                    std::istringstream iss(line);
-                    std::string token;
-                    getline(iss, token, ':');
-                    token = trim(token);
-                    size_t nameStart = token.find('\"') + 1;
-                    size_t nameEnd = token.find('\"', nameStart);
-                    std::string columnName = token.substr(nameStart, nameEnd - nameStart);
-
-                    getline(iss, token, '}');
-                    std::string value = trim(extractValue(token, "\"\":"));
-
-                    auto it = std::ranges::find_if(currentTable.columns.begin(), currentTable.columns.end(),
-                                           [&](const Column& col) { return col.name == columnName; });
-                    if (it != currentTable.columns.end()) {
-                        int colIndex = std::distance(currentTable.columns.begin(), it);
-                        if (currentRowIndex < tempRows.size()) {
-                            tempRows[currentRowIndex].Data[colIndex] = value;
-                        }
-                    }
-                } else if (line == "],") {
-
-                    break;
-                } else if (line == "},") {
-                    currentRowIndex++;
-                }
-            }
-
-
-            for (auto& row : tempRows) {
-                if (!row.Data.empty()) {
-                    currentTable.rows.push_back(row);
-                    std::cout << "Added row" << std::endl;
-                }
-            }
+        if (version > 4) {
+            readPartitioning(file, table);
         }
-
-        else if (inTable && line == "},") {
-            db.addTable(currentTable);
-            inTable = false;
+        if (version > 5) {
+            readView(file, table);
+        }
+        if (version > 6) {
+            readIndexes(file, table);
+        }
+        table.lazySource = std::make_shared<LazyTableSource>(filename, std::move(chunks), table.columns.size(),
+                                                             table.encodedRowCount);
+        if (auto it = statistics.find(table.name); it != statistics.end()) {
+            table.statistics = it->second;
         }
+        db.addTable(table);
     }
+    Stats::instance().addBytesRead(static_cast<std::size_t>(file.tellg()) - directoryOffset);
+    return db;
+}
 
-    file.close();
+auto FileOps::loadLegacyDatabase(const std::string &filename, const StatisticsMap &statistics) -> Database {
+    TRACE_SPAN("FileOps::load legacy");
+    Database db;
+    for (auto &table: importLegacyBackup(filename)) {
+        auto it = statistics.find(table.name);
+        table.statistics = it == statistics.end() ? nullptr : it->second;
+        db.addTable(std::move(table));
+    }
     return db;
 }
 
@@ -2,17 +2,42 @@
 #define FILEOPS_H
 #pragma once
 #include "Database.h"
+#include "BinaryIO.h"
+#include "TableStatistics.h"
+#include "ThreadPool.h"
+#include <filesystem>
+#include <functional>
+#include <map>
 
+constexpr char SNAPSHOT_MAGIC[8] = {'D', 'B', '2', 'S', 'N', 'A', 'P', '\0'};
+constexpr std::uint64_t SNAPSHOT_VERSION = 7;
+// Bufor strumienia przy zapisie snapshotu - fragmenty kolumn trafiają do pliku dużymi blokami.
+constexpr std::size_t SNAPSHOT_WRITE_BUFFER = 1 << 20;
+constexpr char STATISTICS_MAGIC[8] = {'D', 'B', '2', 'S', 'T', 'A', 'T', '\0'};
+
+
+// Wywoływane po zapisaniu każdej tabeli: (zapisane tabele, wszystkie tabele).
+using SaveProgress = std::function<void(std::size_t, std::size_t)>;
 
 class FileOps {
 public:
-    auto saveDatabase(const Database &db, const std::string &filename) -> void;
+    auto saveDatabase(const Database &db, const std::string &filename, const SaveProgress &progress = nullptr) -> void;
 
     auto loadDatabase(const std::string &filename) -> Database;
 
     auto  trim(const std::string &str) -> std::string;
 
     auto extractValue(const std::string &line, const std::string &key) -> std::string;
+
+private:
+    using StatisticsMap = std::map<std::string, std::shared_ptr<const TableStatistics>>;
+
+    auto loadSnapshotDirectory(std::istream &file, const std::string &filename,
+                               const StatisticsMap &statistics) -> Database;
+    auto loadLegacyDatabase(const std::string &filename, const StatisticsMap &statistics) -> Database;
+    // Statystyki ANALYZE leżą obok snapshotu w pliku <snapshot>.stats.
+    auto saveStatistics(const Database &db, const std::string &filename) -> void;
+    auto loadStatistics(const std::string &filename) -> StatisticsMap;
 };
 
 #endif // FILEOPS_H
@@ -0,0 +1,52 @@
+#include "HyperLogLog.h"
+#include <bit>
+#include <cmath>
+
+auto hashValue(const std::string &value) -> std::uint64_t {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c: value) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    // Mieszanie splitmix64 - FNV słabo rozprasza krótkie, podobne klucze w górnych bitach.
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+auto HyperLogLog::add(const std::string &value) -> void {
+    addHash(hashValue(value));
+}
+
+auto HyperLogLog::addHash(std::uint64_t hash) -> void {
+    std::size_t index = hash >> (64 - precision);
+    std::uint64_t rest = hash << precision;
+    auto rank = static_cast<std::uint8_t>(rest == 0 ? 64 - precision + 1 : std::countl_zero(rest) + 1);
+    registers[index] = std::max(registers[index], rank);
+}
+
+auto HyperLogLog::merge(const HyperLogLog &other) -> void {
+    for (std::size_t i = 0; i < registerCount; ++i) {
+        registers[i] = std::max(registers[i], other.registers[i]);
+    }
+}
+
+auto HyperLogLog::estimate() const -> double {
+    double sum = 0.0;
+    std::size_t zeros = 0;
+    for (std::uint8_t value: registers) {
+        sum += std::ldexp(1.0, -value);
+        zeros += value == 0;
+    }
+    const double m = static_cast<double>(registerCount);
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // Dla małych liczności dokładniejsze jest zliczanie pustych rejestrów (linear counting).
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return estimate;
+}
@@ -0,0 +1,29 @@
+#ifndef DATABASE2_HYPERLOGLOG_H
+#define DATABASE2_HYPERLOGLOG_H
+#pragma once
+#include "Prerequestion.h"
+#include <array>
+#include <cstdint>
+
+// 64-bitowy hash napisu (FNV-1a z końcowym mieszaniem), wspólny dla szkiców liczności.
+auto hashValue(const std::string &value) -> std::uint64_t;
+
+/*
+ * Szkic HyperLogLog: 2^12 rejestrów, błąd względny ok. 1.6%, 4 KiB pamięci niezależnie od liczby wartości.
+ * Dwa szkice można łączyć (merge), więc liczność da się liczyć blokami.
+ */
+class HyperLogLog {
+public:
+    auto add(const std::string &value) -> void;
+    auto addHash(std::uint64_t hash) -> void;
+    auto merge(const HyperLogLog &other) -> void;
+    auto estimate() const -> double;
+
+private:
+    static constexpr int precision = 12;
+    static constexpr std::size_t registerCount = std::size_t{1} << precision;
+
+    std::array<std::uint8_t, registerCount> registers{};
+};
+
+#endif //DATABASE2_HYPERLOGLOG_H
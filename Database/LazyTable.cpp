@@ -0,0 +1,176 @@
+#include "LazyTable.h"
+#include "BinaryIO.h"
+#include "Stats.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+namespace {
+    // Rozmiar bufora strumienia przy czytaniu fragmentów - kolumny czytane są jednym dużym odczytem.
+    constexpr std::size_t CHUNK_READ_BUFFER = 1 << 20;
+
+    auto writeZones(std::ostream &out, const std::vector<ZoneMap> &zones) -> void {
+        writeU64(out, zones.size());
+        for (const auto &zone: zones) {
+            for (const auto &columnZone: zone.columns) {
+                writeU64(out, columnZone.nullCount);
+                writeU64(out, columnZone.numericCount);
+                writeU64(out, columnZone.textCount);
+                writeString(out, columnZone.minValue);
+                writeString(out, columnZone.maxValue);
+                writeI64(out, columnZone.minNumber);
+                writeI64(out, columnZone.maxNumber);
+            }
+        }
+    }
+
+    auto readZones(std::istream &in, std::size_t columnCount) -> std::vector<ZoneMap> {
+        std::vector<ZoneMap> zones(readU64(in));
+        for (auto &zone: zones) {
+            zone.columns.resize(columnCount);
+            for (auto &columnZone: zone.columns) {
+                columnZone.nullCount = readU64(in);
+                columnZone.numericCount = readU64(in);
+                columnZone.textCount = readU64(in);
+                columnZone.minValue = readString(in);
+                columnZone.maxValue = readString(in);
+                columnZone.minNumber = readI64(in);
+                columnZone.maxNumber = readI64(in);
+            }
+        }
+        return zones;
+    }
+
+    // Każde wywołanie ma własny strumień, więc fragmenty można czytać z wielu wątków naraz.
+    auto readChunk(const std::string &filename, const ChunkRef &chunk) -> std::string {
+        std::vector<char> buffer(CHUNK_READ_BUFFER);
+        std::ifstream file;
+        file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.open(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Unable to open file for reading: " + filename);
+        }
+        std::string bytes(chunk.length, '\0');
+        file.seekg(static_cast<std::streamoff>(chunk.offset));
+        if (!file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+            throw std::runtime_error("Unexpected end of snapshot file");
+        }
+        return bytes;
+    }
+}
+
+auto encodeZonesChunk(const std::vector<ZoneMap> &zones) -> std::string {
+    std::ostringstream out(std::ios::binary);
+    writeZones(out, zones);
+    return std::move(out).str();
+}
+
+auto encodeColumnChunk(const EncodedColumn &column) -> std::string {
+    std::ostringstream out(std::ios::binary);
+    writeEncodedColumn(out, column);
+    return std::move(out).str();
+}
+
+auto readTableChunks(const std::string &filename, const TableChunks &chunks, std::size_t columnCount,
+                     std::size_t rowCount) -> TableSection {
+    TRACE_SPAN("FileOps::load table");
+    if (chunks.columns.empty() && columnCount > 0) {
+        std::istringstream in(readChunk(filename, chunks.zones), std::ios::binary);
+        return readTableSection(in, columnCount, rowCount);
+    }
+    if (chunks.columns.size() != columnCount) {
+        throw std::runtime_error("Corrupted snapshot file: column chunk count mismatch");
+    }
+
+    TableSection section;
+    section.encoded.resize(columnCount);
+    // Fragment 0 to mapy stref, kolejne to kolumny.
+    ThreadPool::shared().parallelFor(columnCount + 1, [&](std::size_t chunk) {
+        TRACE_SPAN("FileOps::load decode chunk");
+        if (chunk == 0) {
+            std::istringstream in(readChunk(filename, chunks.zones), std::ios::binary);
+            section.zones = readZones(in, columnCount);
+            return;
+        }
+        std::istringstream in(readChunk(filename, chunks.columns[chunk - 1]), std::ios::binary);
+        EncodedColumn column = readEncodedColumn(in);
+        if (column.size != rowCount) {
+            throw std::runtime_error("Corrupted snapshot file: column size mismatch");
+        }
+        section.encoded[chunk - 1] = std::move(column);
+    });
+    return section;
+}
+
+auto readTableSection(std::istream &in, std::size_t columnCount, std::size_t rowCount) -> TableSection {
+    TableSection section;
+    section.zones = readZones(in, columnCount);
+    for (std::size_t c = 0; c < columnCount; ++c) {
+        section.encoded.push_back(readEncodedColumn(in));
+        if (section.encoded.back().size != rowCount) {
+            throw std::runtime_error("Corrupted snapshot file: column size mismatch");
+        }
+    }
+    return section;
+}
+
+
+LazyTableSource::LazyTableSource(std::string filename, TableChunks chunks, std::size_t columnCount,
+                                 std::size_t rowCount)
+        : filename(std::move(filename)), chunks(std::move(chunks)), columnCount(columnCount), rowCount(rowCount) {
+}
+
+auto LazyTableSource::load() -> const TableSection & {
+    std::scoped_lock lock(mutex);
+    if (taken) {
+        throw std::runtime_error("Lazy table section was already handed over");
+    }
+    if (!section) {
+        section = readTableChunks(filename, chunks, columnCount, rowCount);
+        std::uint64_t bytes = chunks.zones.length;
+        for (const auto &chunk: chunks.columns) {
+            bytes += chunk.length;
+        }
+        Stats::instance().addBytesRead(bytes);
+    }
+    return *section;
+}
+
+auto LazyTableSource::take() -> TableSection {
+    load();
+    std::scoped_lock lock(mutex);
+    taken = true;
+    TableSection result = std::move(*section);
+    section.reset();
+    return result;
+}
+
+auto LazyTableSource::isLoaded() -> bool {
+    std::scoped_lock lock(mutex);
+    return taken || section.has_value();
+}
+
+
+BackgroundLoader::BackgroundLoader(std::vector<std::shared_ptr<LazyTableSource>> sources)
+        : worker([this, sources = std::move(sources)]() {
+    // Tabele wczytywane są równolegle; kolumny jednej tabeli czyta wtedy ten sam wątek puli.
+    ThreadPool::shared().parallelFor(sources.size(), [&](std::size_t index) {
+        if (stopRequested.load()) {
+            return;
+        }
+        try {
+            if (!sources[index]->isLoaded()) {
+                sources[index]->load();
+            }
+        } catch (const std::exception &) {
+            // Błąd zostanie zgłoszony ponownie przy pierwszym użyciu tabeli.
+        }
+    });
+}) {
+}
+
+BackgroundLoader::~BackgroundLoader() {
+    stopRequested.store(true);
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef DATABASE2_LAZYTABLE_H
+#define DATABASE2_LAZYTABLE_H
+#pragma once
+#include "Prerequestion.h"
+#include "ZoneMap.h"
+#include "Compression.h"
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// Dane jednej tabeli w snapshocie (schemat i liczba wierszy są w katalogu na końcu pliku).
+struct TableSection {
+    std::vector<ZoneMap> zones;
+    std::vector<EncodedColumn> encoded;
+};
+
+// Położenie jednego fragmentu (mapy stref albo jednej kolumny) w pliku snapshotu.
+struct ChunkRef {
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+};
+
+/*
+ * Fragmenty jednej tabeli z manifestu snapshotu. Każdą kolumnę da się odczytać i zdekodować niezależnie,
+ * więc load() robi to równolegle w ThreadPool. Snapshoty w wersji 2/3 mają jedną ciągłą sekcję
+ * (zones obejmuje wtedy całą sekcję, a columns jest puste).
+ */
+struct TableChunks {
+    ChunkRef zones;
+    std::vector<ChunkRef> columns;
+};
+
+auto encodeZonesChunk(const std::vector<ZoneMap> &zones) -> std::string;
+auto encodeColumnChunk(const EncodedColumn &column) -> std::string;
+auto readTableChunks(const std::string &filename, const TableChunks &chunks, std::size_t columnCount,
+                     std::size_t rowCount) -> TableSection;
+auto readTableSection(std::istream &in, std::size_t columnCount, std::size_t rowCount) -> TableSection;
+
+/*
+ * Sekcja tabeli, która jeszcze nie została wczytana. load() czyta ją raz (bezpiecznie z wielu wątków),
+ * take() oddaje dane tabeli przy pierwszym dotknięciu. Plik snapshotu nie może się zmienić, dopóki
+ * wszystkie sekcje nie zostaną wczytane.
+ */
+class LazyTableSource {
+public:
+    LazyTableSource(std::string filename, TableChunks chunks, std::size_t columnCount, std::size_t rowCount);
+
+    auto load() -> const TableSection &;
+    auto take() -> TableSection;
+    auto isLoaded() -> bool;
+
+private:
+    std::mutex mutex;
+    std::string filename;
+    TableChunks chunks;
+    std::size_t columnCount;
+    std::size_t rowCount;
+    std::optional<TableSection> section;
+    bool taken = false;
+};
+
+// Wczytuje sekcje w tle; destruktor przerywa pracę po bieżącej tabeli i czeka na wątek.
+class BackgroundLoader {
+public:
+    explicit BackgroundLoader(std::vector<std::shared_ptr<LazyTableSource>> sources);
+    ~BackgroundLoader();
+
+    BackgroundLoader(const BackgroundLoader &) = delete;
+    auto operator=(const BackgroundLoader &) -> BackgroundLoader & = delete;
+
+private:
+    std::atomic<bool> stopRequested{false};
+    std::thread worker;
+};
+
+#endif //DATABASE2_LAZYTABLE_H
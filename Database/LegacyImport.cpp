@@ -0,0 +1,531 @@
+#include "LegacyImport.h"
+#include "Cancellation.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#ifdef DATABASE_SIMD_STRUCTURAL
+#include <emmintrin.h>
+#endif
+
+#ifdef DATABASE_MAPPED_IMPORT
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string &filename) {
+#ifdef DATABASE_MAPPED_IMPORT
+            int descriptor = ::open(filename.c_str(), O_RDONLY);
+            if (descriptor < 0) {
+                throw std::runtime_error("Unable to open file for reading: " + filename);
+            }
+            struct stat info{};
+            if (::fstat(descriptor, &info) == 0 && info.st_size > 0) {
+                length = static_cast<std::size_t>(info.st_size);
+                address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            }
+            int error = errno;
+            ::close(descriptor);
+            if (address == MAP_FAILED) {
+                address = nullptr;
+                throw std::runtime_error("Unable to map file " + filename + ": " + std::strerror(error));
+            }
+#else
+            std::ifstream file(filename, std::ios::binary);
+            if (!file.is_open()) {
+                throw std::runtime_error("Unable to open file for reading: " + filename);
+            }
+            contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef DATABASE_MAPPED_IMPORT
+            if (address != nullptr) {
+                ::munmap(address, length);
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+        auto text() const -> std::string_view {
+#ifdef DATABASE_MAPPED_IMPORT
+            return address == nullptr ? std::string_view() : std::string_view(static_cast<const char *>(address), length);
+#else
+            return contents;
+#endif
+        }
+
+    private:
+#ifdef DATABASE_MAPPED_IMPORT
+        void *address = nullptr;
+        std::size_t length = 0;
+#else
+        std::string contents;
+#endif
+    };
+
+    // Bit i odpowiada bajtowi i bloku 64 bajtów.
+    struct BlockMasks {
+        std::uint64_t quotes = 0;
+        std::uint64_t operators = 0;
+    };
+
+    auto classify(const char *block) -> BlockMasks {
+        BlockMasks masks;
+#ifdef DATABASE_SIMD_STRUCTURAL
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i openBrace = _mm_set1_epi8('{');
+        const __m128i closeBrace = _mm_set1_epi8('}');
+        const __m128i colon = _mm_set1_epi8(':');
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i bracketBit = _mm_set1_epi8(0x20);
+        auto bitsOf = [](__m128i matches, int lane) -> std::uint64_t {
+            return static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(matches))) << (16 * lane);
+        };
+        for (int lane = 0; lane < 4; ++lane) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * lane));
+            // [ i ] różnią się od { i } tylko bitem 0x20.
+            __m128i folded = _mm_or_si128(bytes, bracketBit);
+            __m128i operators = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(folded, openBrace), _mm_cmpeq_epi8(folded, closeBrace)),
+                    _mm_or_si128(_mm_cmpeq_epi8(bytes, colon), _mm_cmpeq_epi8(bytes, comma)));
+            masks.quotes |= bitsOf(_mm_cmpeq_epi8(bytes, quote), lane);
+            masks.operators |= bitsOf(operators, lane);
+        }
+#else
+        for (int i = 0; i < 64; ++i) {
+            std::uint64_t bit = std::uint64_t{1} << i;
+            switch (block[i]) {
+                case '"':
+                    masks.quotes |= bit;
+                    break;
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    masks.operators |= bit;
+                    break;
+                default:
+                    break;
+            }
+        }
+#endif
+        return masks;
+    }
+
+    // Bit i = XOR bitów 0..i, czyli bajty od otwierającego cudzysłowu do znaku przed zamykającym.
+    auto prefixXor(std::uint64_t bits) -> std::uint64_t {
+        for (int shift = 1; shift < 64; shift <<= 1) {
+            bits ^= bits << shift;
+        }
+        return bits;
+    }
+
+    // Bitmapa znaków strukturalnych: { } [ ] : , poza napisami oraz wszystkie cudzysłowy.
+    class StructuralIndex {
+    public:
+        explicit StructuralIndex(std::string_view text) : length(text.size()), bits((text.size() + 63) / 64) {
+            TRACE_SPAN("LegacyImport::structural scan");
+            std::uint64_t stringCarry = 0;
+            char tail[64];
+            for (std::size_t word = 0; word < bits.size(); ++word) {
+                const char *block = text.data() + word * 64;
+                if (word * 64 + 64 > text.size()) {
+                    std::memset(tail, ' ', sizeof(tail));
+                    std::memcpy(tail, block, text.size() - word * 64);
+                    block = tail;
+                }
+                BlockMasks masks = classify(block);
+                std::uint64_t inString = prefixXor(masks.quotes) ^ stringCarry;
+                stringCarry = static_cast<std::uint64_t>(static_cast<std::int64_t>(inString) >> 63);
+                bits[word] = (masks.operators & ~inString) | masks.quotes;
+                if (word % (LEGACY_IMPORT_CHUNK / 64) == 0) {
+                    checkCancellation();
+                }
+            }
+            if (stringCarry != 0) {
+                throw std::runtime_error("Corrupted backup file: unterminated string");
+            }
+        }
+
+        // Pozycja pierwszego znaku strukturalnego od from albo długość tekstu.
+        auto next(std::size_t from) const -> std::size_t {
+            std::size_t word = from / 64;
+            if (word >= bits.size()) {
+                return length;
+            }
+            std::uint64_t current = bits[word] & (~std::uint64_t{0} << (from % 64));
+            while (current == 0) {
+                if (++word == bits.size()) {
+                    return length;
+                }
+                current = bits[word];
+            }
+            return word * 64 + static_cast<std::size_t>(std::countr_zero(current));
+        }
+
+        auto isStructural(std::size_t position) const -> bool {
+            return ((bits[position / 64] >> (position % 64)) & 1) != 0;
+        }
+
+    private:
+        std::size_t length;
+        std::vector<std::uint64_t> bits;
+    };
+
+    auto trimmed(std::string_view text) -> std::string_view {
+        std::size_t first = text.find_first_not_of(" \t\n\r");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(first, text.find_last_not_of(" \t\n\r") - first + 1);
+    }
+
+    // Tabela w trakcie wczytywania: wartości kolumn w kolejności wierszy.
+    struct PendingTable {
+        Table table;
+        std::vector<std::vector<std::string>> values;
+        std::size_t rows = 0;
+    };
+
+    // Wiersze jednego kawałka ROWS.
+    struct RowBatch {
+        std::vector<std::vector<std::string>> values;
+        std::size_t rows = 0;
+    };
+
+    class BackupParser {
+    public:
+        BackupParser(std::string_view text, const StructuralIndex &index) : text(text), index(index) {}
+
+        auto parse() -> std::vector<Table> {
+            std::vector<Table> tables;
+            std::optional<PendingTable> pending;
+            auto finish = [&]() {
+                if (pending) {
+                    tables.push_back(buildTable(*pending));
+                    pending.reset();
+                }
+            };
+
+            // Tabele nie mają własnych { - kolejną zaczyna "TABLE", a kończy } albo koniec pliku.
+            std::size_t cursor = index.next(0);
+            while (cursor < text.size()) {
+                if (text[cursor] == '}') {
+                    finish();
+                }
+                if (text[cursor] != '"') {
+                    cursor = index.next(cursor + 1);
+                    continue;
+                }
+                std::size_t keyEnd = index.next(cursor + 1);
+                std::string_view key = text.substr(cursor + 1, keyEnd - cursor - 1);
+                std::size_t colon = index.next(keyEnd + 1);
+                if (at(colon) != ':') {
+                    fail(colon, "expected ':'");
+                }
+                if (key == "TABLE") {
+                    finish();
+                    std::string name = readValue(colon, cursor);
+                    if (!name.empty()) {
+                        pending.emplace();
+                        pending->table.name = std::move(name);
+                    }
+                } else if (pending && key == "COLUMNS") {
+                    cursor = readColumns(colon, *pending);
+                } else if (pending && key == "ROWS" && !pending->table.columns.empty()) {
+                    cursor = readRows(colon, *pending);
+                } else {
+                    cursor = skipValue(colon);
+                }
+            }
+            finish();
+            return tables;
+        }
+
+    private:
+        auto at(std::size_t position) const -> char {
+            return position < text.size() ? text[position] : '\0';
+        }
+
+        [[noreturn]] auto fail(std::size_t position, const std::string &what) const -> void {
+            throw std::runtime_error("Corrupted backup file at byte " + std::to_string(position) + ": " + what);
+        }
+
+        // Wartość za dwukropkiem; position dostaje następny znak strukturalny za nią.
+        auto readValue(std::size_t colon, std::size_t &position) const -> std::string {
+            std::size_t start = index.next(colon + 1);
+            if (at(start) == '"') {
+                std::size_t end = index.next(start + 1);
+                position = index.next(end + 1);
+                return std::string(text.substr(start + 1, end - start - 1));
+            }
+            if (at(start) != ',' && at(start) != '}' && at(start) != ']') {
+                fail(start, "expected a value");
+            }
+            // Liczba, true albo null bez cudzysłowów (kopia poprawiana ręcznie); null to pusta komórka.
+            std::string_view raw = trimmed(text.substr(colon + 1, start - colon - 1));
+            if (raw.empty()) {
+                fail(colon, "missing value");
+            }
+            position = start;
+            return raw == "null" ? std::string() : std::string(raw);
+        }
+
+        // Płaski obiekt od { w position; field(klucz, wartość) dla każdego pola. Zwraca pozycję za }.
+        template<typename Field>
+        auto readObject(std::size_t position, Field &&field) const -> std::size_t {
+            std::size_t cursor = index.next(position + 1);
+            while (at(cursor) != '}') {
+                if (at(cursor) != '"') {
+                    fail(cursor, "expected a key");
+                }
+                std::size_t keyEnd = index.next(cursor + 1);
+                std::string_view key = text.substr(cursor + 1, keyEnd - cursor - 1);
+                std::size_t colon = index.next(keyEnd + 1);
+                if (at(colon) != ':') {
+                    fail(colon, "expected ':'");
+                }
+                field(key, readValue(colon, cursor));
+                if (at(cursor) == ',') {
+                    cursor = index.next(cursor + 1);
+                } else if (at(cursor) != '}') {
+                    fail(cursor, "expected ',' or '}'");
+                }
+            }
+            return cursor + 1;
+        }
+
+        // Wartość dowolnego innego klucza (np. "ZONES") - zagnieżdżenie liczone po znakach strukturalnych.
+        auto skipValue(std::size_t colon) const -> std::size_t {
+            std::size_t start = index.next(colon + 1);
+            if (at(start) != '[' && at(start) != '{') {
+                std::size_t position = start;
+                readValue(colon, position);
+                return position;
+            }
+            std::size_t depth = 0;
+            for (std::size_t position = start; position < text.size(); position = index.next(position + 1)) {
+                char c = text[position];
+                if (c == '[' || c == '{') {
+                    ++depth;
+                } else if ((c == ']' || c == '}') && --depth == 0) {
+                    return index.next(position + 1);
+                }
+            }
+            fail(start, "unterminated value");
+        }
+
+        auto readColumns(std::size_t colon, PendingTable &pending) const -> std::size_t {
+            if (pending.rows > 0) {
+                fail(colon, "COLUMNS after ROWS in table " + pending.table.name);
+            }
+            std::size_t cursor = index.next(colon + 1);
+            if (at(cursor) != '[') {
+                fail(cursor, "expected '['");
+            }
+            pending.table.columns.clear();
+            for (cursor = index.next(cursor + 1); at(cursor) != ']'; cursor = index.next(cursor)) {
+                if (at(cursor) == ',') {
+                    ++cursor;
+                    continue;
+                }
+                if (at(cursor) != '{') {
+                    fail(cursor, "expected a column object");
+                }
+                std::size_t objectStart = cursor;
+                Column column;
+                std::string type;
+                cursor = readObject(cursor, [&](std::string_view key, std::string &&value) {
+                    if (key == "name") {
+                        column.name = std::move(value);
+                    } else if (key == "type") {
+                        type = std::move(value);
+                    }
+                });
+                if (column.name.empty() || type.empty()) {
+                    std::cerr << "Failed to parse column at byte " << objectStart << std::endl;
+                    continue;
+                }
+                column.type = parseColumnType(type);
+                pending.table.columns.push_back(std::move(column));
+            }
+            pending.table.assignOrdinals();
+            pending.values.assign(pending.table.columns.size(), {});
+            return index.next(cursor + 1);
+        }
+
+        auto readRows(std::size_t colon, PendingTable &pending) const -> std::size_t {
+            std::size_t start = index.next(colon + 1);
+            if (at(start) != '[') {
+                fail(start, "expected '['");
+            }
+            // Wiersze nie zawierają tablic, więc ROWS kończy pierwszy ] poza napisem.
+            std::size_t end = start + 1;
+            while (true) {
+                const void *found = std::memchr(text.data() + end, ']', text.size() - end);
+                if (found == nullptr) {
+                    fail(start, "unterminated ROWS");
+                }
+                end = static_cast<std::size_t>(static_cast<const char *>(found) - text.data());
+                if (index.isStructural(end)) {
+                    break;
+                }
+                ++end;
+            }
+
+            const std::vector<Column> &columns = pending.table.columns;
+            std::unordered_map<std::string_view, std::size_t> byName;
+            for (std::size_t c = 0; c < columns.size(); ++c) {
+                byName.emplace(columns[c].name, c);
+            }
+            std::size_t bytes = end - start - 1;
+            std::size_t chunks = std::clamp<std::size_t>(bytes / LEGACY_IMPORT_CHUNK, 1,
+                                                         ThreadPool::shared().size() * 4);
+            std::vector<RowBatch> batches(chunks);
+            StatementContext *statement = StatementContext::current();
+            ThreadPool::shared().parallelFor(chunks, [&](std::size_t k) {
+                TRACE_SPAN("LegacyImport::parse rows");
+                if (statement != nullptr) {
+                    statement->checkpoint();
+                }
+                std::size_t chunkBegin = start + 1 + bytes * k / chunks;
+                std::size_t chunkEnd = start + 1 + bytes * (k + 1) / chunks;
+                batches[k] = readRowChunk(columns, byName, chunkBegin, chunkEnd, statement);
+                if (statement != nullptr) {
+                    statement->addProgress(batches[k].rows, chunkEnd - chunkBegin);
+                }
+            });
+
+            ThreadPool::shared().parallelFor(columns.size(), [&](std::size_t c) {
+                std::vector<std::string> &target = pending.values[c];
+                std::size_t total = target.size();
+                for (const auto &batch: batches) {
+                    total += batch.values[c].size();
+                }
+                target.reserve(total);
+                for (auto &batch: batches) {
+                    std::ranges::move(batch.values[c], std::back_inserter(target));
+                    std::vector<std::string>().swap(batch.values[c]);
+                }
+            });
+            for (const auto &batch: batches) {
+                pending.rows += batch.rows;
+            }
+            return index.next(end + 1);
+        }
+
+        /*
+         * Wiersze, których { leży w [begin, end) - kawałek zaczynający się w środku wiersza zostawia go
+         * poprzedniemu, a ostatni wiersz może wyjść poza end. Brakujące klucze dostają wartość domyślną kolumny,
+         * klucze spoza schematu są pomijane; zwykle klucze idą w kolejności kolumn, więc mapa jest tylko zapasem.
+         */
+        auto readRowChunk(const std::vector<Column> &columns,
+                          const std::unordered_map<std::string_view, std::size_t> &byName,
+                          std::size_t begin, std::size_t end, StatementContext *statement) const -> RowBatch {
+            RowBatch batch;
+            batch.values.resize(columns.size());
+            std::vector<char> seen(columns.size());
+            std::size_t cursor = index.next(begin);
+            while (cursor < end && text[cursor] != '{') {
+                cursor = index.next(cursor + 1);
+            }
+            while (cursor < end) {
+                if (text[cursor] == ',') {
+                    cursor = index.next(cursor + 1);
+                    continue;
+                }
+                if (text[cursor] != '{') {
+                    fail(cursor, "expected a row object");
+                }
+                std::ranges::fill(seen, 0);
+                std::size_t field = 0;
+                cursor = readObject(cursor, [&](std::string_view key, std::string &&value) {
+                    std::size_t c = field < columns.size() && columns[field].name == key ? field : columns.size();
+                    ++field;
+                    if (c == columns.size()) {
+                        auto it = byName.find(key);
+                        if (it == byName.end()) {
+                            return;
+                        }
+                        c = it->second;
+                    }
+                    if (seen[c] != 0) {
+                        batch.values[c].back() = std::move(value);
+                        return;
+                    }
+                    seen[c] = 1;
+                    batch.values[c].push_back(std::move(value));
+                });
+                for (std::size_t c = 0; c < columns.size(); ++c) {
+                    if (seen[c] == 0) {
+                        batch.values[c].push_back(columns[c].defaultValue);
+                    }
+                }
+                if (++batch.rows % ZONE_BLOCK_ROWS == 0 && statement != nullptr) {
+                    statement->checkpoint();
+                }
+                cursor = index.next(cursor);
+            }
+            return batch;
+        }
+
+        // Kolumny kodowane są równolegle, a mapy stref powstają przy okazji z tych samych wartości.
+        static auto buildTable(PendingTable &pending) -> Table {
+            Table table = std::move(pending.table);
+            std::size_t rows = pending.rows;
+            if (rows == 0) {
+                return table;
+            }
+            table.encoded.resize(table.columns.size());
+            table.zones.resize((rows + ZONE_BLOCK_ROWS - 1) / ZONE_BLOCK_ROWS);
+            for (auto &zone: table.zones) {
+                zone.columns.resize(table.columns.size());
+            }
+            StatementContext *statement = StatementContext::current();
+            ThreadPool::shared().parallelFor(table.columns.size(), [&](std::size_t c) {
+                TRACE_SPAN("LegacyImport::encode column");
+                if (statement != nullptr) {
+                    statement->checkpoint();
+                }
+                const std::vector<std::string> &values = pending.values[c];
+                for (std::size_t i = 0; i < rows; ++i) {
+                    table.zones[i / ZONE_BLOCK_ROWS].columns[c].add(values[i]);
+                }
+                table.encoded[c] = encodeColumn(values, table.columns[c].type);
+                std::vector<std::string>().swap(pending.values[c]);
+            });
+            table.encodedRowCount = rows;
+            table.compressed = true;
+            return table;
+        }
+
+        std::string_view text;
+        const StructuralIndex &index;
+    };
+}
+
+auto importLegacyBackup(const std::string &filename) -> std::vector<Table> {
+    TRACE_SPAN("LegacyImport::import");
+    MappedFile file(filename);
+    reportPhase("import", 0);
+    StructuralIndex index(file.text());
+    return BackupParser(file.text(), index).parse();
+}
@@ -0,0 +1,32 @@
+#ifndef DATABASE2_LEGACYIMPORT_H
+#define DATABASE2_LEGACYIMPORT_H
+#pragma once
+#include "Prerequestion.h"
+#include "Table.h"
+
+// Znaki strukturalne szukane są po 16 bajtów naraz (SSE2); na innych procesorach bajt po bajcie.
+#if defined(__SSE2__) || defined(_M_X64)
+#define DATABASE_SIMD_STRUCTURAL 1
+#endif
+
+// Kopia jest mapowana do pamięci (mmap) zamiast czytana strumieniem.
+#if defined(__unix__) || defined(__APPLE__)
+#define DATABASE_MAPPED_IMPORT 1
+#endif
+
+// Zakres ROWS dzielony jest między wątki na kawałki co najmniej tej wielkości.
+constexpr std::size_t LEGACY_IMPORT_CHUNK = 1 << 20;
+
+/*
+ * Import kopii w starym formacie pseudo-json (Backup.txt): "TABLE", "COLUMNS" i "ROWS" kolejnych tabel
+ * w jednym obiekcie, tabele rozdzielone "},". Jak w simdjson najpierw jedno przejście wyznacza bitmapę
+ * znaków strukturalnych ({ } [ ] : , poza napisami i cudzysłowy), a parser skacze już tylko po jej bitach.
+ * Wiersze ROWS (płaskie obiekty, także z kluczami w innej kolejności lub bez części kluczy) parsowane są
+ * równolegle kawałkami pliku, a kolumny i mapy stref budowane równolegle po kolumnach - tabele wracają
+ * skompresowane jak po LOAD snapshotu. Stary zapis niczego nie escape'ował, więc napis kończy najbliższy
+ * cudzysłów, a \ jest zwykłym znakiem (także na końcu wartości - przykład w BackupBackslashes.txt); "ZONES"
+ * jest pomijane, bo strefy powstają od nowa z wczytanych wierszy.
+ */
+auto importLegacyBackup(const std::string &filename) -> std::vector<Table>;
+
+#endif //DATABASE2_LEGACYIMPORT_H
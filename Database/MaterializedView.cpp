@@ -0,0 +1,70 @@
+#include "MaterializedView.h"
+#include "Parser.h"
+#include "Predicate.h"
+
+auto parseViewWhere(const std::string &whereClause) -> std::shared_ptr<const Expression> {
+    if (whereClause.empty()) {
+        return nullptr;
+    }
+    Parser parser;
+    return parser.parseWhereClause(whereClause);
+}
+
+namespace {
+    auto expressionUsesColumn(const Expression *expression, const std::string &columnName) -> bool {
+        if (expression == nullptr) {
+            return false;
+        }
+        return expression->column == columnName || expressionUsesColumn(expression->left.get(), columnName) ||
+               expressionUsesColumn(expression->right.get(), columnName);
+    }
+}
+
+auto viewUsesColumn(const ViewDefinition &view, const std::string &columnName) -> bool {
+    return std::ranges::find(view.columns, columnName) != view.columns.end() ||
+           expressionUsesColumn(view.where.get(), columnName);
+}
+
+ViewProjection::ViewProjection(const ViewDefinition &view, const std::vector<Column> &baseColumns) : view(view) {
+    for (std::size_t i = 0; i < baseColumns.size(); ++i) {
+        positions[baseColumns[i].name] = i;
+    }
+    for (const auto &name: view.columns) {
+        auto it = positions.find(name);
+        if (it == positions.end()) {
+            throw std::runtime_error("Column of materialized view not found in " + view.base + ": " + name);
+        }
+        projected.push_back(it->second);
+    }
+}
+
+auto ViewProjection::matches(const RowImage &image) const -> bool {
+    return matches(view.where.get(), image);
+}
+
+auto ViewProjection::project(const RowImage &image) const -> std::vector<std::string> {
+    std::vector<std::string> values;
+    values.reserve(projected.size());
+    for (std::size_t position: projected) {
+        values.push_back(image[position]);
+    }
+    return values;
+}
+
+// Ta sama semantyka co evaluateExpression przy SELECT - widok musi zawierać dokładnie wynik zapytania.
+auto ViewProjection::matches(const Expression *expression, const RowImage &image) const -> bool {
+    if (expression == nullptr) {
+        return true;
+    }
+    if (expression->logicalOperator == "AND") {
+        return matches(expression->left.get(), image) && matches(expression->right.get(), image);
+    }
+    if (expression->logicalOperator == "OR") {
+        return matches(expression->left.get(), image) || matches(expression->right.get(), image);
+    }
+    auto it = positions.find(expression->column);
+    if (it == positions.end()) {
+        throw std::runtime_error("Error: Column name '" + expression->column + "' not found in Row::getValue");
+    }
+    return compareValues(image[it->second], expression->operators, expression->value);
+}
@@ -0,0 +1,46 @@
+#ifndef DATABASE2_MATERIALIZEDVIEW_H
+#define DATABASE2_MATERIALIZEDVIEW_H
+#pragma once
+#include "Prerequestion.h"
+#include "Column.h"
+#include "Expression.h"
+#include <map>
+
+// CREATE MATERIALIZED VIEW v AS SELECT a, b FROM t [WHERE ...]: wynik trzymany jest jako zwykła tabela v,
+// a każda zmiana wierszy t jest do niej dopisywana lub z niej wycofywana zamiast liczenia zapytania od nowa.
+struct ViewDefinition {
+    std::string base;
+    std::vector<std::string> columns;
+    std::string whereClause;
+    // Sparsowany whereClause (nullptr - bez WHERE); nie zmienia się, więc kopie tabeli mogą go dzielić.
+    std::shared_ptr<const Expression> where;
+};
+
+auto parseViewWhere(const std::string &whereClause) -> std::shared_ptr<const Expression>;
+// Czy kolumna tabeli bazowej jest w widoku albo w jego WHERE (takiej kolumny nie da się usunąć).
+auto viewUsesColumn(const ViewDefinition &view, const std::string &columnName) -> bool;
+
+// Obraz wiersza tabeli bazowej: wartości w kolejności jej kolumn (nie według Column::ordinal, które
+// materialize może przenumerować w trakcie zmiany).
+using RowImage = std::vector<std::string>;
+
+// Pozycje żywych wierszy widoku według ich wartości - wycofanie wiersza nie skanuje całego widoku.
+using ViewRowIndex = std::map<std::vector<std::string>, std::vector<std::size_t>>;
+
+// Widok przetłumaczony na pozycje kolumn tabeli bazowej - raz na zmianę, nie raz na wiersz.
+class ViewProjection {
+public:
+    ViewProjection(const ViewDefinition &view, const std::vector<Column> &baseColumns);
+
+    auto matches(const RowImage &image) const -> bool;
+    auto project(const RowImage &image) const -> std::vector<std::string>;
+
+private:
+    auto matches(const Expression *expression, const RowImage &image) const -> bool;
+
+    const ViewDefinition &view;
+    std::map<std::string, std::size_t> positions;
+    std::vector<std::size_t> projected;
+};
+
+#endif //DATABASE2_MATERIALIZEDVIEW_H
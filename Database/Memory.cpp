@@ -0,0 +1,158 @@
+#include "Memory.h"
+#include "Stats.h"
+#include "Table.h"
+#include "TableStatistics.h"
+#include <iomanip>
+
+namespace {
+    // Krótkie napisy mieszczą się w obiekcie std::string (SSO) i nie zajmują sterty.
+    auto stringHeapBytes(const std::string &value) -> std::size_t {
+        return value.size() > 15 ? value.capacity() : 0;
+    }
+
+    auto statisticsBytes(const TableStatistics &statistics) -> std::size_t {
+        std::size_t bytes = sizeof(TableStatistics) + statistics.columns.capacity() * sizeof(ColumnStatistics);
+        for (const auto &column: statistics.columns) {
+            bytes += stringHeapBytes(column.name) + column.bounds.capacity() * sizeof(std::string);
+            for (const auto &bound: column.bounds) {
+                bytes += stringHeapBytes(bound);
+            }
+        }
+        return bytes;
+    }
+}
+
+auto measureRow(const Row &row) -> std::size_t {
+    std::size_t bytes = sizeof(Row) + row.Data.capacity() * sizeof(std::string) + row.columnsSet.capacity() / 8;
+    for (const auto &value: row.Data) {
+        bytes += stringHeapBytes(value);
+    }
+    return bytes;
+}
+
+auto measureTable(const Table &table) -> TableMemory {
+    TableMemory memory;
+    memory.name = table.name;
+    memory.rows = table.liveRowCount();
+    memory.loaded = table.lazySource == nullptr;
+
+    memory.rowBytes = (table.rows.capacity() - table.rows.size()) * sizeof(Row) + table.deleted.capacity() / 8;
+    for (const auto &row: table.rows) {
+        memory.rowBytes += measureRow(row);
+    }
+    memory.zoneBytes = table.zones.capacity() * sizeof(ZoneMap);
+    for (const auto &zone: table.zones) {
+        memory.zoneBytes += zone.columns.capacity() * sizeof(ColumnZone);
+        for (const auto &column: zone.columns) {
+            memory.zoneBytes += stringHeapBytes(column.minValue) + stringHeapBytes(column.maxValue);
+        }
+    }
+    for (const auto &column: table.encoded) {
+        memory.encodedBytes += column.byteSize();
+    }
+    if (table.paged) {
+        memory.paged = true;
+        memory.encodedBytes += table.paged->directoryBytes();
+    }
+    if (table.statistics) {
+        memory.statisticsBytes = statisticsBytes(*table.statistics);
+    }
+    for (const auto &index: table.indexes) {
+        memory.indexBytes += index.byteSize();
+    }
+    return memory;
+}
+
+auto formatBytes(std::size_t bytes) -> std::string {
+    static const char *units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    auto value = static_cast<double>(bytes);
+    std::size_t unit = 0;
+    while (value >= 1024.0 && unit + 1 < std::size(units)) {
+        value /= 1024.0;
+        ++unit;
+    }
+    std::ostringstream out;
+    if (unit == 0) {
+        out << bytes << " B";
+    } else {
+        out << std::fixed << std::setprecision(1) << value << " " << units[unit];
+    }
+    return out.str();
+}
+
+auto parseByteSize(const std::string &number, const std::string &unit) -> std::size_t {
+    if (number.empty() || !std::ranges::all_of(number, ::isdigit)) {
+        throw std::runtime_error("Invalid memory size: " + number);
+    }
+    std::size_t multiplier = 1;
+    if (unit == "KB") {
+        multiplier = std::size_t(1) << 10;
+    } else if (unit == "MB") {
+        multiplier = std::size_t(1) << 20;
+    } else if (unit == "GB") {
+        multiplier = std::size_t(1) << 30;
+    } else if (!unit.empty() && unit != "B") {
+        throw std::runtime_error("Unknown memory unit: " + unit);
+    }
+    return static_cast<std::size_t>(std::stoull(number)) * multiplier;
+}
+
+
+auto MemoryBudget::instance() -> MemoryBudget & {
+    static MemoryBudget budget;
+    return budget;
+}
+
+auto MemoryBudget::setLimit(std::size_t bytes) -> void {
+    processLimit.store(bytes);
+}
+
+auto MemoryBudget::limit() const -> std::size_t {
+    return processLimit.load();
+}
+
+auto MemoryBudget::setQueryLimit(std::size_t bytes) -> void {
+    perQueryLimit.store(bytes);
+}
+
+auto MemoryBudget::queryLimit() const -> std::size_t {
+    return perQueryLimit.load();
+}
+
+auto MemoryBudget::heapBytes() const -> std::size_t {
+    std::int64_t bytes = Stats::heapBytesCounter().load(std::memory_order_relaxed);
+    return bytes > 0 ? static_cast<std::size_t>(bytes) : 0;
+}
+
+auto MemoryBudget::queryBytes() const -> std::size_t {
+    return inFlight.load();
+}
+
+auto MemoryBudget::overLimit() const -> bool {
+    std::size_t limitBytes = limit();
+    return limitBytes != 0 && heapBytes() > limitBytes;
+}
+
+auto MemoryBudget::check(const std::string &operation) const -> void {
+    if (overLimit()) {
+        throw std::runtime_error(operation + " refused: memory limit exceeded (heap " + formatBytes(heapBytes()) +
+                                 ", limit " + formatBytes(limit()) + ")");
+    }
+}
+
+
+QueryMemory::~QueryMemory() {
+    MemoryBudget::instance().inFlight.fetch_sub(charged);
+}
+
+auto QueryMemory::charge(std::size_t bytes) -> void {
+    MemoryBudget &budget = MemoryBudget::instance();
+    charged += bytes;
+    budget.inFlight.fetch_add(bytes);
+    std::size_t queryLimit = budget.queryLimit();
+    if (queryLimit != 0 && charged > queryLimit) {
+        throw std::runtime_error("Query aborted: result needs more than the query memory limit (" +
+                                 formatBytes(queryLimit) + ")");
+    }
+    budget.check("Query");
+}
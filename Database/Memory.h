@@ -0,0 +1,84 @@
+#ifndef DATABASE2_MEMORY_H
+#define DATABASE2_MEMORY_H
+#pragma once
+#include "Prerequestion.h"
+#include <atomic>
+#include <cstdint>
+
+struct Table;
+struct Row;
+
+// Szacunek pamięci jednej tabeli dla SHOW MEMORY (liczony przy każdym wywołaniu, nie w gorących ścieżkach).
+struct TableMemory {
+    std::string name;
+    std::size_t rows = 0;
+    std::size_t rowBytes = 0;
+    std::size_t zoneBytes = 0;
+    std::size_t encodedBytes = 0;
+    std::size_t statisticsBytes = 0;
+    std::size_t indexBytes = 0;
+    // Tabela z LOAD jeszcze niewczytana - jej dane są tylko na dysku.
+    bool loaded = true;
+    // Tabela po PAGE - w pamięci jest tylko katalog bloków (liczony w encodedBytes), dane są w BufferPool.
+    bool paged = false;
+
+    auto total() const -> std::size_t {
+        return rowBytes + zoneBytes + encodedBytes + statisticsBytes + indexBytes;
+    }
+};
+
+auto measureTable(const Table &table) -> TableMemory;
+auto measureRow(const Row &row) -> std::size_t;
+auto formatBytes(std::size_t bytes) -> std::string;
+// "512", "64 KB", "16 MB", "2 GB" -> bajty.
+auto parseByteSize(const std::string &number, const std::string &unit) -> std::size_t;
+
+/*
+ * Limity pamięci procesu i pojedynczego zapytania (0 = bez limitu), ustawiane przez SET [QUERY] MEMORY LIMIT.
+ * Zajętość sterty liczy zastępczy operator new z main.cpp (Stats::heapBytesCounter); program osadzający
+ * database_core bez niego ma zawsze 0 bajtów sterty, więc działa u niego tylko limit zapytania.
+ * Po przekroczeniu limitu zapytania i zapisy kończą się błędem - baza nie wyrzuca danych na dysk.
+ */
+class MemoryBudget {
+public:
+    static auto instance() -> MemoryBudget &;
+
+    auto setLimit(std::size_t bytes) -> void;
+    auto limit() const -> std::size_t;
+    auto setQueryLimit(std::size_t bytes) -> void;
+    auto queryLimit() const -> std::size_t;
+    auto heapBytes() const -> std::size_t;
+    // Suma bajtów naliczonych trwającym zapytaniom (QueryMemory).
+    auto queryBytes() const -> std::size_t;
+    auto overLimit() const -> bool;
+    // Rzuca std::runtime_error, gdy sterta przekroczyła limit procesu.
+    auto check(const std::string &operation) const -> void;
+
+private:
+    friend class QueryMemory;
+    MemoryBudget() = default;
+
+    std::atomic<std::size_t> processLimit{0};
+    std::atomic<std::size_t> perQueryLimit{0};
+    std::atomic<std::size_t> inFlight{0};
+};
+
+// Pamięć wyniku jednego zapytania; naliczone bajty są oddawane w destruktorze.
+class QueryMemory {
+public:
+    QueryMemory() = default;
+    ~QueryMemory();
+    QueryMemory(const QueryMemory &) = delete;
+    auto operator=(const QueryMemory &) -> QueryMemory & = delete;
+
+    // Dolicza bytes i przerywa zapytanie (std::runtime_error) po przekroczeniu limitu zapytania albo procesu.
+    auto charge(std::size_t bytes) -> void;
+    auto bytes() const -> std::size_t {
+        return charged;
+    }
+
+private:
+    std::size_t charged = 0;
+};
+
+#endif //DATABASE2_MEMORY_H
@@ -0,0 +1,151 @@
+#include "PageFile.h"
+#include "BufferPool.h"
+#include "Stats.h"
+#include <cstdio>
+#include <filesystem>
+#include <set>
+
+#ifdef DATABASE_POSITIONAL_IO
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    auto nextFileId() -> std::uint64_t {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // Ścieżki otwartych plików stron (znormalizowane). Plik żyje, dopóki trzyma go choć jedna kopia tabeli
+    // (np. zapamiętana przez transakcję), więc ta sama ścieżka nie może dostać drugiego PageFile.
+    struct OpenFiles {
+        std::mutex mutex;
+        std::set<std::string> paths;
+    };
+
+    auto openFiles() -> OpenFiles & {
+        static OpenFiles instance;
+        return instance;
+    }
+
+    auto registryKey(const std::string &path) -> std::string {
+        std::error_code ignored;
+        std::filesystem::path absolute = std::filesystem::absolute(path, ignored);
+        return (absolute.empty() ? std::filesystem::path(path) : absolute).lexically_normal().string();
+    }
+
+    auto claimPath(const std::string &path) -> void {
+        OpenFiles &files = openFiles();
+        std::lock_guard<std::mutex> lock(files.mutex);
+        if (!files.paths.insert(registryKey(path)).second) {
+            throw std::runtime_error("Page file " + path + " is already in use");
+        }
+    }
+
+    auto releasePath(const std::string &path) -> void {
+        OpenFiles &files = openFiles();
+        std::lock_guard<std::mutex> lock(files.mutex);
+        files.paths.erase(registryKey(path));
+    }
+}
+
+PageFile::PageFile(std::string path) : filePath(std::move(path)), fileId(nextFileId()) {
+    // Przed otwarciem - O_TRUNC na pliku innej tabeli zniszczyłby jej strony.
+    claimPath(filePath);
+#ifdef DATABASE_POSITIONAL_IO
+    descriptor = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        int error = errno;
+        releasePath(filePath);
+        throw std::runtime_error("Unable to open page file " + filePath + ": " + std::strerror(error));
+    }
+#else
+    stream.open(filePath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream.is_open()) {
+        releasePath(filePath);
+        throw std::runtime_error("Unable to open page file " + filePath);
+    }
+#endif
+}
+
+PageFile::~PageFile() {
+    BufferPool::instance().dropFile(fileId);
+#ifdef DATABASE_POSITIONAL_IO
+    ::close(descriptor);
+#else
+    stream.close();
+#endif
+    std::remove(filePath.c_str());
+    releasePath(filePath);
+}
+
+auto PageFile::append(const std::string &bytes) -> Extent {
+    Extent extent;
+    extent.firstPage = pages.load();
+    extent.pageCount = static_cast<std::uint32_t>(std::max<std::size_t>(1, (bytes.size() + PAGE_SIZE - 1) / PAGE_SIZE));
+    extent.byteLength = static_cast<std::uint32_t>(bytes.size());
+
+    // Ostatnia strona jest dopełniana zerami, żeby następny blok zaczynał się na granicy strony.
+    std::string padded = bytes;
+    padded.resize(extent.pageCount * PAGE_SIZE, '\0');
+    auto offset = static_cast<std::int64_t>(extent.firstPage * PAGE_SIZE);
+#ifdef DATABASE_POSITIONAL_IO
+    std::size_t written = 0;
+    while (written < padded.size()) {
+        ssize_t result = ::pwrite(descriptor, padded.data() + written, padded.size() - written,
+                                  static_cast<off_t>(offset + static_cast<std::int64_t>(written)));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            throw std::runtime_error("Unable to write page file " + filePath + ": " + std::strerror(errno));
+        }
+        written += static_cast<std::size_t>(result);
+    }
+#else
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stream.seekp(offset);
+        stream.write(padded.data(), static_cast<std::streamsize>(padded.size()));
+        if (!stream) {
+            throw std::runtime_error("Unable to write page file " + filePath);
+        }
+    }
+#endif
+    pages.store(extent.endPage());
+    Stats::instance().addBytesWritten(padded.size());
+    return extent;
+}
+
+auto PageFile::read(std::uint64_t firstPage, std::uint64_t pageCount) const -> std::string {
+    std::string bytes(pageCount * PAGE_SIZE, '\0');
+    auto offset = static_cast<std::int64_t>(firstPage * PAGE_SIZE);
+#ifdef DATABASE_POSITIONAL_IO
+    std::size_t done = 0;
+    while (done < bytes.size()) {
+        ssize_t result = ::pread(descriptor, bytes.data() + done, bytes.size() - done,
+                                 static_cast<off_t>(offset + static_cast<std::int64_t>(done)));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            throw std::runtime_error("Unable to read page file " + filePath);
+        }
+        done += static_cast<std::size_t>(result);
+    }
+#else
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stream.seekg(offset);
+        stream.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!stream) {
+            stream.clear();
+            throw std::runtime_error("Unable to read page file " + filePath);
+        }
+    }
+#endif
+    Stats::instance().addBytesRead(bytes.size());
+    return bytes;
+}
@@ -0,0 +1,75 @@
+#ifndef DATABASE2_PAGEFILE_H
+#define DATABASE2_PAGEFILE_H
+#pragma once
+#include "Prerequestion.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Na systemach POSIX odczyt i zapis idą przez pread/pwrite - bez wspólnej pozycji w pliku, którą dzieliłby
+// też proces potomny SAVE ASYNC.
+#if defined(__unix__) || defined(__APPLE__)
+#define DATABASE_POSITIONAL_IO 1
+#endif
+
+// Wielkość strony pliku danych tabel stronicowanych (PAGE).
+constexpr std::size_t PAGE_SIZE = 8192;
+
+// Ciągły zakres stron z jednym zakodowanym blokiem kolumny; pageCount == 0 oznacza blok niezapisany.
+struct Extent {
+    std::uint64_t firstPage = 0;
+    std::uint32_t pageCount = 0;
+    std::uint32_t byteLength = 0;
+
+    auto empty() const -> bool {
+        return pageCount == 0;
+    }
+
+    auto endPage() const -> std::uint64_t {
+        return firstPage + pageCount;
+    }
+};
+
+/*
+ * Plik danych podzielony na strony PAGE_SIZE. Zapis odbywa się wyłącznie na końcu pliku - zmieniony blok
+ * dostaje nowe strony, a stare zostają nietknięte, więc kopia katalogu bloków (SAVE ASYNC) nadal czyta
+ * spójne dane. Plik jest tylko przestrzenią roboczą i znika w destruktorze - trwałość zapewnia SAVE.
+ */
+class PageFile {
+public:
+    explicit PageFile(std::string path);
+    ~PageFile();
+
+    PageFile(const PageFile &) = delete;
+    auto operator=(const PageFile &) -> PageFile & = delete;
+
+    auto id() const -> std::uint64_t {
+        return fileId;
+    }
+
+    auto path() const -> const std::string & {
+        return filePath;
+    }
+
+    auto pageCount() const -> std::uint64_t {
+        return pages.load();
+    }
+
+    // Dopisuje bytes od nowej strony; wołane przez właściciela blokady bazy.
+    auto append(const std::string &bytes) -> Extent;
+    // Czyta pageCount stron od firstPage jednym odczytem (bezpieczne z wielu wątków).
+    auto read(std::uint64_t firstPage, std::uint64_t pageCount) const -> std::string;
+
+private:
+    std::string filePath;
+    std::uint64_t fileId;
+    std::atomic<std::uint64_t> pages{0};
+#ifdef DATABASE_POSITIONAL_IO
+    int descriptor = -1;
+#else
+    mutable std::mutex mutex;
+    mutable std::fstream stream;
+#endif
+};
+
+#endif //DATABASE2_PAGEFILE_H
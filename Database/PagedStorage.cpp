@@ -0,0 +1,82 @@
+#include "PagedStorage.h"
+#include "ZoneMap.h"
+
+auto PagedStorage::blockRows(std::size_t block) const -> std::size_t {
+    std::size_t begin = block * ZONE_BLOCK_ROWS;
+    return begin < rowCount ? std::min(ZONE_BLOCK_ROWS, rowCount - begin) : 0;
+}
+
+auto PagedStorage::pin(const Column &column, std::size_t block, bool sequential) const -> PinnedPage {
+    if (column.ordinal >= blocks.size() || block >= blocks[column.ordinal].size() ||
+        blocks[column.ordinal][block].empty()) {
+        return {};
+    }
+    const std::vector<Extent> &extents = blocks[column.ordinal];
+    std::span<const Extent> readAhead;
+    if (sequential) {
+        readAhead = std::span<const Extent>(extents).subspan(block + 1, std::min(PAGE_READ_AHEAD,
+                                                                                extents.size() - block - 1));
+    }
+    return BufferPool::instance().pin(*file, extents[block], readAhead);
+}
+
+auto PagedStorage::blockValues(const Column &column, std::size_t block) const -> std::vector<std::string> {
+    PinnedPage page = pin(column, block, true);
+    if (!page) {
+        return std::vector<std::string>(blockRows(block), column.defaultValue);
+    }
+    return page->decode();
+}
+
+// Pojedyncze komórki czytają zwykle skany wiersz po wierszu (ANALYZE, SAVE), więc też z wyprzedzeniem.
+auto PagedStorage::valueAt(std::size_t rowIndex, const Column &column) const -> std::string {
+    std::size_t block = rowIndex / ZONE_BLOCK_ROWS;
+    PinnedPage page = pin(column, block, true);
+    std::size_t offset = rowIndex - block * ZONE_BLOCK_ROWS;
+    if (!page || offset >= page->size) {
+        return column.defaultValue;
+    }
+    return page->valueAt(offset);
+}
+
+auto PagedStorage::writeBlock(const Column &column, std::size_t block, const std::vector<std::string> &values)
+-> void {
+    EncodedColumn encoded = encodeColumn(values, column.type);
+    std::ostringstream out;
+    writeEncodedColumn(out, encoded);
+    Extent extent = file->append(out.str());
+
+    if (column.ordinal >= blocks.size()) {
+        blocks.resize(column.ordinal + 1);
+    }
+    std::vector<Extent> &extents = blocks[column.ordinal];
+    if (block >= extents.size()) {
+        extents.resize(block + 1);
+    }
+    stalePages += extents[block].pageCount;
+    extents[block] = extent;
+    BufferPool::instance().install(*file, extent, std::move(encoded));
+}
+
+auto PagedStorage::dropColumn(std::size_t ordinal) -> void {
+    if (ordinal >= blocks.size()) {
+        return;
+    }
+    for (const Extent &extent: blocks[ordinal]) {
+        stalePages += extent.pageCount;
+    }
+    blocks[ordinal].clear();
+    blocks[ordinal].shrink_to_fit();
+}
+
+auto PagedStorage::livePages() const -> std::uint64_t {
+    return file->pageCount() - stalePages;
+}
+
+auto PagedStorage::directoryBytes() const -> std::size_t {
+    std::size_t bytes = blocks.capacity() * sizeof(std::vector<Extent>);
+    for (const auto &extents: blocks) {
+        bytes += extents.capacity() * sizeof(Extent);
+    }
+    return bytes;
+}
@@ -0,0 +1,38 @@
+#ifndef DATABASE2_PAGEDSTORAGE_H
+#define DATABASE2_PAGEDSTORAGE_H
+#pragma once
+#include "Prerequestion.h"
+#include "Column.h"
+#include "BufferPool.h"
+
+// Liczba kolejnych bloków kolumny wczytywanych z wyprzedzeniem przy skanie sekwencyjnym.
+constexpr std::size_t PAGE_READ_AHEAD = 8;
+
+/*
+ * Dane tabeli stronicowanej (PAGE). Każdy blok ZONE_BLOCK_ROWS wierszy każdej kolumny jest osobno zakodowany
+ * (encodeColumn) i zapisany w pliku stron; w pamięci zostaje tylko ten katalog, mapy stref i bitmapa
+ * usuniętych wierszy, a same bloki czyta BufferPool. Kopia tabeli kopiuje katalog i współdzieli plik.
+ */
+struct PagedStorage {
+    std::shared_ptr<PageFile> file;
+    // blocks[ordinal][block]; brak wpisu albo pusty Extent - cały blok ma wartość domyślną kolumny.
+    std::vector<std::vector<Extent>> blocks;
+    std::size_t rowCount = 0;
+    // Strony nieaktualnych wersji bloków - zapis zawsze trafia na koniec pliku.
+    std::uint64_t stalePages = 0;
+    // Ile razy tabela została przepisana do nowego pliku (kolejne pliki dostają ten numer w nazwie).
+    std::size_t generation = 0;
+
+    auto blockRows(std::size_t block) const -> std::size_t;
+    // Pusty PinnedPage, gdy blok kolumny nie był zapisany; sequential włącza czytanie z wyprzedzeniem.
+    auto pin(const Column &column, std::size_t block, bool sequential) const -> PinnedPage;
+    auto blockValues(const Column &column, std::size_t block) const -> std::vector<std::string>;
+    auto valueAt(std::size_t rowIndex, const Column &column) const -> std::string;
+    // Zapisuje nową wersję bloku kolumny (values.size() == blockRows(block) po zmianie rowCount).
+    auto writeBlock(const Column &column, std::size_t block, const std::vector<std::string> &values) -> void;
+    auto dropColumn(std::size_t ordinal) -> void;
+    auto livePages() const -> std::uint64_t;
+    auto directoryBytes() const -> std::size_t;
+};
+
+#endif //DATABASE2_PAGEDSTORAGE_H
@@ -1,4 +1,7 @@
 #include "Parser.h"
+#include "Trace.h"
+#include "Cancellation.h"
+#include <random>
 
 /*
 Tokenizacja danych, parsowanie po nich.
@@ -6,8 +9,10 @@ Tokenizacja danych, parsowanie po nich.
 
 */
 auto Parser::tokenize(const std::string &str, char delimiter) -> std::vector<std::string> {
+    TRACE_SPAN("Parser::tokenize");
     std::vector<std::string> tokens;
     std::string currentToken;
+    char previous = ' ';
 
     for (char ch: str) {
         if (std::isspace(ch)) {
@@ -22,10 +27,17 @@ auto Parser::tokenize(const std::string &str, char delimiter) -> std::vector<std
                 currentToken.clear();
             }
 
-            tokens.push_back(std::string(1, ch));
+            // ">=", "<=" i "!=" muszą zostać jednym tokenem, inaczej parser bierze "=" za wartość.
+            if (ch == '=' && (previous == '>' || previous == '<' || previous == '!') && !tokens.empty()
+                && tokens.back() == std::string(1, previous)) {
+                tokens.back() += ch;
+            } else {
+                tokens.push_back(std::string(1, ch));
+            }
         } else {
             currentToken += ch;
         }
+        previous = ch;
     }
 
     if (!currentToken.empty()) {
@@ -66,6 +78,10 @@ auto Parser::parseExpression(std::vector<std::string> &tokens, size_t &currentIn
             } else {
                 throw std::runtime_error("Expected value after operator");
             }
+        } else if (token == "LIKE") {
+            expr->operators = token;
+            ++currentIndex;
+            expr->value = parseLikePattern(tokens, currentIndex);
         } else if (isLogicalOperator(token)) {
             auto newExpr = std::make_unique<Expression>();
             newExpr->logicalOperator = token;
@@ -91,9 +107,49 @@ bool Parser::isLogicalOperator(const std::string &token) {
     return token == "AND" || token == "OR";
 }
 
+/*
+ * LIKE 'wzorzec' albo LIKE wzorzec (bez cudzysłowów do AND, OR lub nawiasu). Tokenizer rozcina napis na słowa
+ * i znaki, a INSERT skleja je pojedynczymi odstępami - wzorzec składany jest tak samo, tylko % i _ przylegają
+ * do sąsiednich tokenów, więc 'ab%' i 'a_c' znaczą to, co zwykle.
+ */
+auto Parser::parseLikePattern(const std::vector<std::string> &tokens, size_t &currentIndex) -> std::string {
+    bool quoted = currentIndex < tokens.size() && tokens[currentIndex] == "'";
+    if (quoted) {
+        ++currentIndex;
+    }
+    std::string pattern;
+    bool previousWildcard = true;
+    bool closed = false;
+    for (; currentIndex < tokens.size(); ++currentIndex) {
+        const auto &token = tokens[currentIndex];
+        if (quoted && token == "'") {
+            ++currentIndex;
+            closed = true;
+            break;
+        }
+        if (!quoted && (isLogicalOperator(token) || token == ")")) {
+            break;
+        }
+        bool wildcard = token == "%" || token == "_";
+        if (!previousWildcard && !wildcard) {
+            pattern += ' ';
+        }
+        pattern += token;
+        previousWildcard = wildcard;
+    }
+    if (quoted && !closed) {
+        throw std::runtime_error("Missing closing quote in LIKE pattern");
+    }
+    if (pattern.empty() && !quoted) {
+        throw std::runtime_error("Expected pattern after LIKE");
+    }
+    return pattern;
+}
+
 const std::vector<Column> Command::emptyColumns = {};
 
 auto Parser::parseSQLCommand(const std::string &commandStr) -> Command {
+    TRACE_SPAN("Parser::parseSQLCommand");
     std::vector<std::string> tokens = tokenize(commandStr, ' ');
     if (tokens.empty()) {
         throw std::runtime_error("Empty command string");
@@ -101,6 +157,7 @@ auto Parser::parseSQLCommand(const std::string &commandStr) -> Command {
 
     Command cmd;
 
+    cmd.text = commandStr;
     cmd.type = tokens[0];
     if (cmd.type == "CREATE") {
         parseCreateCommand(tokens, cmd);
@@ -122,6 +179,35 @@ auto Parser::parseSQLCommand(const std::string &commandStr) -> Command {
         parseSaveCommand(tokens, cmd);
     } else if (cmd.type == "LOAD") {
         parseLoadCommand(tokens, cmd);
+    } else if (cmd.type == "COMPRESS") {
+        parseCompressCommand(tokens, cmd);
+    } else if (cmd.type == "PAGE") {
+        parsePageCommand(tokens, cmd);
+    } else if (cmd.type == "BEGIN" || cmd.type == "COMMIT" || cmd.type == "ROLLBACK") {
+        parseTransactionCommand(tokens, cmd);
+    } else if (cmd.type == "REPLICATE") {
+        parseReplicateCommand(tokens, cmd);
+    } else if (cmd.type == "CAPTURE") {
+        parseCaptureCommand(tokens, cmd);
+    } else if (cmd.type == "REPLAY") {
+        parseReplayCommand(tokens, cmd);
+    } else if (cmd.type == "CANCEL") {
+        if (tokens.size() != 2 || !std::all_of(tokens[1].begin(), tokens[1].end(), ::isdigit)) {
+            throw std::runtime_error("Invalid syntax for CANCEL command, expected CANCEL statement_id");
+        }
+        cmd.value = tokens[1];
+    } else if (cmd.type == "TRACE") {
+        parseTraceCommand(tokens, cmd);
+    } else if (cmd.type == "STATS") {
+        parseStatsCommand(tokens, cmd);
+    } else if (cmd.type == "EXPLAIN") {
+        parseExplainCommand(tokens, cmd);
+    } else if (cmd.type == "ANALYZE") {
+        parseAnalyzeCommand(tokens, cmd);
+    } else if (cmd.type == "SHOW") {
+        parseShowCommand(tokens, cmd);
+    } else if (cmd.type == "SET") {
+        parseSetCommand(tokens, cmd);
     } else {
         throw std::runtime_error("Unknown command type: " + cmd.type);
     }
@@ -130,10 +216,31 @@ auto Parser::parseSQLCommand(const std::string &commandStr) -> Command {
 }
 
 
-auto Parser::parseCreateCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+auto Parser::parseCreateCommand(const std::vector<std::string> &allTokens, Command &cmd) -> void {
+    if (allTokens.size() > 1 && allTokens[1] == "MATERIALIZED") {
+        parseCreateViewCommand(allTokens, cmd);
+        return;
+    }
+    if (allTokens.size() > 1 && allTokens[1] == "INDEX") {
+        parseIndexCommand(allTokens, cmd);
+        return;
+    }
+    // CREATE ... PARTITION BY RANGE(kolumna) EVERY szerokość | HASH(kolumna) INTO liczba
+    auto partitionIt = std::ranges::find(allTokens, "PARTITION");
+    std::vector<std::string> tokens(allTokens.begin(), partitionIt);
     if (tokens.size() < 7 || tokens[2] != "WITH") {
         throw std::runtime_error("Invalid syntax for CREATE command");
     }
+    if (partitionIt != allTokens.end()) {
+        std::vector<std::string> clause(partitionIt, allTokens.end());
+        if (clause.size() != 8 || clause[1] != "BY" || (clause[2] != "RANGE" && clause[2] != "HASH") ||
+            clause[3] != "(" || clause[5] != ")" || clause[6] != (clause[2] == "RANGE" ? "EVERY" : "INTO") ||
+            !std::all_of(clause[7].begin(), clause[7].end(), ::isdigit)) {
+            throw std::runtime_error("Invalid syntax for PARTITION BY, expected RANGE(column) EVERY width "
+                                     "or HASH(column) INTO count");
+        }
+        cmd.additionalData = {clause[2], clause[4], clause[7]};
+    }
 
     cmd.type = "CREATE";
     cmd.tableName = tokens[1];
@@ -150,14 +257,73 @@ auto Parser::parseCreateCommand(const std::vector<std::string> &tokens, Command
 
         Column column;
         column.name = tokens[i + 1];
-        column.type = tokens[i + 3];
+        column.type = parseColumnType(tokens[i + 3]);
 
         cmd.columns.push_back(column);
         i += (i + 6 < tokens.size() && tokens[i + 6] == "{") ? 6 : 5;
     }
 }
 
+// CREATE MATERIALIZED VIEW v AS SELECT a, b FROM t [WHERE warunek]
+auto Parser::parseCreateViewCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() < 8 || tokens[2] != "VIEW" || tokens[4] != "AS" || tokens[5] != "SELECT") {
+        throw std::runtime_error("Invalid syntax for CREATE MATERIALIZED VIEW, expected "
+                                 "CREATE MATERIALIZED VIEW name AS SELECT columns FROM table [WHERE condition]");
+    }
+    cmd.type = "CREATE";
+    cmd.value = "VIEW";
+    cmd.tableName = tokens[3];
+
+    std::size_t i = 6;
+    for (; i < tokens.size() && tokens[i] != "FROM"; ++i) {
+        if (tokens[i] != ",") {
+            cmd.columns.push_back(Column{.name = tokens[i]});
+        }
+    }
+    if (cmd.columns.empty() || i + 1 >= tokens.size()) {
+        throw std::runtime_error("Invalid syntax for CREATE MATERIALIZED VIEW: expected columns FROM table");
+    }
+    cmd.additionalData = {tokens[i + 1]};
+
+    i += 2;
+    if (i < tokens.size()) {
+        if (tokens[i] != "WHERE" || i + 1 == tokens.size()) {
+            throw std::runtime_error("Invalid syntax for CREATE MATERIALIZED VIEW: expected WHERE condition");
+        }
+        std::string whereClause;
+        for (++i; i < tokens.size(); ++i) {
+            whereClause += (whereClause.empty() ? "" : " ") + tokens[i];
+        }
+        cmd.whereClause = whereClause;
+        cmd.whereExpression = parseWhereClause(whereClause);
+    }
+}
+
+// CREATE INDEX ON t (kolumna) | DROP INDEX ON t (kolumna)
+auto Parser::parseIndexCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() != 7 || tokens[2] != "ON" || tokens[4] != "(" || tokens[6] != ")") {
+        throw std::runtime_error("Invalid syntax for " + tokens[0] + " INDEX, expected " + tokens[0] +
+                                 " INDEX ON table (column)");
+    }
+    cmd.value = "INDEX";
+    cmd.tableName = tokens[3];
+    cmd.columnName = tokens[5];
+}
+
 auto Parser::parseDropCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    // DROP PARTITIONS FROM t BELOW granica
+    if (tokens.size() == 6 && tokens[1] == "PARTITIONS" && tokens[2] == "FROM" && tokens[4] == "BELOW") {
+        if (!std::all_of(tokens[5].begin(), tokens[5].end(), ::isdigit)) {
+            throw std::runtime_error("Invalid syntax for DROP PARTITIONS command: expected a numeric bound");
+        }
+        cmd.tableName = tokens[3];
+        cmd.additionalData = {tokens[1], tokens[5]};
+        return;
+    }
+    if (tokens.size() > 1 && tokens[1] == "INDEX") {
+        parseIndexCommand(tokens, cmd);
+        return;
+    }
     if (tokens.size() != 2) {
         throw std::runtime_error("Invalid syntax for DROP command");
     }
@@ -177,19 +343,31 @@ auto Parser::parseAddCommand(const std::vector<std::string> &tokens, Command &cm
         throw std::runtime_error("Invalid syntax for ADD command: 'INTO' not found or misplaced");
     }
 
-    std::string columnName = *(startBracketPos + 1);
-    std::string columnType = *(endBracketPos - 1);
-
-    if (*(startBracketPos + 2) != ",") {
+    // {nazwa, typ} albo {nazwa, typ, domyślna} - domyślna wartość wypełnia istniejące wiersze bez ich przepisywania.
+    auto definitionSize = std::distance(startBracketPos, endBracketPos) - 1;
+    if ((definitionSize != 3 && definitionSize != 5) || *(startBracketPos + 2) != "," ||
+        (definitionSize == 5 && *(startBracketPos + 4) != ",")) {
         throw std::runtime_error("Invalid syntax for ADD command: Missing comma in column definition");
     }
 
-    Column column = {columnName, columnType};
+    Column column{.name = *(startBracketPos + 1), .type = parseColumnType(*(startBracketPos + 3))};
+    if (definitionSize == 5) {
+        column.defaultValue = *(startBracketPos + 5);
+    }
     cmd.columns.push_back(column);
     cmd.tableName = *(endBracketPos + 2);
 }
 
 auto Parser::parseSelectCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() > 1 && tokens[1] == "APPROX") {
+        size_t i = 1;
+        cmd.aggregate = parseApproxAggregate(tokens, i);
+        // Dalej jak zwykły SELECT jednej kolumny: FROM t [TABLESAMPLE ...] [WHERE ...].
+        std::vector<std::string> rest = {tokens[0], cmd.aggregate->column};
+        rest.insert(rest.end(), tokens.begin() + static_cast<std::ptrdiff_t>(i), tokens.end());
+        parseSelectCommand(rest, cmd);
+        return;
+    }
     if (tokens.size() < 4 || tokens[2] != "FROM") {
         throw std::runtime_error("Invalid syntax for SELECT command");
     }
@@ -199,7 +377,7 @@ auto Parser::parseSelectCommand(const std::vector<std::string> &tokens, Command
 
 
     while (tokens[i] != "FROM") {
-        cmd.columns.push_back({tokens[i], ""});
+        cmd.columns.push_back(Column{.name = tokens[i]});
         i++;
         if (i >= tokens.size()) {
             throw std::runtime_error("Missing 'FROM' keyword in SELECT command");
@@ -209,6 +387,13 @@ auto Parser::parseSelectCommand(const std::vector<std::string> &tokens, Command
 
     cmd.tableName = tokens[++i];
 
+    if (i + 1 < tokens.size() && tokens[i + 1] == "TABLESAMPLE") {
+        i += 2;
+        cmd.sample = parseTableSample(tokens, i);
+        // i wskazuje ostatni token próby, tak jak wcześniej nazwę tabeli.
+        --i;
+    }
+
     if (i + 1 < tokens.size() && tokens[i + 1] == "WHERE") {
         std::string whereClause;
         for (i += 2; i < tokens.size(); ++i) {
@@ -218,10 +403,111 @@ auto Parser::parseSelectCommand(const std::vector<std::string> &tokens, Command
             whereClause += tokens[i];
         }
 
+        cmd.whereClause = whereClause;
         cmd.whereExpression = parseWhereClause(whereClause);
     }
 }
 
+namespace {
+    // Tokeny aż do stop sklejone bez odstępów ("0", ".", "5" -> "0.5"); currentIndex zatrzymuje się na stop.
+    auto joinUntil(const std::vector<std::string> &tokens, size_t &currentIndex, const std::string &stop)
+    -> std::string {
+        std::string joined;
+        for (; currentIndex < tokens.size() && tokens[currentIndex] != stop; ++currentIndex) {
+            joined += tokens[currentIndex];
+        }
+        if (currentIndex == tokens.size()) {
+            throw std::runtime_error("Expected '" + stop + "'");
+        }
+        return joined;
+    }
+
+    auto parseFraction(const std::string &text, const std::string &what) -> double {
+        std::size_t parsed = 0;
+        double value = 0.0;
+        try {
+            value = std::stod(text, &parsed);
+        } catch (const std::exception &) {
+            parsed = 0;
+        }
+        if (text.empty() || parsed != text.size()) {
+            throw std::runtime_error("Invalid " + what + ": " + text);
+        }
+        return value;
+    }
+}
+
+// APPROX_COUNT_DISTINCT(kolumna) | APPROX_QUANTILE(kolumna, q). Tokenizer rozcina nazwę na '_',
+// więc sklejamy ją z powrotem (zapis ze spacjami, APPROX COUNT DISTINCT, też działa).
+auto Parser::parseApproxAggregate(const std::vector<std::string> &tokens, size_t &currentIndex) -> ApproxAggregate {
+    std::string name;
+    for (; currentIndex < tokens.size() && tokens[currentIndex] != "("; ++currentIndex) {
+        if (tokens[currentIndex] != "_") {
+            name += (name.empty() ? "" : "_") + tokens[currentIndex];
+        }
+    }
+    ApproxAggregate aggregate;
+    if (name == "APPROX_COUNT_DISTINCT") {
+        aggregate.function = ApproxFunction::CountDistinct;
+    } else if (name == "APPROX_QUANTILE") {
+        aggregate.function = ApproxFunction::Quantile;
+    } else {
+        throw std::runtime_error("Unknown approximate aggregate: " + name +
+                                 ", expected APPROX_COUNT_DISTINCT(column) or APPROX_QUANTILE(column, q)");
+    }
+    if (currentIndex + 2 >= tokens.size()) {
+        throw std::runtime_error("Expected column in " + name);
+    }
+    aggregate.column = tokens[currentIndex + 1];
+    currentIndex += 2;
+    if (aggregate.function == ApproxFunction::Quantile) {
+        if (tokens[currentIndex] != ",") {
+            throw std::runtime_error("Expected ', q' in APPROX_QUANTILE(column, q)");
+        }
+        ++currentIndex;
+        aggregate.quantile = parseFraction(joinUntil(tokens, currentIndex, ")"), "quantile");
+        if (aggregate.quantile < 0.0 || aggregate.quantile > 1.0) {
+            throw std::runtime_error("Quantile must be between 0 and 1");
+        }
+    } else if (tokens[currentIndex] != ")") {
+        throw std::runtime_error("Expected ')' after column in " + name);
+    }
+    ++currentIndex;
+    if (currentIndex >= tokens.size() || tokens[currentIndex] != "FROM") {
+        throw std::runtime_error("Missing 'FROM' keyword in SELECT command");
+    }
+    return aggregate;
+}
+
+// TABLESAMPLE (p PERCENT) [REPEATABLE (ziarno)]; currentIndex wskazuje token za "TABLESAMPLE", a po powrocie
+// token za całą klauzulą.
+auto Parser::parseTableSample(const std::vector<std::string> &tokens, size_t &currentIndex) -> TableSample {
+    if (currentIndex >= tokens.size() || tokens[currentIndex] != "(") {
+        throw std::runtime_error("Invalid syntax for TABLESAMPLE, expected TABLESAMPLE (p PERCENT)");
+    }
+    ++currentIndex;
+    TableSample sample;
+    sample.percent = parseFraction(joinUntil(tokens, currentIndex, "PERCENT"), "TABLESAMPLE percent");
+    if (sample.percent <= 0.0 || sample.percent > 100.0) {
+        throw std::runtime_error("TABLESAMPLE percent must be greater than 0 and at most 100");
+    }
+    if (++currentIndex >= tokens.size() || tokens[currentIndex] != ")") {
+        throw std::runtime_error("Invalid syntax for TABLESAMPLE, expected TABLESAMPLE (p PERCENT)");
+    }
+    ++currentIndex;
+    if (currentIndex < tokens.size() && tokens[currentIndex] == "REPEATABLE") {
+        if (currentIndex + 3 >= tokens.size() || tokens[currentIndex + 1] != "(" || tokens[currentIndex + 3] != ")" ||
+            !std::all_of(tokens[currentIndex + 2].begin(), tokens[currentIndex + 2].end(), ::isdigit)) {
+            throw std::runtime_error("Invalid syntax for REPEATABLE, expected REPEATABLE (number)");
+        }
+        sample.seed = std::stoull(tokens[currentIndex + 2]);
+        currentIndex += 4;
+    } else {
+        sample.seed = std::random_device()();
+    }
+    return sample;
+}
+
 auto Parser::parseUpdateCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
     if (tokens.size() < 6 || tokens[2] != "FROM" || tokens[4] != "WITH") {
         throw std::runtime_error("Invalid syntax for UPDATE command");
@@ -232,22 +518,58 @@ auto Parser::parseUpdateCommand(const std::vector<std::string> &tokens, Command
     cmd.tableName = tokens[3];
 
 
-    size_t valueStartIndex = 5;
-    if (tokens[valueStartIndex] != "[") {
+    if (tokens[5] != "[") {
         throw std::runtime_error("Expected '[' in UPDATE command");
     }
+    auto closing = std::ranges::find(tokens.begin() + 6, tokens.end(), "]");
+    if (closing == tokens.end() || closing == tokens.begin() + 6) {
+        throw std::runtime_error("Expected new value in UPDATE command");
+    }
 
-
-    if (valueStartIndex + 1 < tokens.size() && tokens[valueStartIndex + 1] != "]") {
-        std::string updatedValue = tokens[valueStartIndex + 1];
-
-
-        cmd.updatedData = Row(std::vector<Column>());
-        cmd.updatedData.Data.push_back(updatedValue);
+    // [kolumna op liczba] - arytmetyka liczona przez Database::update na liczbach, nie na napisach.
+    std::vector<std::string> valueTokens(tokens.begin() + 6, closing);
+    if (valueTokens.size() >= 3 && isArithmeticOperator(valueTokens[1]) && std::isalpha(valueTokens[0].front())) {
+        std::string operand;
+        for (auto it = valueTokens.begin() + 2; it != valueTokens.end(); ++it) {
+            operand += *it;
+        }
+        try {
+            std::size_t parsed = 0;
+            cmd.assignment.operand = std::stoll(operand, &parsed);
+            if (parsed != operand.size()) {
+                throw std::invalid_argument(operand);
+            }
+        } catch (const std::exception &) {
+            throw std::runtime_error("Expected integer operand in UPDATE command: " + operand);
+        }
+        cmd.assignment.sourceColumn = valueTokens[0];
+        cmd.assignment.arithmeticOperator = valueTokens[1];
     } else {
-        throw std::runtime_error("Expected new value in UPDATE command");
+        // Pojedynczy token (liczba, true/false) przechodzi bez zmian, jak dotychczas.
+        std::string data;
+        for (const auto &token: valueTokens) {
+            data += (data.empty() ? "" : " ") + token;
+        }
+        cmd.assignment.value = valueTokens.size() == 1 ? data : parseLiteral(data);
+        cmd.updatedData = Row(std::vector<Column>());
+        cmd.updatedData.Data.push_back(cmd.assignment.value);
+    }
+
+    if (closing + 1 != tokens.end()) {
+        if (*(closing + 1) != "WHERE" || closing + 2 == tokens.end()) {
+            throw std::runtime_error("Invalid syntax for UPDATE command: expected WHERE condition");
+        }
+        std::string whereClause;
+        for (auto it = closing + 2; it != tokens.end(); ++it) {
+            whereClause += (whereClause.empty() ? "" : " ") + *it;
+        }
+        cmd.whereClause = whereClause;
+        cmd.whereExpression = parseWhereClause(whereClause);
     }
+}
 
+auto Parser::isArithmeticOperator(const std::string &token) -> bool {
+    return token == "+" || token == "-" || token == "*" || token == "/";
 }
 
 
@@ -285,21 +607,28 @@ auto Parser::parseInsertCommand(const std::vector<std::string> &tokens, Command
     } else {
         throw std::runtime_error("Invalid data format: " + data);
     }
+    data = parseLiteral(data);
 
-    \
+    cmd.data = Row(std::vector<Column>());
+    cmd.data.Data.push_back(data);
+}
+
+// Wartość z nawiasów [...]: 'napis', (bool) albo liczba całkowita.
+auto Parser::parseLiteral(std::string data) -> std::string {
+    if (data.empty()) {
+        throw std::runtime_error("Unrecognized data format: " + data);
+    }
     if (data.front() == '\'' && data.back() == '\'') {
         data = data.substr(1, data.length() - 2);
     } else if (data.front() == '(' && data.back() == ')') {
-        data = data.substr(1, data.length() - 2);
+        data = trim(data.substr(1, data.length() - 2));
     } else if (std::all_of(data.begin(), data.end(), ::isdigit) ||
                (data.front() == '-' && std::all_of(data.begin() + 1, data.end(), ::isdigit))) {
 
     } else {
         throw std::runtime_error("Unrecognized data format: " + data);
     }
-
-    cmd.data = Row(std::vector<Column>());
-    cmd.data.Data.push_back(data);
+    return data;
 }
 
 std::string Parser::trim(const std::string &str) {
@@ -311,6 +640,24 @@ std::string Parser::trim(const std::string &str) {
 }
 
 auto Parser::parseDeleteDataCommand(std::vector<std::string> &tokens, Command &cmd) -> void {
+    // DELETE FROM table_name [WHERE condition] - usuwanie całych wierszy.
+    if (tokens.size() >= 3 && tokens[1] == "FROM") {
+        cmd.type = "DELETE";
+        cmd.tableName = tokens[2];
+        if (tokens.size() > 3) {
+            if (tokens[3] != "WHERE" || tokens.size() == 4) {
+                throw std::runtime_error("Invalid syntax for DELETE command: expected WHERE condition");
+            }
+            std::string whereClause;
+            for (auto it = tokens.begin() + 4; it != tokens.end(); ++it) {
+                whereClause += (whereClause.empty() ? "" : " ") + *it;
+            }
+            cmd.whereClause = whereClause;
+            cmd.whereExpression = parseWhereClause(whereClause);
+        }
+        return;
+    }
+
     auto fromPos = std::find(tokens.begin(), tokens.end(), "FROM");
     auto inPos = std::find(tokens.begin(), tokens.end(), "IN");
 
@@ -332,11 +679,14 @@ auto Parser::parseDeleteDataCommand(std::vector<std::string> &tokens, Command &c
     }
 
     cmd.columnName = *(fromPos + 1);
-    cmd.whereClause = data;
+    // Ta sama postać wartości co w INSERT, żeby usuwana wartość zgadzała się z zapisaną.
+    data = trim(data);
+    cmd.dataToDelete = !data.empty() && (data.front() == '\'' || data.front() == '(') ? parseLiteral(data) : data;
 }
 
 
 auto Parser::parseWhereClause(const std::string &whereClause) -> std::unique_ptr<Expression> {
+    TRACE_SPAN("Parser::parseWhereClause");
     if (whereClause.empty()) {
         return nullptr;
     }
@@ -353,7 +703,28 @@ auto Parser::parseSaveCommand(const std::vector<std::string> &tokens, Command &c
     }
 
     cmd.type = "SAVE";
-    std::vector<std::string> filePathTokens(tokens.begin() + 1, tokens.end());
+    // SAVE ASYNC path, SAVE STATUS, SAVE EVERY seconds path (SAVE EVERY 0 wyłącza zrzuty okresowe).
+    std::size_t pathStart = 1;
+    if (tokens[1] == "ASYNC" && tokens.size() > 2) {
+        cmd.additionalData.push_back(tokens[1]);
+        pathStart = 2;
+    } else if (tokens[1] == "STATUS" && tokens.size() == 2) {
+        cmd.additionalData.push_back(tokens[1]);
+        return;
+    } else if (tokens[1] == "EVERY" && tokens.size() > 2) {
+        if (!std::all_of(tokens[2].begin(), tokens[2].end(), ::isdigit)) {
+            throw std::runtime_error("Invalid syntax for SAVE EVERY command: expected number of seconds");
+        }
+        cmd.additionalData = {tokens[1], tokens[2]};
+        pathStart = 3;
+        if (tokens.size() == 3) {
+            if (tokens[2].find_first_not_of('0') != std::string::npos) {
+                throw std::runtime_error("Invalid syntax for SAVE EVERY command: missing file path");
+            }
+            return;
+        }
+    }
+    std::vector<std::string> filePathTokens(tokens.begin() + static_cast<std::ptrdiff_t>(pathStart), tokens.end());
     cmd.value = joinFilePath(filePathTokens);
 }
 
@@ -367,6 +738,226 @@ auto Parser::parseLoadCommand(const std::vector<std::string> &tokens, Command &c
     cmd.value = filePath;
 }
 
+auto Parser::parseCompressCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() != 2) {
+        throw std::runtime_error("Invalid syntax for COMPRESS command");
+    }
+
+    cmd.type = "COMPRESS";
+    cmd.tableName = tokens[1];
+}
+
+// PAGE table_name [INTO path]
+auto Parser::parsePageCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() < 2 || (tokens.size() > 2 && (tokens[2] != "INTO" || tokens.size() == 3))) {
+        throw std::runtime_error("Invalid syntax for PAGE command, expected PAGE table_name [INTO path]");
+    }
+
+    cmd.type = "PAGE";
+    cmd.tableName = tokens[1];
+    if (tokens.size() > 3) {
+        cmd.value = joinFilePath(std::vector<std::string>(tokens.begin() + 3, tokens.end()));
+    }
+}
+
+auto Parser::parseTransactionCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() != 1) {
+        throw std::runtime_error("Invalid syntax for " + tokens[0] + " command");
+    }
+
+    cmd.type = tokens[0];
+}
+
+auto Parser::parseReplicateCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    // REPLICATE SERVE path, REPLICATE FROM path, REPLICATE STATUS, REPLICATE STOP.
+    bool withPath = tokens.size() > 2 && (tokens[1] == "SERVE" || tokens[1] == "FROM");
+    bool withoutPath = tokens.size() == 2 && (tokens[1] == "STATUS" || tokens[1] == "STOP");
+    if (!withPath && !withoutPath) {
+        throw std::runtime_error("Invalid syntax for REPLICATE command");
+    }
+
+    cmd.type = "REPLICATE";
+    cmd.additionalData.push_back(tokens[1]);
+    if (withPath) {
+        cmd.value = joinFilePath(std::vector<std::string>(tokens.begin() + 2, tokens.end()));
+    }
+}
+
+auto Parser::parseCaptureCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    // CAPTURE START path, CAPTURE STOP, CAPTURE STATUS.
+    bool withPath = tokens.size() > 2 && tokens[1] == "START";
+    bool withoutPath = tokens.size() == 2 && (tokens[1] == "STOP" || tokens[1] == "STATUS");
+    if (!withPath && !withoutPath) {
+        throw std::runtime_error("Invalid syntax for CAPTURE command");
+    }
+
+    cmd.type = "CAPTURE";
+    cmd.additionalData.push_back(tokens[1]);
+    if (withPath) {
+        cmd.value = joinFilePath(std::vector<std::string>(tokens.begin() + 2, tokens.end()));
+    }
+}
+
+auto Parser::parseReplayCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    // REPLAY COMPARE report WITH report
+    // REPLAY path [, path ...] [SPEED factor | SPEED MAX] [THREADS n] [INTO report]
+    cmd.type = "REPLAY";
+    if (tokens.size() > 1 && tokens[1] == "COMPARE") {
+        auto with = std::ranges::find(tokens, "WITH");
+        if (with == tokens.begin() + 2 || with == tokens.end() || with + 1 == tokens.end()) {
+            throw std::runtime_error("Invalid syntax for REPLAY COMPARE, expected REPLAY COMPARE report WITH report");
+        }
+        cmd.additionalData = {"COMPARE", joinFilePath(std::vector<std::string>(tokens.begin() + 2, with)),
+                              joinFilePath(std::vector<std::string>(with + 1, tokens.end()))};
+        return;
+    }
+
+    auto isOption = [](const std::string &token) {
+        return token == "SPEED" || token == "THREADS" || token == "INTO";
+    };
+    size_t currentIndex = 1;
+    std::vector<std::string> paths;
+    std::vector<std::string> pathTokens;
+    for (; currentIndex < tokens.size() && !isOption(tokens[currentIndex]); ++currentIndex) {
+        if (tokens[currentIndex] == ",") {
+            paths.push_back(joinFilePath(pathTokens));
+            pathTokens.clear();
+        } else {
+            pathTokens.push_back(tokens[currentIndex]);
+        }
+    }
+    paths.push_back(joinFilePath(pathTokens));
+    if (std::ranges::any_of(paths, [](const std::string &path) { return path.empty(); })) {
+        throw std::runtime_error("Invalid syntax for REPLAY command: missing capture file path");
+    }
+
+    std::string speed = "1";
+    std::string threads = "1";
+    std::string report;
+    while (currentIndex < tokens.size()) {
+        const std::string &option = tokens[currentIndex++];
+        std::vector<std::string> argument;
+        for (; currentIndex < tokens.size() && !isOption(tokens[currentIndex]); ++currentIndex) {
+            argument.push_back(tokens[currentIndex]);
+        }
+        std::string joined = joinFilePath(argument);
+        if (joined.empty()) {
+            throw std::runtime_error("Invalid syntax for REPLAY command: " + option + " needs a value");
+        }
+        if (option == "SPEED") {
+            if (joined != "MAX" && parseFraction(joined, "REPLAY speed") <= 0.0) {
+                throw std::runtime_error("REPLAY speed must be greater than 0 (or MAX)");
+            }
+            speed = joined;
+        } else if (option == "THREADS") {
+            if (!std::all_of(joined.begin(), joined.end(), ::isdigit) || std::stoull(joined) == 0) {
+                throw std::runtime_error("REPLAY THREADS expects a positive number");
+            }
+            threads = joined;
+        } else {
+            report = joined;
+        }
+    }
+    cmd.additionalData = {"RUN", speed, threads, report};
+    cmd.additionalData.insert(cmd.additionalData.end(), paths.begin(), paths.end());
+}
+
+auto Parser::parseTraceCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    // TRACE START, TRACE STOP, TRACE STATUS, TRACE DUMP path.
+    bool withPath = tokens.size() > 2 && tokens[1] == "DUMP";
+    bool withoutPath = tokens.size() == 2 && (tokens[1] == "START" || tokens[1] == "STOP" || tokens[1] == "STATUS");
+    if (!withPath && !withoutPath) {
+        throw std::runtime_error("Invalid syntax for TRACE command");
+    }
+
+    cmd.type = "TRACE";
+    cmd.additionalData.push_back(tokens[1]);
+    if (withPath) {
+        cmd.value = joinFilePath(std::vector<std::string>(tokens.begin() + 2, tokens.end()));
+    }
+}
+
+auto Parser::parseStatsCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() > 2 || (tokens.size() == 2 && tokens[1] != "JSON" && tokens[1] != "RESET")) {
+        throw std::runtime_error("Invalid syntax for STATS command");
+    }
+
+    cmd.type = "STATS";
+    cmd.value = tokens.size() == 2 ? tokens[1] : "";
+}
+
+auto Parser::parseExplainCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() < 3 || tokens[1] != "ANALYZE") {
+        throw std::runtime_error("Invalid syntax for EXPLAIN command, expected EXPLAIN ANALYZE <statement>");
+    }
+
+    cmd.type = "EXPLAIN";
+    for (auto it = tokens.begin() + 2; it != tokens.end(); ++it) {
+        cmd.value += (it != tokens.begin() + 2 ? " " : "") + *it;
+    }
+}
+
+auto Parser::parseAnalyzeCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() > 2) {
+        throw std::runtime_error("Invalid syntax for ANALYZE command");
+    }
+
+    cmd.type = "ANALYZE";
+    cmd.tableName = tokens.size() == 2 ? tokens[1] : "";
+}
+
+auto Parser::parseShowCommand(const std::vector<std::string> &tokens, Command &cmd) -> void {
+    if (tokens.size() == 3 && tokens[1] == "PARTITIONS") {
+        cmd.type = "SHOW";
+        cmd.value = tokens[1];
+        cmd.tableName = tokens[2];
+        return;
+    }
+    if (tokens.size() != 2 || (tokens[1] != "MEMORY" && tokens[1] != "STATEMENTS")) {
+        throw std::runtime_error("Invalid syntax for SHOW command, expected SHOW MEMORY, SHOW STATEMENTS "
+                                 "or SHOW PARTITIONS table");
+    }
+
+    cmd.type = "SHOW";
+    cmd.value = tokens[1];
+}
+
+// SET MEMORY LIMIT n [KB|MB|GB] albo SET QUERY MEMORY LIMIT n [KB|MB|GB]; 0 wyłącza limit.
+// SET BUFFER POOL n [KB|MB|GB] - pojemność puli bloków tabel stronicowanych.
+auto Parser::parseSetCommand(const std::vector<std::string> &allTokens, Command &cmd) -> void {
+    // Tokenizer rozcina '_', więc SET STATEMENT_TIMEOUT to to samo co SET STATEMENT TIMEOUT.
+    std::vector<std::string> tokens;
+    std::ranges::copy_if(allTokens, std::back_inserter(tokens), [](const std::string &token) { return token != "_"; });
+    if (tokens.size() > 2 && tokens[1] == "STATEMENT" && tokens[2] == "TIMEOUT") {
+        if (tokens.size() < 4 || tokens.size() > 5) {
+            throw std::runtime_error("Invalid syntax for SET command, expected SET STATEMENT TIMEOUT n [MS | S | MIN]");
+        }
+        cmd.type = "SET";
+        cmd.value = "STATEMENT TIMEOUT";
+        auto timeout = parseDuration(tokens[3], tokens.size() == 5 ? tokens[4] : "");
+        cmd.additionalData.push_back(std::to_string(timeout.count()));
+        return;
+    }
+    if (tokens.size() > 2 && tokens[1] == "BUFFER" && tokens[2] == "POOL") {
+        if (tokens.size() < 4 || tokens.size() > 5) {
+            throw std::runtime_error("Invalid syntax for SET command, expected SET BUFFER POOL size");
+        }
+        cmd.type = "SET";
+        cmd.value = "BUFFER POOL";
+        cmd.additionalData.push_back(std::to_string(parseByteSize(tokens[3], tokens.size() == 5 ? tokens[4] : "")));
+        return;
+    }
+    std::size_t i = tokens.size() > 1 && tokens[1] == "QUERY" ? 2 : 1;
+    if (tokens.size() < i + 3 || tokens.size() > i + 4 || tokens[i] != "MEMORY" || tokens[i + 1] != "LIMIT") {
+        throw std::runtime_error("Invalid syntax for SET command, expected SET [QUERY] MEMORY LIMIT size");
+    }
+
+    cmd.type = "SET";
+    cmd.value = i == 2 ? "QUERY MEMORY LIMIT" : "MEMORY LIMIT";
+    std::size_t bytes = parseByteSize(tokens[i + 2], tokens.size() == i + 4 ? tokens[i + 3] : "");
+    cmd.additionalData.push_back(std::to_string(bytes));
+}
+
 auto Parser::joinFilePath(const std::vector<std::string> &pathTokens) -> std::string {
     std::string filePath;
     for (const auto &token: pathTokens) {
@@ -5,6 +5,8 @@
 #include "Database.h"
 #include "Row.h"
 #include "Column.h"
+#include "Approximate.h"
+#include <optional>
 
 
 struct Command {
@@ -22,6 +24,12 @@ struct Command {
 
     std::unique_ptr<Expression> whereExpression;
     std::string dataToDelete;
+    Assignment assignment;
+    // Tekst polecenia - tak trafia do rekordów zmian replikacji.
+    std::string text;
+    // SELECT ... TABLESAMPLE oraz SELECT APPROX_COUNT_DISTINCT(...) / APPROX_QUANTILE(...).
+    std::optional<TableSample> sample;
+    std::optional<ApproxAggregate> aggregate;
 };
 class Database;
 class Parser {
@@ -39,6 +47,8 @@ public:
 private:
 
     auto parseCreateCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseCreateViewCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseIndexCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
     auto parseDropCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
     auto parseAddCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
     auto parseSelectCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
@@ -49,8 +59,25 @@ private:
     auto parseSaveCommand(const std::vector<std::string>& tokens, Command& cmd) -> void;
     auto joinFilePath(const std::vector<std::string> &pathTokens) -> std::string;
     auto parseLoadCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseCompressCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parsePageCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseTransactionCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseReplicateCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseCaptureCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseReplayCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseTraceCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseStatsCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseExplainCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseAnalyzeCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseShowCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
+    auto parseSetCommand(const std::vector<std::string> &tokens, Command &cmd) -> void;
     auto trim(const std::string &str) -> std::string;
+    auto parseLiteral(std::string data) -> std::string;
+    auto isArithmeticOperator(const std::string &token) -> bool;
     auto isLogicalOperator(const std::string &token) -> bool;
+    auto parseLikePattern(const std::vector<std::string> &tokens, size_t &currentIndex) -> std::string;
+    auto parseApproxAggregate(const std::vector<std::string> &tokens, size_t &currentIndex) -> ApproxAggregate;
+    auto parseTableSample(const std::vector<std::string> &tokens, size_t &currentIndex) -> TableSample;
 };
 
 #endif // PARSER_H
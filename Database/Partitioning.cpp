@@ -0,0 +1,106 @@
+#include "Partitioning.h"
+#include "Predicate.h"
+
+namespace {
+    auto floorDivide(long long value, long long divisor) -> long long {
+        long long quotient = value / divisor;
+        return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+    }
+
+    // FNV-1a - stały między kompilacjami i platformami, bo numer kubełka trafia do snapshotu razem z wierszami.
+    auto stableHash(const std::string &value) -> std::uint64_t {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (unsigned char ch: value) {
+            hash ^= ch;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+auto partitionBucket(const PartitionScheme &scheme, const std::string &key) -> std::optional<long long> {
+    long long number;
+    bool numeric = parseNumber(key, number);
+    if (scheme.method == PartitionMethod::Range) {
+        if (!numeric) {
+            return std::nullopt;
+        }
+        return floorDivide(number, scheme.width);
+    }
+    // Ta sama liczba zapisana inaczej ("05" i "5") trafia do tego samego kubełka.
+    return static_cast<long long>(stableHash(numeric ? std::to_string(number) : key) % scheme.count);
+}
+
+auto partitionSlot(const std::string &parent, const PartitionScheme &scheme, const std::string &key) -> PartitionSlot {
+    std::optional<long long> bucket = partitionBucket(scheme, key);
+    return {parent, bucket.value_or(0), !bucket.has_value()};
+}
+
+auto partitionTableName(const PartitionSlot &slot, const PartitionScheme &scheme) -> std::string {
+    if (slot.fallback) {
+        return slot.parent + "#default";
+    }
+    if (scheme.method == PartitionMethod::Hash) {
+        return slot.parent + "#h" + std::to_string(slot.bucket);
+    }
+    return slot.parent + "#" + std::to_string(slot.bucket * scheme.width);
+}
+
+auto partitionMayMatch(const PartitionScheme &scheme, const PartitionSlot &slot, const Expression *expression) -> bool {
+    if (expression == nullptr) {
+        return true;
+    }
+    if (expression->logicalOperator == "AND") {
+        return partitionMayMatch(scheme, slot, expression->left.get()) &&
+               partitionMayMatch(scheme, slot, expression->right.get());
+    }
+    if (expression->logicalOperator == "OR") {
+        return partitionMayMatch(scheme, slot, expression->left.get()) ||
+               partitionMayMatch(scheme, slot, expression->right.get());
+    }
+    if (expression->column != scheme.column) {
+        return true;
+    }
+
+    const std::string &op = expression->operators;
+    long long number;
+    bool numeric = parseNumber(expression->value, number);
+    if (scheme.method == PartitionMethod::Hash) {
+        // Równość porównuje napisy, a napis wyznacza kubełek; zakresy rozkładają się po wszystkich kubełkach.
+        return op != "=" || partitionBucket(scheme, expression->value) == slot.bucket;
+    }
+    if (slot.fallback) {
+        // Liczbowy klucz nigdy nie trafia do partycji domyślnej.
+        return op != "=" || !numeric;
+    }
+    if (!numeric) {
+        // Klucze przedziału są liczbami, więc nie są równe napisowi, który liczbą nie jest.
+        return op != "=";
+    }
+    long long low = slot.bucket * scheme.width;
+    long long high = low + (scheme.width - 1);
+    if (op == "=") return number >= low && number <= high;
+    if (op == "<") return low < number;
+    if (op == "<=") return low <= number;
+    if (op == ">") return high > number;
+    if (op == ">=") return high >= number;
+    return true;
+}
+
+auto describePartition(const PartitionScheme &scheme, const PartitionSlot &slot) -> std::string {
+    if (slot.fallback) {
+        return "default (no numeric key)";
+    }
+    if (scheme.method == PartitionMethod::Hash) {
+        return "hash " + std::to_string(slot.bucket) + " of " + std::to_string(scheme.count);
+    }
+    long long low = slot.bucket * scheme.width;
+    return "[" + std::to_string(low) + ", " + std::to_string(low + scheme.width) + ")";
+}
+
+auto describeScheme(const PartitionScheme &scheme) -> std::string {
+    if (scheme.method == PartitionMethod::Hash) {
+        return "HASH(" + scheme.column + ") INTO " + std::to_string(scheme.count);
+    }
+    return "RANGE(" + scheme.column + ") EVERY " + std::to_string(scheme.width);
+}
@@ -0,0 +1,47 @@
+#ifndef DATABASE2_PARTITIONING_H
+#define DATABASE2_PARTITIONING_H
+#pragma once
+#include "Prerequestion.h"
+#include "Expression.h"
+#include <cstdint>
+#include <optional>
+
+// Kubełki HASH powstają razem z tabelą, więc ich liczba jest ograniczona.
+constexpr std::size_t MAX_HASH_PARTITIONS = 1024;
+
+enum class PartitionMethod : std::uint8_t {
+    Range,
+    Hash
+};
+
+// CREATE ... PARTITION BY RANGE(column) EVERY width | PARTITION BY HASH(column) INTO count.
+struct PartitionScheme {
+    PartitionMethod method = PartitionMethod::Range;
+    std::string column;
+    // RANGE: przedział n trzyma klucze [n * width, (n + 1) * width); przedziały powstają przy pierwszym wierszu.
+    long long width = 0;
+    // HASH: liczba kubełków, wszystkie tworzone razem z tabelą.
+    std::size_t count = 0;
+};
+
+// Miejsce partycji w tabeli nadrzędnej. Partycja to zwykła tabela o nazwie partitionTableName(...).
+struct PartitionSlot {
+    std::string parent;
+    // RANGE: numer przedziału; HASH: numer kubełka.
+    long long bucket = 0;
+    // RANGE: partycja domyślna na wiersze bez liczbowego klucza (np. utworzone INSERT do innej kolumny).
+    bool fallback = false;
+};
+
+// Numer przedziału albo kubełka dla wartości klucza; nullopt - klucz trafia do partycji domyślnej.
+auto partitionBucket(const PartitionScheme &scheme, const std::string &key) -> std::optional<long long>;
+auto partitionSlot(const std::string &parent, const PartitionScheme &scheme, const std::string &key) -> PartitionSlot;
+// "t#2000" (RANGE, dolna granica), "t#default", "t#h3" (HASH) - '#' rozdziela tokeny, więc nazwy nie da się wpisać.
+auto partitionTableName(const PartitionSlot &slot, const PartitionScheme &scheme) -> std::string;
+// Czy partycja może zawierać wiersze spełniające WHERE; false tylko wtedy, gdy predykat na kluczu ją wyklucza.
+auto partitionMayMatch(const PartitionScheme &scheme, const PartitionSlot &slot, const Expression *expression) -> bool;
+// Opis granic partycji do SHOW PARTITIONS.
+auto describePartition(const PartitionScheme &scheme, const PartitionSlot &slot) -> std::string;
+auto describeScheme(const PartitionScheme &scheme) -> std::string;
+
+#endif //DATABASE2_PARTITIONING_H
@@ -0,0 +1,90 @@
+#include "Predicate.h"
+#include "TextSearch.h"
+#include <charconv>
+
+auto parseNumber(const std::string &value, long long &number) -> bool {
+    if (value.empty() || std::ranges::find_if(value.begin(), value.end(), [](unsigned char c) {
+        return !std::isdigit(c) && c != '.' && c != '-';
+    }) != value.end()) {
+        return false;
+    }
+    try {
+        number = std::stoll(value);
+    } catch (const std::exception &) {
+        return false;
+    }
+    return true;
+}
+
+auto compareValues(const std::string &columnValue, const std::string &op, const std::string &value) -> bool {
+    if (op == "=") {
+        return columnValue == value;
+    } else if (op == "!=") {
+        return columnValue != value;
+    } else if (op == "LIKE") {
+        return likeMatches(columnValue, value);
+    }
+
+    // Puste pole nie spełnia żadnego porównania porządkowego.
+    if (columnValue.empty()) {
+        return false;
+    }
+
+    long long numColumnValue;
+    long long numExpressionValue;
+    if (parseNumber(columnValue, numColumnValue) && parseNumber(value, numExpressionValue)) {
+        if (op == ">") {
+            return numColumnValue > numExpressionValue;
+        } else if (op == ">=") {
+            return numColumnValue >= numExpressionValue;
+        } else if (op == "<") {
+            return numColumnValue < numExpressionValue;
+        } else if (op == "<=") {
+            return numColumnValue <= numExpressionValue;
+        }
+    } else {
+        if (op == ">") {
+            return columnValue > value;
+        } else if (op == ">=") {
+            return columnValue >= value;
+        } else if (op == "<") {
+            return columnValue < value;
+        } else if (op == "<=") {
+            return columnValue <= value;
+        }
+    }
+
+    throw std::runtime_error("Unknown or unhandled expression operator");
+}
+
+auto parseCompareOp(const std::string &op) -> CompareOp {
+    if (op == "=") {
+        return CompareOp::Equal;
+    } else if (op == "!=") {
+        return CompareOp::NotEqual;
+    } else if (op == "<") {
+        return CompareOp::Less;
+    } else if (op == "<=") {
+        return CompareOp::LessEqual;
+    } else if (op == ">") {
+        return CompareOp::Greater;
+    } else if (op == ">=") {
+        return CompareOp::GreaterEqual;
+    }
+    throw std::runtime_error("Unknown or unhandled expression operator");
+}
+
+auto chooseCompareMode(ColumnType type, CompareOp op, const std::string &value, long long &number) -> CompareMode {
+    number = 0;
+    if (op == CompareOp::Equal || op == CompareOp::NotEqual || !parseNumber(value, number)) {
+        return CompareMode::Text;
+    }
+    return type == ColumnType::Int ? CompareMode::Integer : CompareMode::Mixed;
+}
+
+// Cały napis musi być liczbą w zakresie long long - inaczej wołający wraca do ogólnej ścieżki parseNumber.
+auto parseExactInteger(const std::string &value, long long &number) -> bool {
+    const char *end = value.data() + value.size();
+    auto [parsed, error] = std::from_chars(value.data(), end, number);
+    return error == std::errc() && parsed == end;
+}
@@ -0,0 +1,118 @@
+#ifndef DATABASE2_PREDICATE_H
+#define DATABASE2_PREDICATE_H
+#pragma once
+#include "Prerequestion.h"
+#include "Column.h"
+#include <cstdint>
+
+/*
+ * Wspólna semantyka porównań WHERE, używana zarówno przy wierszach, jak i przy strefach
+ * i skompresowanych kolumnach - wszystkie ścieżki muszą dawać ten sam wynik.
+ */
+auto parseNumber(const std::string &value, long long &number) -> bool;
+auto compareValues(const std::string &columnValue, const std::string &op, const std::string &value) -> bool;
+
+enum class CompareOp : std::uint8_t {
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual
+};
+
+/*
+ * Sposób porównania ustalany raz na zapytanie zamiast przy każdej wartości:
+ * Text - stała nie jest liczbą (oraz = i !=), więc zawsze porównanie napisów;
+ * Integer - kolumna int i liczbowa stała, wartości parsowane bez sprawdzania znaków;
+ * Mixed - liczbowa stała w kolumnie innego typu, każda wartość sprawdzana jak w compareValues.
+ */
+enum class CompareMode : std::uint8_t {
+    Text,
+    Integer,
+    Mixed
+};
+
+auto parseCompareOp(const std::string &op) -> CompareOp;
+auto chooseCompareMode(ColumnType type, CompareOp op, const std::string &value, long long &number) -> CompareMode;
+auto parseExactInteger(const std::string &value, long long &number) -> bool;
+
+template<CompareOp Op, typename T>
+inline auto compareOrdered(const T &left, const T &right) -> bool {
+    if constexpr (Op == CompareOp::Equal) {
+        return left == right;
+    } else if constexpr (Op == CompareOp::NotEqual) {
+        return left != right;
+    } else if constexpr (Op == CompareOp::Less) {
+        return left < right;
+    } else if constexpr (Op == CompareOp::LessEqual) {
+        return left <= right;
+    } else if constexpr (Op == CompareOp::Greater) {
+        return left > right;
+    } else {
+        return left >= right;
+    }
+}
+
+// To samo co compareValues(columnValue, op, value), ale bez rozgałęzień po operatorze; number to stała jako liczba.
+template<CompareMode Mode, CompareOp Op>
+inline auto compareValue(const std::string &columnValue, const std::string &value, long long number) -> bool {
+    if constexpr (Op == CompareOp::Equal || Op == CompareOp::NotEqual) {
+        return compareOrdered<Op>(columnValue, value);
+    } else {
+        // Puste pole nie spełnia żadnego porównania porządkowego.
+        if (columnValue.empty()) {
+            return false;
+        }
+        if constexpr (Mode == CompareMode::Text) {
+            return compareOrdered<Op>(columnValue, value);
+        } else if constexpr (Mode == CompareMode::Integer) {
+            long long cell;
+            if (parseExactInteger(columnValue, cell)) {
+                return compareOrdered<Op>(cell, number);
+            }
+            return compareValue<CompareMode::Mixed, Op>(columnValue, value, number);
+        } else {
+            long long cell;
+            if (parseNumber(columnValue, cell)) {
+                return compareOrdered<Op>(cell, number);
+            }
+            return compareOrdered<Op>(columnValue, value);
+        }
+    }
+}
+
+// Wywołuje visitor.template operator()<Mode, Op>() - jedna instancja szablonu na kombinację, wybrana raz.
+template<CompareMode Mode, typename Visitor>
+auto dispatchCompareOp(CompareOp op, Visitor &&visitor) -> decltype(auto) {
+    switch (op) {
+        case CompareOp::Equal:
+            return visitor.template operator()<Mode, CompareOp::Equal>();
+        case CompareOp::NotEqual:
+            return visitor.template operator()<Mode, CompareOp::NotEqual>();
+        case CompareOp::Less:
+            return visitor.template operator()<Mode, CompareOp::Less>();
+        case CompareOp::LessEqual:
+            return visitor.template operator()<Mode, CompareOp::LessEqual>();
+        case CompareOp::Greater:
+            return visitor.template operator()<Mode, CompareOp::Greater>();
+        case CompareOp::GreaterEqual:
+            break;
+    }
+    return visitor.template operator()<Mode, CompareOp::GreaterEqual>();
+}
+
+template<typename Visitor>
+auto dispatchComparison(CompareMode mode, CompareOp op, Visitor &&visitor) -> decltype(auto) {
+    switch (mode) {
+        case CompareMode::Integer:
+            return dispatchCompareOp<CompareMode::Integer>(op, visitor);
+        case CompareMode::Mixed:
+            return dispatchCompareOp<CompareMode::Mixed>(op, visitor);
+        case CompareMode::Text:
+            break;
+    }
+    return dispatchCompareOp<CompareMode::Text>(op, visitor);
+}
+
+#endif //DATABASE2_PREDICATE_H
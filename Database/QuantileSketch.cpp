@@ -0,0 +1,109 @@
+#include "QuantileSketch.h"
+#include <cmath>
+
+namespace {
+    // Stosunek pojemności kolejnych poziomów (od najwyższego w dół).
+    constexpr double LEVEL_SHRINK = 2.0 / 3.0;
+}
+
+QuantileSketch::QuantileSketch(std::size_t k) : k(std::max<std::size_t>(k, 8)) {
+    grow();
+}
+
+auto QuantileSketch::capacity(std::size_t level) const -> std::size_t {
+    auto depth = static_cast<double>(levels.size() - level - 1);
+    return static_cast<std::size_t>(std::ceil(std::pow(LEVEL_SHRINK, depth) * static_cast<double>(k))) + 1;
+}
+
+auto QuantileSketch::grow() -> void {
+    levels.emplace_back();
+    maxRetained = 0;
+    for (std::size_t level = 0; level < levels.size(); ++level) {
+        maxRetained += capacity(level);
+    }
+}
+
+auto QuantileSketch::add(long long value) -> void {
+    levels.front().push_back(value);
+    ++retained;
+    ++added;
+    if (retained >= maxRetained) {
+        compress();
+    }
+}
+
+// Zagęszcza najniższy pełny poziom; nieparzysta ostatnia wartość zostaje na swoim poziomie.
+auto QuantileSketch::compress() -> void {
+    for (std::size_t level = 0; level < levels.size(); ++level) {
+        if (levels[level].size() < capacity(level)) {
+            continue;
+        }
+        // grow() może przenieść wektor poziomów, więc referencje bierzemy dopiero po nim.
+        if (level + 1 == levels.size()) {
+            grow();
+        }
+        auto &items = levels[level];
+        std::ranges::sort(items);
+        std::size_t kept = items.size() % 2;
+        std::size_t offset = random() & 1;
+        auto &next = levels[level + 1];
+        for (std::size_t i = kept + offset; i < items.size(); i += 2) {
+            next.push_back(items[i]);
+        }
+        retained -= (items.size() - kept) / 2;
+        items.resize(kept);
+        return;
+    }
+}
+
+auto QuantileSketch::merge(const QuantileSketch &other) -> void {
+    while (levels.size() < other.levels.size()) {
+        grow();
+    }
+    for (std::size_t level = 0; level < other.levels.size(); ++level) {
+        levels[level].insert(levels[level].end(), other.levels[level].begin(), other.levels[level].end());
+        retained += other.levels[level].size();
+    }
+    added += other.added;
+    while (retained >= maxRetained) {
+        std::size_t before = retained;
+        compress();
+        if (retained == before) {
+            break;
+        }
+    }
+}
+
+auto QuantileSketch::quantile(double q) const -> long long {
+    std::vector<std::pair<long long, std::uint64_t>> weighted;
+    weighted.reserve(retained);
+    std::uint64_t total = 0;
+    for (std::size_t level = 0; level < levels.size(); ++level) {
+        for (long long value: levels[level]) {
+            weighted.emplace_back(value, std::uint64_t{1} << level);
+            total += std::uint64_t{1} << level;
+        }
+    }
+    if (weighted.empty()) {
+        throw std::runtime_error("Quantile of an empty sketch");
+    }
+    std::ranges::sort(weighted);
+    auto target = static_cast<double>(total) * std::clamp(q, 0.0, 1.0);
+    std::uint64_t seen = 0;
+    for (const auto &[value, weight]: weighted) {
+        seen += weight;
+        if (static_cast<double>(seen) >= target) {
+            return value;
+        }
+    }
+    return weighted.back().first;
+}
+
+// Przybliżenie empiryczne dla KLL: 2.296 / k^0.9723 (błąd dwustronny, ufność 99%).
+auto QuantileSketch::rankError() const -> double {
+    // Nic nie zostało odrzucone - szkic trzyma wszystkie wartości i kwantyl jest dokładny.
+    if (retained == added) {
+        return 0.0;
+    }
+    return 2.296 / std::pow(static_cast<double>(k), 0.9723);
+}
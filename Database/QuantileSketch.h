@@ -0,0 +1,42 @@
+#ifndef DATABASE2_QUANTILESKETCH_H
+#define DATABASE2_QUANTILESKETCH_H
+#pragma once
+#include "Prerequestion.h"
+#include <cstdint>
+#include <random>
+
+/*
+ * Szkic kwantyli KLL (Karnin, Lang, Liberty): poziom h trzyma próbki o wadze 2^h. Pełny poziom jest sortowany
+ * i co druga wartość (losowo parzyste albo nieparzyste) przechodzi poziom wyżej, a pojemności poziomów maleją
+ * geometrycznie od góry. Przy k = 200 to kilka KiB pamięci i błąd rangi ok. 1.3% niezależnie od liczby wartości;
+ * dwa szkice można łączyć (merge), więc kwantyle da się liczyć blokami albo po partycjach.
+ */
+class QuantileSketch {
+public:
+    explicit QuantileSketch(std::size_t k = 200);
+
+    auto add(long long value) -> void;
+    auto merge(const QuantileSketch &other) -> void;
+    // Wartość, od której mniejszych jest ok. q (0..1) wszystkich dodanych; szkic nie może być pusty.
+    auto quantile(double q) const -> long long;
+    auto count() const -> std::uint64_t {
+        return added;
+    }
+    // Błąd rangi (ułamek wszystkich wartości) z ufnością 99%; 0, dopóki szkic nic nie odrzucił.
+    auto rankError() const -> double;
+
+private:
+    auto capacity(std::size_t level) const -> std::size_t;
+    auto grow() -> void;
+    auto compress() -> void;
+
+    std::size_t k;
+    std::vector<std::vector<long long>> levels;
+    std::size_t retained = 0;
+    std::size_t maxRetained = 0;
+    std::uint64_t added = 0;
+    // Stałe ziarno - ten sam ciąg wartości daje ten sam szkic.
+    std::mt19937_64 random{0x6b6c6c};
+};
+
+#endif //DATABASE2_QUANTILESKETCH_H
@@ -0,0 +1,608 @@
+#include "Replication.h"
+#include "BinaryIO.h"
+#include "Database.h"
+#include "FileOps.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef DATABASE_REPLICATION
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Ramka na gnieździe: typ, długość i treść (jak napisy w BinaryIO).
+    enum class Frame : std::uint64_t {
+        Snapshot = 1,
+        Record = 2,
+        Heartbeat = 3,
+        Ack = 4
+    };
+    // Ack to zawsze typ, długość 8 i LSN.
+    constexpr std::size_t ACK_FRAME_BYTES = 24;
+    constexpr std::uint64_t MAX_FRAME_BYTES = std::uint64_t{1} << 40;
+    constexpr long REPLICATION_SEND_TIMEOUT_SECONDS = 5;
+
+    auto nowMillis() -> std::int64_t {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    auto millisSince(std::chrono::steady_clock::time_point since) -> long long {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    auto encodeRecord(const ChangeRecord &record) -> std::string {
+        std::ostringstream out;
+        writeU64(out, record.lsn);
+        writeI64(out, record.commitMillis);
+        writeU64(out, record.statements.size());
+        for (const auto &statement: record.statements) {
+            writeString(out, statement);
+        }
+        return out.str();
+    }
+
+    auto decodeRecord(std::istream &in) -> ChangeRecord {
+        ChangeRecord record;
+        record.lsn = readU64(in);
+        record.commitMillis = readI64(in);
+        std::uint64_t count = readU64(in);
+        for (std::uint64_t i = 0; i < count; ++i) {
+            record.statements.push_back(readString(in));
+        }
+        return record;
+    }
+
+    auto encodeLsn(std::uint64_t lsn) -> std::string {
+        std::ostringstream out;
+        writeU64(out, lsn);
+        return out.str();
+    }
+
+    auto readFile(const std::string &path) -> std::string {
+        std::ifstream file(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    auto writeFile(const std::string &path, const std::string &bytes) -> void {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+            throw std::runtime_error("Cannot write replica snapshot to " + path);
+        }
+    }
+
+    // CLI zatrzymuje replikację pod blokadą bazy, więc wątki replikacji nie mogą czekać na nią bez końca.
+    auto lockUnlessStopped(std::recursive_mutex &latch, const std::function<bool()> &stopped)
+    -> std::unique_lock<std::recursive_mutex> {
+        std::unique_lock<std::recursive_mutex> lock(latch, std::try_to_lock);
+        while (!lock.owns_lock() && !stopped()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            lock.try_lock();
+        }
+        return lock;
+    }
+
+#ifdef DATABASE_REPLICATION
+#ifdef MSG_NOSIGNAL
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    constexpr int SEND_FLAGS = 0;
+#endif
+
+    auto socketAddress(const std::string &path) -> sockaddr_un {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Invalid replication socket path: " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    auto openSocket() -> int {
+        int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket < 0) {
+            throw std::runtime_error(std::string("Cannot create replication socket: ") + std::strerror(errno));
+        }
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+        int on = 1;
+        ::setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        return socket;
+    }
+
+    auto sendAll(int socket, const std::string &bytes) -> bool {
+        std::size_t sent = 0;
+        while (sent < bytes.size()) {
+            ssize_t written = ::send(socket, bytes.data() + sent, bytes.size() - sent, SEND_FLAGS);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            sent += static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    auto sendFrame(int socket, Frame type, const std::string &payload) -> bool {
+        std::ostringstream out;
+        writeU64(out, static_cast<std::uint64_t>(type));
+        writeString(out, payload);
+        return sendAll(socket, out.str());
+    }
+
+    auto receiveAll(int socket, char *data, std::size_t size) -> bool {
+        std::size_t received = 0;
+        while (received < size) {
+            ssize_t read = ::recv(socket, data + received, size - received, 0);
+            if (read < 0 && errno == EINTR) {
+                continue;
+            }
+            if (read <= 0) {
+                return false;
+            }
+            received += static_cast<std::size_t>(read);
+        }
+        return true;
+    }
+
+    // false - połączenie zamknięte.
+    auto receiveFrame(int socket, Frame &type, std::string &payload) -> bool {
+        std::string header(16, '\0');
+        if (!receiveAll(socket, header.data(), header.size())) {
+            return false;
+        }
+        std::istringstream in(header);
+        type = static_cast<Frame>(readU64(in));
+        std::uint64_t size = readU64(in);
+        if (size > MAX_FRAME_BYTES) {
+            throw std::runtime_error("Corrupted replication frame");
+        }
+        payload.assign(size, '\0');
+        return size == 0 || receiveAll(socket, payload.data(), size);
+    }
+#endif
+}
+
+ReplicationPrimary::ReplicationPrimary(Database &db) : db(db) {
+}
+
+ReplicationPrimary::~ReplicationPrimary() {
+    stop();
+}
+
+auto ReplicationPrimary::active() const -> bool {
+    return listener >= 0;
+}
+
+auto ReplicationPrimary::serve(const std::string &socketPath) -> void {
+#ifdef DATABASE_REPLICATION
+    if (active()) {
+        throw std::runtime_error("Already serving replicas on " + path);
+    }
+    sockaddr_un address = socketAddress(socketPath);
+    // Gniazdo po poprzednim procesie można usunąć, zwykłego pliku - nie.
+    std::error_code error;
+    if (std::filesystem::exists(socketPath, error)) {
+        if (!std::filesystem::is_socket(socketPath, error)) {
+            throw std::runtime_error("Cannot serve replicas on " + socketPath + ": file exists and is not a socket");
+        }
+        std::filesystem::remove(socketPath, error);
+    }
+
+    int server = openSocket();
+    if (::bind(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(server, 16) != 0) {
+        std::string reason = std::strerror(errno);
+        ::close(server);
+        throw std::runtime_error("Cannot serve replicas on " + socketPath + ": " + reason);
+    }
+    path = socketPath;
+    listener = server;
+    stopRequested = false;
+    acceptor = std::thread([this] { acceptLoop(); });
+#else
+    throw std::runtime_error("Replication is not supported on this platform (requires Unix domain sockets)");
+#endif
+}
+
+auto ReplicationPrimary::stop() -> void {
+#ifdef DATABASE_REPLICATION
+    if (!active()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopRequested = true;
+    }
+    changed.notify_all();
+    acceptor.join();
+
+    std::vector<std::unique_ptr<Follower>> stopped;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopped.swap(followers);
+    }
+    for (auto &follower: stopped) {
+        follower->worker.join();
+        ::shutdown(follower->socket, SHUT_RDWR);
+        ::close(follower->socket);
+    }
+    ::close(listener);
+    ::unlink(path.c_str());
+    listener = -1;
+#endif
+}
+
+auto ReplicationPrimary::publish(std::vector<std::string> statements) -> void {
+    std::lock_guard<std::mutex> guard(mutex);
+    ++lsn;
+    if (followers.empty()) {
+        return;
+    }
+    auto payload = std::make_shared<const std::string>(encodeRecord({lsn, nowMillis(), std::move(statements)}));
+    for (auto &follower: followers) {
+        if (follower->closed) {
+            continue;
+        }
+        if (follower->pending.size() >= REPLICATION_MAX_PENDING) {
+#ifdef DATABASE_REPLICATION
+            ::shutdown(follower->socket, SHUT_RDWR);
+#endif
+            follower->closed = true;
+            follower->pending.clear();
+            continue;
+        }
+        follower->pending.emplace_back(lsn, payload);
+    }
+    changed.notify_all();
+}
+
+auto ReplicationPrimary::status() -> std::string {
+    std::ostringstream out;
+    if (!active()) {
+        return "Not serving replicas\n";
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    std::size_t connected = std::ranges::count_if(followers, [](const auto &follower) { return !follower->closed; });
+    out << "Serving replicas on " << path << ": LSN " << lsn << ", " << connected << " connected\n";
+    std::size_t number = 0;
+    for (const auto &follower: followers) {
+        ++number;
+        if (follower->closed) {
+            continue;
+        }
+        std::uint64_t acked = follower->ackedLsn;
+        out << "  replica " << number << ": acked LSN " << acked << " (" << lsn - acked << " behind), sent LSN "
+            << follower->sentLsn << ", queued " << follower->pending.size() << ", connected "
+            << millisSince(follower->connectedAt) / 1000 << " s\n";
+    }
+    return out.str();
+}
+
+auto ReplicationPrimary::acceptLoop() -> void {
+#ifdef DATABASE_REPLICATION
+    while (!stopRequested) {
+        // Zakończone połączenia sprząta ten sam wątek, który je tworzy.
+        std::vector<std::unique_ptr<Follower>> finished;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            for (auto it = followers.begin(); it != followers.end();) {
+                if ((*it)->closed) {
+                    finished.push_back(std::move(*it));
+                    it = followers.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (auto &follower: finished) {
+            follower->worker.join();
+            ::close(follower->socket);
+        }
+
+        pollfd request{listener, POLLIN, 0};
+        if (::poll(&request, 1, static_cast<int>(REPLICATION_HEARTBEAT.count())) <= 0) {
+            continue;
+        }
+        int socket = ::accept(listener, nullptr, nullptr);
+        if (socket >= 0) {
+            // Replika, która przestała czytać, nie może zatrzymać wysyłania (ani stop()) na dłużej.
+            timeval timeout{REPLICATION_SEND_TIMEOUT_SECONDS, 0};
+            ::setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            connect(socket);
+        }
+    }
+#endif
+}
+
+// Snapshot i LSN, od którego replika dostaje rekordy, powstają pod blokadą bazy - żadna zmiana nie wpadnie pomiędzy.
+auto ReplicationPrimary::connect(int socket) -> void {
+#ifdef DATABASE_REPLICATION
+    auto follower = std::make_unique<Follower>();
+    follower->socket = socket;
+    follower->connectedAt = std::chrono::steady_clock::now();
+
+    auto latch = lockUnlessStopped(db.latch(), [this] { return stopRequested.load(); });
+    if (!latch.owns_lock()) {
+        ::close(socket);
+        return;
+    }
+    std::string snapshotPath = path + ".snapshot";
+    std::string snapshot;
+    std::string statistics;
+    try {
+        FileOps().saveDatabase(db, snapshotPath);
+        snapshot = readFile(snapshotPath);
+        statistics = readFile(snapshotPath + ".stats");
+    } catch (const std::exception &e) {
+        std::cerr << "Replication: cannot snapshot database for a new replica: " << e.what() << std::endl;
+        ::close(socket);
+        snapshot.clear();
+    }
+    std::error_code error;
+    std::filesystem::remove(snapshotPath, error);
+    std::filesystem::remove(snapshotPath + ".stats", error);
+    if (snapshot.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    std::ostringstream out;
+    writeU64(out, lsn);
+    writeString(out, snapshot);
+    writeString(out, statistics);
+    follower->snapshot = out.str();
+    follower->sentLsn = lsn;
+    follower->ackedLsn = lsn;
+    Follower &added = *follower;
+    followers.push_back(std::move(follower));
+    added.worker = std::thread([this, &added] { sendLoop(added); });
+#endif
+}
+
+auto ReplicationPrimary::sendLoop(Follower &follower) -> void {
+#ifdef DATABASE_REPLICATION
+    bool connected = sendFrame(follower.socket, Frame::Snapshot, follower.snapshot);
+    follower.snapshot = std::string();
+    std::string acks;
+
+    while (connected) {
+        std::vector<std::pair<std::uint64_t, std::shared_ptr<const std::string>>> batch;
+        std::uint64_t currentLsn;
+        // Przy zatrzymaniu replika dostaje jeszcze rekordy, które już czekały.
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait_for(lock, REPLICATION_HEARTBEAT, [&] {
+                return stopRequested || follower.closed || !follower.pending.empty();
+            });
+            if (follower.closed) {
+                break;
+            }
+            batch.assign(follower.pending.begin(), follower.pending.end());
+            follower.pending.clear();
+            currentLsn = lsn;
+            stopping = stopRequested;
+        }
+        for (const auto &[recordLsn, payload]: batch) {
+            if (!(connected = sendFrame(follower.socket, Frame::Record, *payload))) {
+                break;
+            }
+            follower.sentLsn = recordLsn;
+        }
+        if (stopping) {
+            break;
+        }
+        if (connected && batch.empty()) {
+            std::ostringstream heartbeat;
+            writeU64(heartbeat, currentLsn);
+            writeI64(heartbeat, nowMillis());
+            connected = sendFrame(follower.socket, Frame::Heartbeat, heartbeat.str());
+        }
+
+        // Potwierdzenia zbiera się bez czekania; replika wysyła je po każdym zastosowanym rekordzie.
+        char chunk[512];
+        while (connected) {
+            ssize_t read = ::recv(follower.socket, chunk, sizeof(chunk), MSG_DONTWAIT);
+            if (read > 0) {
+                acks.append(chunk, static_cast<std::size_t>(read));
+            } else if (read < 0 && errno == EINTR) {
+                continue;
+            } else {
+                connected = read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+                break;
+            }
+        }
+        std::size_t complete = acks.size() / ACK_FRAME_BYTES * ACK_FRAME_BYTES;
+        std::istringstream in(acks.substr(0, complete));
+        for (std::size_t offset = 0; offset < complete; offset += ACK_FRAME_BYTES) {
+            Frame type = static_cast<Frame>(readU64(in));
+            readU64(in);
+            std::uint64_t acked = readU64(in);
+            if (type != Frame::Ack) {
+                connected = false;
+                break;
+            }
+            follower.ackedLsn = acked;
+        }
+        acks.erase(0, complete);
+    }
+    follower.closed = true;
+#endif
+}
+
+ReplicationFollower::ReplicationFollower(Database &db, ApplyBatch apply) : db(db), apply(std::move(apply)) {
+}
+
+ReplicationFollower::~ReplicationFollower() {
+    stop();
+}
+
+auto ReplicationFollower::active() const -> bool {
+    return running;
+}
+
+auto ReplicationFollower::follow(const std::string &socketPath) -> void {
+#ifdef DATABASE_REPLICATION
+    if (active()) {
+        throw std::runtime_error("Already replicating from " + path);
+    }
+    stop();
+
+    sockaddr_un address = socketAddress(socketPath);
+    int connection = openSocket();
+    if (::connect(connection, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        std::string reason = std::strerror(errno);
+        ::close(connection);
+        throw std::runtime_error("Cannot connect to primary at " + socketPath + ": " + reason);
+    }
+
+    std::string snapshotPath = (std::filesystem::temp_directory_path() /
+                                ("replica-" + std::to_string(::getpid()) + ".snapshot")).string();
+    std::uint64_t snapshotLsn = 0;
+    try {
+        Frame type;
+        std::string payload;
+        if (!receiveFrame(connection, type, payload) || type != Frame::Snapshot) {
+            throw std::runtime_error("Primary closed the connection before sending a snapshot");
+        }
+        std::istringstream in(payload);
+        snapshotLsn = readU64(in);
+        writeFile(snapshotPath, readString(in));
+        std::string statistics = readString(in);
+        if (!statistics.empty()) {
+            writeFile(snapshotPath + ".stats", statistics);
+        }
+        // Tabele wczytuje się od razu - plik tymczasowy zaraz znika.
+        db = FileOps().loadDatabase(snapshotPath);
+        db.loadAllTables();
+    } catch (...) {
+        ::close(connection);
+        std::error_code error;
+        std::filesystem::remove(snapshotPath, error);
+        std::filesystem::remove(snapshotPath + ".stats", error);
+        throw;
+    }
+    std::error_code error;
+    std::filesystem::remove(snapshotPath, error);
+    std::filesystem::remove(snapshotPath + ".stats", error);
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        appliedLsn = snapshotLsn;
+        primaryLsn = snapshotLsn;
+        lastApplyDelayMillis = 0;
+        lastContact = std::chrono::steady_clock::now();
+        this->error.clear();
+        path = socketPath;
+    }
+    socket = connection;
+    running = true;
+    receiver = std::thread([this] { receiveLoop(); });
+#else
+    throw std::runtime_error("Replication is not supported on this platform (requires Unix domain sockets)");
+#endif
+}
+
+auto ReplicationFollower::stop() -> void {
+#ifdef DATABASE_REPLICATION
+    running = false;
+    if (socket >= 0) {
+        ::shutdown(socket, SHUT_RDWR);
+    }
+    if (receiver.joinable()) {
+        receiver.join();
+    }
+    if (socket >= 0) {
+        ::close(socket);
+        socket = -1;
+    }
+#endif
+}
+
+auto ReplicationFollower::receiveLoop() -> void {
+#ifdef DATABASE_REPLICATION
+    Parser parser;
+    std::string failure = "connection to primary closed";
+    try {
+        Frame type;
+        std::string payload;
+        while (running && receiveFrame(socket, type, payload)) {
+            std::istringstream in(payload);
+            if (type == Frame::Heartbeat) {
+                std::uint64_t lsn = readU64(in);
+                std::lock_guard<std::mutex> guard(mutex);
+                primaryLsn = std::max(primaryLsn, lsn);
+                lastContact = std::chrono::steady_clock::now();
+                continue;
+            }
+            if (type != Frame::Record) {
+                throw std::runtime_error("unexpected frame from primary");
+            }
+
+            ChangeRecord record = decodeRecord(in);
+            std::vector<Command> batch;
+            for (const auto &statement: record.statements) {
+                batch.push_back(parser.parseSQLCommand(statement));
+            }
+            auto latch = lockUnlessStopped(db.latch(), [this] { return !running; });
+            if (!latch.owns_lock()) {
+                break;
+            }
+            try {
+                apply(batch);
+            } catch (const std::exception &e) {
+                throw std::runtime_error("change LSN " + std::to_string(record.lsn) + " failed: " + e.what());
+            }
+            latch.unlock();
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                appliedLsn = record.lsn;
+                primaryLsn = std::max(primaryLsn, record.lsn);
+                lastApplyDelayMillis = nowMillis() - record.commitMillis;
+                lastContact = std::chrono::steady_clock::now();
+            }
+            // Potwierdzenie dopiero po opróżnieniu gniazda: główny proces czyta je między porcjami rekordów,
+            // więc potwierdzanie każdego rekordu przy dużym ruchu zapełniłoby bufor i zablokowało obie strony.
+            pollfd pending{socket, POLLIN, 0};
+            if (::poll(&pending, 1, 0) == 0 && !sendFrame(socket, Frame::Ack, encodeLsn(record.lsn))) {
+                break;
+            }
+        }
+    } catch (const std::exception &e) {
+        failure = e.what();
+    }
+    // Po stop() to nie jest błąd.
+    std::lock_guard<std::mutex> guard(mutex);
+    if (running) {
+        error = failure;
+        running = false;
+    }
+#endif
+}
+
+auto ReplicationFollower::status() -> std::string {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (path.empty()) {
+        return "Not replicating\n";
+    }
+    std::ostringstream out;
+    if (running) {
+        out << "Replica of " << path;
+    } else {
+        out << "Replication from " << path << " stopped" << (error.empty() ? "" : ": " + error);
+    }
+    out << "\n  applied LSN " << appliedLsn << ", primary LSN " << primaryLsn << " (" << primaryLsn - appliedLsn
+        << " behind), last change applied " << lastApplyDelayMillis << " ms after commit, last contact "
+        << millisSince(lastContact) << " ms ago\n";
+    return out.str();
+}
@@ -0,0 +1,125 @@
+#ifndef DATABASE2_REPLICATION_H
+#define DATABASE2_REPLICATION_H
+#pragma once
+#include "Prerequestion.h"
+#include "Parser.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Replikacja używa gniazd domeny Unix - poza systemami POSIX polecenia REPLICATE kończą się błędem.
+#if defined(__unix__) || defined(__APPLE__)
+#define DATABASE_REPLICATION 1
+#endif
+
+// Co tyle główny proces wysyła replikom swój LSN, nawet gdy nie ma zmian (podstawa pomiaru opóźnienia).
+constexpr std::chrono::milliseconds REPLICATION_HEARTBEAT{500};
+// Replika, która zalega z tyloma rekordami, zostaje rozłączona zamiast zajmować pamięć głównego procesu.
+constexpr std::size_t REPLICATION_MAX_PENDING = 100000;
+
+// Zatwierdzona zmiana: jedno polecenie albo cała transakcja - replika stosuje je razem.
+struct ChangeRecord {
+    std::uint64_t lsn = 0;
+    // Chwila zatwierdzenia według zegara systemowego głównego procesu (ten sam host).
+    std::int64_t commitMillis = 0;
+    std::vector<std::string> statements;
+};
+
+class Database;
+
+/*
+ * Główny proces replikacji (REPLICATE SERVE path). Każda nowa replika dostaje snapshot bazy z chwili
+ * połączenia, a potem strumień rekordów zmian z kolejnymi LSN i potwierdza te już zastosowane.
+ * Rekordy tworzy CLI po udanym poleceniu zmieniającym dane albo po COMMIT; zmiany z API osadzonego
+ * (Embedded.h) nie są replikowane.
+ */
+class ReplicationPrimary {
+public:
+    explicit ReplicationPrimary(Database &db);
+    ~ReplicationPrimary();
+
+    ReplicationPrimary(const ReplicationPrimary &) = delete;
+    auto operator=(const ReplicationPrimary &) -> ReplicationPrimary & = delete;
+
+    auto serve(const std::string &socketPath) -> void;
+    auto stop() -> void;
+    auto active() const -> bool;
+    // Wołane pod blokadą bazy, po zastosowaniu zmiany.
+    auto publish(std::vector<std::string> statements) -> void;
+    auto status() -> std::string;
+
+private:
+    struct Follower {
+        int socket = -1;
+        // Ramka snapshotu do wysłania; zwalniana po wysłaniu.
+        std::string snapshot;
+        // (LSN, zakodowany rekord) - rekord koduje się raz dla wszystkich replik.
+        std::deque<std::pair<std::uint64_t, std::shared_ptr<const std::string>>> pending;
+        std::atomic<std::uint64_t> sentLsn{0};
+        std::atomic<std::uint64_t> ackedLsn{0};
+        std::atomic<bool> closed{false};
+        std::chrono::steady_clock::time_point connectedAt;
+        std::thread worker;
+    };
+
+    auto acceptLoop() -> void;
+    auto connect(int socket) -> void;
+    auto sendLoop(Follower &follower) -> void;
+
+    Database &db;
+    std::string path;
+    int listener = -1;
+    std::atomic<bool> stopRequested{false};
+    std::thread acceptor;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::uint64_t lsn = 0;
+    std::vector<std::unique_ptr<Follower>> followers;
+};
+
+/*
+ * Replika tylko do odczytu (REPLICATE FROM path): wczytuje snapshot głównego procesu i w wątku w tle
+ * stosuje kolejne rekordy zmian pod blokadą bazy. Polecenia zmieniające dane wpisane w jej CLI są odrzucane.
+ */
+class ReplicationFollower {
+public:
+    // Stosuje polecenia jednego rekordu razem (wywoływane pod blokadą bazy); błąd zatrzymuje replikację.
+    using ApplyBatch = std::function<void(const std::vector<Command> &)>;
+
+    ReplicationFollower(Database &db, ApplyBatch apply);
+    ~ReplicationFollower();
+
+    ReplicationFollower(const ReplicationFollower &) = delete;
+    auto operator=(const ReplicationFollower &) -> ReplicationFollower & = delete;
+
+    // Wywołujący trzyma blokadę bazy; snapshot jest wczytywany od razu, zmiany - już w tle.
+    auto follow(const std::string &socketPath) -> void;
+    auto stop() -> void;
+    auto active() const -> bool;
+    auto status() -> std::string;
+
+private:
+    auto receiveLoop() -> void;
+
+    Database &db;
+    ApplyBatch apply;
+    std::string path;
+    int socket = -1;
+    std::atomic<bool> running{false};
+    std::thread receiver;
+
+    std::mutex mutex;
+    std::uint64_t appliedLsn = 0;
+    std::uint64_t primaryLsn = 0;
+    std::int64_t lastApplyDelayMillis = 0;
+    std::chrono::steady_clock::time_point lastContact;
+    std::string error;
+};
+
+#endif //DATABASE2_REPLICATION_H
@@ -0,0 +1,111 @@
+#include "ResultCache.h"
+#include "Stats.h"
+#include "Expression.h"
+
+auto ResultCache::operator=(const ResultCache &other) -> ResultCache & {
+    if (this != &other) {
+        clear();
+        capacityBytes = other.capacityBytes;
+    }
+    return *this;
+}
+
+// Klucz z tokenów, więc różnice w odstępach w zapytaniu nie tworzą osobnych wpisów.
+auto ResultCache::key(const std::string &tableName, const std::vector<std::string> &columns,
+                      const std::vector<std::string> &whereTokens) -> std::string {
+    std::string result = tableName;
+    result += '\x1f';
+    for (const auto &column: columns) {
+        result += column;
+        result += ',';
+    }
+    result += '\x1f';
+    for (const auto &token: whereTokens) {
+        result += token;
+        result += ' ';
+    }
+    return result;
+}
+
+namespace {
+    auto appendExpression(std::string &out, const Expression *expression) -> void {
+        if (expression == nullptr) {
+            return;
+        }
+        if (!expression->logicalOperator.empty()) {
+            out += "( ";
+            appendExpression(out, expression->left.get());
+            out += expression->logicalOperator + ' ';
+            appendExpression(out, expression->right.get());
+            out += ") ";
+            return;
+        }
+        out += expression->column + ' ' + expression->operators + ' ' + expression->value + ' ';
+    }
+}
+
+auto ResultCache::key(const std::string &tableName, const std::vector<std::string> &columns,
+                      const Expression *where) -> std::string {
+    // Osobny znacznik, żeby klucz nie pokrył się z kluczem tekstowego WHERE o innym znaczeniu.
+    std::string result = key(tableName, columns, std::vector<std::string>()) + '\x1e';
+    appendExpression(result, where);
+    return result;
+}
+
+auto ResultCache::lookup(const std::string &key, std::uint64_t tableVersion) -> const Rows * {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        Stats::instance().addCacheMiss();
+        return nullptr;
+    }
+    if (it->second->tableVersion != tableVersion) {
+        erase(it->second);
+        Stats::instance().addCacheMiss();
+        return nullptr;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    Stats::instance().addCacheHit();
+    return &entries.front().rows;
+}
+
+auto ResultCache::store(const std::string &key, std::uint64_t tableVersion, Rows rows) -> void {
+    std::size_t bytes = sizeof(Entry) + key.size();
+    for (const auto &row: rows) {
+        bytes += sizeof(row) + row.size() * sizeof(std::string);
+        for (const auto &value: row) {
+            bytes += value.size() > 15 ? value.capacity() : 0;
+        }
+    }
+    // Pojedynczy ogromny wynik wypchnąłby cały cache - takich nie zapamiętujemy.
+    if (bytes > capacityBytes / 4) {
+        return;
+    }
+
+    if (auto it = index.find(key); it != index.end()) {
+        erase(it->second);
+    }
+    std::size_t evicted = 0;
+    while (!entries.empty() && usedBytes + bytes > capacityBytes) {
+        erase(std::prev(entries.end()));
+        ++evicted;
+    }
+    if (evicted > 0) {
+        Stats::instance().addCacheEvictions(evicted);
+    }
+
+    entries.push_front(Entry{key, tableVersion, std::move(rows), bytes});
+    index[key] = entries.begin();
+    usedBytes += bytes;
+}
+
+auto ResultCache::clear() -> void {
+    entries.clear();
+    index.clear();
+    usedBytes = 0;
+}
+
+auto ResultCache::erase(std::list<Entry>::iterator entry) -> void {
+    usedBytes -= entry->bytes;
+    index.erase(entry->key);
+    entries.erase(entry);
+}
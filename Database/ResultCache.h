@@ -0,0 +1,63 @@
+#ifndef DATABASE2_RESULTCACHE_H
+#define DATABASE2_RESULTCACHE_H
+#pragma once
+#include "Prerequestion.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+struct Expression;
+
+// Domyślny limit pamięci na wyniki SELECT trzymane w cache.
+constexpr std::size_t RESULT_CACHE_BYTES = 16 * 1024 * 1024;
+
+/*
+ * Cache wyników SELECT z wyrzucaniem LRU po przekroczeniu limitu bajtów.
+ * Wpis pamięta wersję tabeli z chwili zapisu - każda zmiana tabeli podbija wersję, więc stary wpis
+ * po prostu przestaje pasować i jest usuwany przy następnym odczycie.
+ * Kopia cache (np. przy db = loadDatabase(...)) jest pusta, bo wpisy dotyczą starej bazy.
+ */
+class ResultCache {
+public:
+    using Rows = std::vector<std::vector<std::string>>;
+
+    explicit ResultCache(std::size_t capacityBytes = RESULT_CACHE_BYTES) : capacityBytes(capacityBytes) {}
+    ResultCache(const ResultCache &other) : capacityBytes(other.capacityBytes) {}
+    ResultCache(ResultCache &&other) noexcept = default;
+    auto operator=(const ResultCache &other) -> ResultCache &;
+    auto operator=(ResultCache &&other) noexcept -> ResultCache & = default;
+
+    static auto key(const std::string &tableName, const std::vector<std::string> &columns,
+                    const std::vector<std::string> &whereTokens) -> std::string;
+    // Klucz dla predykatu zbudowanego w kodzie (API osadzone) - drzewo zapisane z nawiasami.
+    static auto key(const std::string &tableName, const std::vector<std::string> &columns,
+                    const Expression *where) -> std::string;
+
+    auto lookup(const std::string &key, std::uint64_t tableVersion) -> const Rows *;
+    auto store(const std::string &key, std::uint64_t tableVersion, Rows rows) -> void;
+    auto clear() -> void;
+    auto bytes() const -> std::size_t {
+        return usedBytes;
+    }
+    auto capacity() const -> std::size_t {
+        return capacityBytes;
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        std::uint64_t tableVersion = 0;
+        Rows rows;
+        std::size_t bytes = 0;
+    };
+
+    auto erase(std::list<Entry>::iterator entry) -> void;
+
+    std::size_t capacityBytes;
+    std::size_t usedBytes = 0;
+    // Od najświeżej używanych do najdawniej używanych.
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+};
+
+#endif //DATABASE2_RESULTCACHE_H
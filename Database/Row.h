@@ -8,16 +8,19 @@
 struct Row {
 
 
-    Row(const std::vector<Column> &cols) : columns(&cols), columnsSet(cols.size(), false) {}
+    Row(const std::vector<Column> &cols) : columnsSet(cols.size(), false), columns(&cols) {}
 
+    // Indeksowane przez Column::ordinal, nie przez pozycję kolumny w tabeli.
     std::vector<std::string> Data;
     std::vector<bool> columnsSet;
     const std::vector<Column> *columns;
 
 
     auto getValue(const std::string &columnName) -> std::string const;
-    auto canUpdate(size_t columnIndex) -> bool;
-    auto setValue(size_t columnIndex, const Row& inputRow) -> void;
+    auto value(const Column &column) const -> std::string;
+    auto canUpdate(const Column &column) const -> bool;
+    auto setValue(const Column &column, const std::string &newValue) -> void;
+    auto widen(size_t width) -> void;
 
 
 };
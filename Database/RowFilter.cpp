@@ -0,0 +1,82 @@
+#include "RowFilter.h"
+#include "Table.h"
+
+namespace {
+    template<CompareMode Mode, CompareOp Op>
+    auto filterLeaf(const CompiledPredicate &leaf, const std::vector<Row> &rows, std::size_t begin, std::size_t end,
+                    char *selection) -> void {
+        const std::size_t ordinal = leaf.ordinal;
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto &data = rows[i].Data;
+            // Wiersz zapisany przed ADD nie ma jeszcze tego miejsca - widzi wartość domyślną kolumny.
+            const std::string &cell = ordinal < data.size() ? data[ordinal] : leaf.defaultValue;
+            selection[i - begin] = compareValue<Mode, Op>(cell, leaf.value, leaf.number);
+        }
+    }
+
+    auto filterLike(const CompiledPredicate &leaf, const std::vector<Row> &rows, std::size_t begin, std::size_t end,
+                    char *selection) -> void {
+        const std::size_t ordinal = leaf.ordinal;
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto &data = rows[i].Data;
+            const std::string &cell = ordinal < data.size() ? data[ordinal] : leaf.defaultValue;
+            selection[i - begin] = leaf.like->matches(cell);
+        }
+    }
+}
+
+auto compilePredicate(const Table &table, const Expression *expression) -> std::unique_ptr<CompiledPredicate> {
+    if (expression == nullptr) {
+        return nullptr;
+    }
+    auto compiled = std::make_unique<CompiledPredicate>();
+    if (expression->logicalOperator == "AND" || expression->logicalOperator == "OR") {
+        compiled->node = expression->logicalOperator == "AND" ? CompiledPredicate::Node::And
+                                                               : CompiledPredicate::Node::Or;
+        compiled->left = compilePredicate(table, expression->left.get());
+        compiled->right = compilePredicate(table, expression->right.get());
+        return compiled;
+    }
+
+    const Column *column = table.findColumn(expression->column);
+    if (column == nullptr) {
+        throw std::runtime_error("Error: Column name '" + expression->column + "' not found in Row::getValue");
+    }
+    compiled->ordinal = column->ordinal;
+    compiled->defaultValue = column->defaultValue;
+    compiled->value = expression->value;
+    if (expression->operators == "LIKE") {
+        compiled->like = std::make_shared<const LikePattern>(expression->value);
+        compiled->kernel = &filterLike;
+        return compiled;
+    }
+    CompareOp op = parseCompareOp(expression->operators);
+    CompareMode mode = chooseCompareMode(column->type, op, expression->value, compiled->number);
+    compiled->kernel = dispatchComparison(mode, op, []<CompareMode Mode, CompareOp Op>() -> CompiledPredicate::Kernel {
+        return &filterLeaf<Mode, Op>;
+    });
+    return compiled;
+}
+
+auto filterRows(const CompiledPredicate &predicate, const std::vector<Row> &rows, std::size_t begin, std::size_t end,
+                std::vector<char> &selection) -> void {
+    selection.resize(end - begin);
+    if (predicate.node == CompiledPredicate::Node::Compare) {
+        predicate.kernel(predicate, rows, begin, end, selection.data());
+        return;
+    }
+
+    filterRows(*predicate.left, rows, begin, end, selection);
+    bool isAnd = predicate.node == CompiledPredicate::Node::And;
+    // Prawej strony nie liczymy, gdy lewa już rozstrzyga cały blok.
+    auto decided = isAnd ? std::ranges::none_of(selection, [](char match) { return match; })
+                         : std::ranges::all_of(selection, [](char match) { return match; });
+    if (decided) {
+        return;
+    }
+    std::vector<char> right;
+    filterRows(*predicate.right, rows, begin, end, right);
+    for (std::size_t i = 0; i < selection.size(); ++i) {
+        selection[i] = isAnd ? (selection[i] && right[i]) : (selection[i] || right[i]);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef DATABASE2_ROWFILTER_H
+#define DATABASE2_ROWFILTER_H
+#pragma once
+#include "Prerequestion.h"
+#include "Expression.h"
+#include "Predicate.h"
+#include "Row.h"
+#include "TextSearch.h"
+
+struct Table;
+
+/*
+ * WHERE przygotowany raz na zapytanie dla tabeli wierszowej: nazwy kolumn zamienione na ordinal,
+ * a każde porównanie dostaje kernel - instancję szablonu dla pary (CompareMode, CompareOp).
+ * Pętla po wierszach bloku nie porównuje już nazw kolumn, typów ani operatorów.
+ */
+struct CompiledPredicate {
+    enum class Node : std::uint8_t {
+        Compare,
+        And,
+        Or
+    };
+    using Kernel = void (*)(const CompiledPredicate &leaf, const std::vector<Row> &rows,
+                            std::size_t begin, std::size_t end, char *selection);
+
+    Node node = Node::Compare;
+    std::unique_ptr<CompiledPredicate> left;
+    std::unique_ptr<CompiledPredicate> right;
+    std::size_t ordinal = 0;
+    std::string defaultValue;
+    std::string value;
+    long long number = 0;
+    // LIKE: wzorzec przygotowany raz, kernel filterLike.
+    std::shared_ptr<const LikePattern> like;
+    Kernel kernel = nullptr;
+};
+
+// nullptr dla braku WHERE.
+auto compilePredicate(const Table &table, const Expression *expression) -> std::unique_ptr<CompiledPredicate>;
+// selection[i - begin] = czy wiersz i spełnia predykat.
+auto filterRows(const CompiledPredicate &predicate, const std::vector<Row> &rows, std::size_t begin, std::size_t end,
+                std::vector<char> &selection) -> void;
+
+#endif //DATABASE2_ROWFILTER_H
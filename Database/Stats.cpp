@@ -0,0 +1,212 @@
+#include "Stats.h"
+#include <bit>
+#include <iomanip>
+#include <limits>
+
+namespace {
+    constinit std::atomic<std::uint64_t> allocations{0};
+    constinit std::atomic<std::int64_t> heapBytes{0};
+
+    auto formatNanos(std::uint64_t nanos) -> std::string {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3) << static_cast<double>(nanos) / 1000.0 << "us";
+        return out.str();
+    }
+}
+
+auto LatencyHistogram::bucketIndex(std::uint64_t value) -> std::size_t {
+    if (value < subBuckets) {
+        return static_cast<std::size_t>(value);
+    }
+    int msb = std::bit_width(value) - 1;
+    auto sub = static_cast<std::size_t>((value >> (msb - subBucketBits)) - subBuckets);
+    return static_cast<std::size_t>(msb - subBucketBits + 1) * subBuckets + sub;
+}
+
+auto LatencyHistogram::bucketUpperBound(std::size_t index) -> std::uint64_t {
+    if (index < subBuckets) {
+        return index;
+    }
+    int msb = static_cast<int>(index / subBuckets) + subBucketBits - 1;
+    std::uint64_t sub = index % subBuckets;
+    int shift = msb - subBucketBits;
+    if (shift + subBucketBits + 1 >= 64) {
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+    return ((subBuckets + sub + 1) << shift) - 1;
+}
+
+auto LatencyHistogram::record(std::uint64_t nanos) -> void {
+    buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nanos, std::memory_order_relaxed);
+    std::uint64_t current = maxValue.load(std::memory_order_relaxed);
+    while (nanos > current && !maxValue.compare_exchange_weak(current, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+auto LatencyHistogram::count() const -> std::uint64_t {
+    return samples.load(std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::total() const -> std::uint64_t {
+    return sum.load(std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::max() const -> std::uint64_t {
+    return maxValue.load(std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::percentile(double p) const -> std::uint64_t {
+    std::uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(n));
+    if (rank >= n) {
+        rank = n - 1;
+    }
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
+
+auto LatencyHistogram::reset() -> void {
+    for (auto &bucket: buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    samples.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+
+auto Stats::instance() -> Stats & {
+    static Stats stats;
+    return stats;
+}
+
+auto Stats::allocationCounter() -> std::atomic<std::uint64_t> & {
+    return allocations;
+}
+
+auto Stats::heapBytesCounter() -> std::atomic<std::int64_t> & {
+    return heapBytes;
+}
+
+auto Stats::histogram(const std::string &commandType) -> LatencyHistogram & {
+    std::scoped_lock lock(histogramsMutex);
+    // std::map nie unieważnia referencji przy wstawianiu, więc można ją zwrócić poza blokadą.
+    return histograms[commandType];
+}
+
+auto Stats::recordCommand(const std::string &commandType, std::uint64_t nanos) -> void {
+    histogram(commandType).record(nanos);
+}
+
+auto Stats::addRowsScanned(std::size_t rows) -> void {
+    rowsScanned.fetch_add(rows, std::memory_order_relaxed);
+}
+
+auto Stats::addRowsMatched(std::size_t rows) -> void {
+    rowsMatched.fetch_add(rows, std::memory_order_relaxed);
+}
+
+auto Stats::addBytesRead(std::size_t bytes) -> void {
+    bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+auto Stats::addBytesWritten(std::size_t bytes) -> void {
+    bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+auto Stats::addCacheHit() -> void {
+    cacheHits.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto Stats::addCacheMiss() -> void {
+    cacheMisses.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto Stats::addCacheEvictions(std::size_t entries) -> void {
+    cacheEvictions.fetch_add(entries, std::memory_order_relaxed);
+}
+
+auto Stats::report() -> std::string {
+    std::ostringstream out;
+    out << std::left << std::setw(10) << "command" << std::right
+        << std::setw(10) << "count" << std::setw(14) << "mean" << std::setw(14) << "p50"
+        << std::setw(14) << "p99" << std::setw(14) << "max" << "\n";
+
+    std::scoped_lock lock(histogramsMutex);
+    for (const auto &[type, hist]: histograms) {
+        std::uint64_t n = hist.count();
+        out << std::left << std::setw(10) << type << std::right
+            << std::setw(10) << n
+            << std::setw(14) << formatNanos(n == 0 ? 0 : hist.total() / n)
+            << std::setw(14) << formatNanos(hist.percentile(50))
+            << std::setw(14) << formatNanos(hist.percentile(99))
+            << std::setw(14) << formatNanos(hist.max()) << "\n";
+    }
+    out << "rows scanned:  " << rowsScanned.load() << "\n"
+        << "rows matched:  " << rowsMatched.load() << "\n"
+        << "bytes read:    " << bytesRead.load() << "\n"
+        << "bytes written: " << bytesWritten.load() << "\n"
+        << "cache hits:    " << cacheHits.load() << "\n"
+        << "cache misses:  " << cacheMisses.load() << "\n"
+        << "cache evicted: " << cacheEvictions.load() << "\n"
+        << "allocations:   " << allocations.load() << "\n";
+    return out.str();
+}
+
+auto Stats::toJson() -> std::string {
+    std::ostringstream out;
+    out << "{\"commands\": {";
+    {
+        std::scoped_lock lock(histogramsMutex);
+        bool first = true;
+        for (const auto &[type, hist]: histograms) {
+            if (!first) {
+                out << ", ";
+            }
+            first = false;
+            out << "\"" << type << "\": {\"count\": " << hist.count()
+                << ", \"total_ns\": " << hist.total()
+                << ", \"p50_ns\": " << hist.percentile(50)
+                << ", \"p90_ns\": " << hist.percentile(90)
+                << ", \"p99_ns\": " << hist.percentile(99)
+                << ", \"max_ns\": " << hist.max() << "}";
+        }
+    }
+    out << "}, \"rows_scanned\": " << rowsScanned.load()
+        << ", \"rows_matched\": " << rowsMatched.load()
+        << ", \"bytes_read\": " << bytesRead.load()
+        << ", \"bytes_written\": " << bytesWritten.load()
+        << ", \"cache_hits\": " << cacheHits.load()
+        << ", \"cache_misses\": " << cacheMisses.load()
+        << ", \"cache_evictions\": " << cacheEvictions.load()
+        << ", \"allocations\": " << allocations.load() << "}";
+    return out.str();
+}
+
+auto Stats::reset() -> void {
+    {
+        std::scoped_lock lock(histogramsMutex);
+        for (auto &[type, hist]: histograms) {
+            hist.reset();
+        }
+    }
+    rowsScanned.store(0);
+    rowsMatched.store(0);
+    bytesRead.store(0);
+    bytesWritten.store(0);
+    cacheHits.store(0);
+    cacheMisses.store(0);
+    cacheEvictions.store(0);
+    allocations.store(0);
+}
@@ -0,0 +1,104 @@
+#ifndef DATABASE2_STATS_H
+#define DATABASE2_STATS_H
+#pragma once
+#include "Prerequestion.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+/*
+ * Histogram opóźnień w stylu HDR: 64 przedziały potęg dwójki, każdy podzielony na 16 liniowych
+ * pod-przedziałów, więc błąd względny percentyla nie przekracza ~6%, a record() to jeden atomic add.
+ */
+class LatencyHistogram {
+public:
+    auto record(std::uint64_t nanos) -> void;
+    auto count() const -> std::uint64_t;
+    auto total() const -> std::uint64_t;
+    auto max() const -> std::uint64_t;
+    auto percentile(double p) const -> std::uint64_t;
+    auto reset() -> void;
+
+private:
+    static constexpr int subBucketBits = 4;
+    static constexpr int subBuckets = 1 << subBucketBits;
+
+    static auto bucketIndex(std::uint64_t value) -> std::size_t;
+    static auto bucketUpperBound(std::size_t index) -> std::uint64_t;
+
+    std::array<std::atomic<std::uint64_t>, 64 * subBuckets> buckets{};
+    std::atomic<std::uint64_t> samples{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> maxValue{0};
+};
+
+// Czasy i liczniki jednego zapytania, wypełniane przez EXPLAIN ANALYZE.
+struct QueryProfile {
+    std::uint64_t parseNanos = 0;
+    std::uint64_t predicateNanos = 0;
+    std::uint64_t projectionNanos = 0;
+    std::uint64_t outputNanos = 0;
+    std::size_t blocksScanned = 0;
+    std::size_t blocksSkipped = 0;
+    std::size_t rowsScanned = 0;
+    std::size_t rowsMatched = 0;
+    std::size_t rowsOutput = 0;
+    // Żywe wiersze bloków pominiętych przez TABLESAMPLE.
+    std::size_t rowsNotSampled = 0;
+    std::string accessPath;
+};
+
+class Stats {
+public:
+    static auto instance() -> Stats &;
+    // Licznik alokacji jest osobnym atomikiem, bo podbija go zastępczy operator new.
+    static auto allocationCounter() -> std::atomic<std::uint64_t> &;
+    // Bajty żywych alokacji operator new - zwiększane i zmniejszane przez zastępcze operatory new/delete.
+    static auto heapBytesCounter() -> std::atomic<std::int64_t> &;
+
+    auto recordCommand(const std::string &commandType, std::uint64_t nanos) -> void;
+    auto addRowsScanned(std::size_t rows) -> void;
+    auto addRowsMatched(std::size_t rows) -> void;
+    auto addBytesRead(std::size_t bytes) -> void;
+    auto addBytesWritten(std::size_t bytes) -> void;
+    auto addCacheHit() -> void;
+    auto addCacheMiss() -> void;
+    auto addCacheEvictions(std::size_t entries) -> void;
+
+    auto report() -> std::string;
+    auto toJson() -> std::string;
+    auto reset() -> void;
+
+private:
+    Stats() = default;
+    auto histogram(const std::string &commandType) -> LatencyHistogram &;
+
+    std::mutex histogramsMutex;
+    std::map<std::string, LatencyHistogram> histograms;
+    std::atomic<std::uint64_t> rowsScanned{0};
+    std::atomic<std::uint64_t> rowsMatched{0};
+    std::atomic<std::uint64_t> bytesRead{0};
+    std::atomic<std::uint64_t> bytesWritten{0};
+    std::atomic<std::uint64_t> cacheHits{0};
+    std::atomic<std::uint64_t> cacheMisses{0};
+    std::atomic<std::uint64_t> cacheEvictions{0};
+};
+
+// Prosty stoper na steady_clock, używany do pomiaru faz zapytania.
+class StopWatch {
+public:
+    StopWatch() : start(std::chrono::steady_clock::now()) {}
+
+    auto elapsedNanos() const -> std::uint64_t {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif //DATABASE2_STATS_H
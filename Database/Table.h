@@ -4,11 +4,151 @@
 #include "Prerequestion.h"
 #include "Column.h"
 #include "Row.h"
+#include "ZoneMap.h"
+#include "Compression.h"
+#include "PagedStorage.h"
+#include "Partitioning.h"
+#include "MaterializedView.h"
+#include "TrigramIndex.h"
+#include <optional>
 
-struct Table {
+class LazyTableSource;
+struct TableStatistics;
+
+// Wszystkie pola tabeli; Table dokłada tylko przepinanie wierszy przy kopiowaniu.
+struct TableData {
     std::string name;
     std::vector<Column> columns;
     std::vector<Row> rows;
+    std::vector<ZoneMap> zones;
+    // Wersjonowanie schematu: ADD dostaje nowe miejsce (nextOrdinal), REMOVE zostawia martwe miejsce
+    // w deadOrdinals, które Compactor zwalnia w tle, przesuwając compactionCursor po wierszach.
+    std::size_t nextOrdinal = 0;
+    std::uint64_t schemaVersion = 0;
+    // Wersja danych i schematu z zegara Database (touch) - klucz ważności ResultCache.
+    std::uint64_t version = 0;
+    std::vector<std::size_t> deadOrdinals;
+    std::size_t compactionCursor = 0;
+    // Bitmapa wierszy usuniętych przez DELETE ... WHERE (może być krótsza niż liczba wierszy - brak bitu
+    // oznacza wiersz żywy). Skany je pomijają, a Compactor usuwa je fizycznie po przekroczeniu progu.
+    std::vector<bool> deleted;
+    std::size_t deletedCount = 0;
+    // Tabela po COMPRESS trzyma dane tylko w encoded, a rows jest puste do pierwszego zapisu.
+    bool compressed = false;
+    std::size_t encodedRowCount = 0;
+    std::vector<EncodedColumn> encoded;
+    // Zapis rozpakował skompresowaną tabelę (materialize): Compactor koduje ją ponownie, gdy między dwoma
+    // jego bezczynnymi przebiegami wersja tabeli się nie zmieni (recompressVersion - wersja z poprzedniego).
+    bool recompress = false;
+    std::uint64_t recompressVersion = 0;
+    // Tabela z LOAD, której dane nie zostały jeszcze wczytane z pliku (schemat i liczba wierszy już są).
+    std::shared_ptr<LazyTableSource> lazySource;
+    // Tabela po PAGE trzyma dane w pliku stron, a rows i encoded są puste (compressed == false).
+    std::optional<PagedStorage> paged;
+    // Tabela partycjonowana nie ma własnych wierszy - trzymają je partycje, czyli tabele z partition->parent
+    // równym jej nazwie. Każda partycja ma własne wiersze, strefy, kompresję i plik stron.
+    std::optional<PartitionScheme> partitioning;
+    std::optional<PartitionSlot> partition;
+    // Widok zmaterializowany: wiersze to wynik zapytania na tabeli view->base, poprawiany przy jej zmianach.
+    // Poza tym poprawianiem tabela widoku jest tylko do odczytu.
+    std::optional<ViewDefinition> view;
+    // Budowany przy pierwszej zmianie widoku; czyszczony, gdy indeksy wierszy się przesuwają.
+    std::optional<ViewRowIndex> viewRows;
+    // CREATE INDEX - indeksy trigramów kolumn napisowych (tabela partycjonowana trzyma tu tylko ich listę,
+    // a indeksy z wierszami mają partycje).
+    std::vector<TrigramIndex> indexes;
+    // Wynik ostatniego ANALYZE (może być nieaktualny - model kosztów traktuje go jako przybliżenie).
+    std::shared_ptr<const TableStatistics> statistics;
+};
+
+struct Table : TableData {
+    Table() = default;
+    Table(std::string name, std::vector<Column> columns, std::vector<Row> rows) {
+        this->name = std::move(name);
+        this->columns = std::move(columns);
+        this->rows = std::move(rows);
+        assignOrdinals();
+        rebindRows();
+    }
+
+    // Wiersze trzymają wskaźnik na wektor kolumn tabeli, więc po kopii/przeniesieniu trzeba go przepiąć.
+    Table(const Table &other) : TableData(other) {
+        rebindRows();
+    }
+
+    Table(Table &&other) noexcept: TableData(std::move(other)) {
+        rebindRows();
+    }
+
+    auto operator=(const Table &other) -> Table & {
+        TableData::operator=(other);
+        rebindRows();
+        return *this;
+    }
+
+    auto operator=(Table &&other) noexcept -> Table & {
+        TableData::operator=(std::move(other));
+        rebindRows();
+        return *this;
+    }
+
+    auto rebindRows() -> void {
+        for (auto &row: rows) {
+            row.columns = &columns;
+        }
+    }
+
+    auto rowCount() const -> std::size_t {
+        if (paged) {
+            return paged->rowCount;
+        }
+        return compressed ? encodedRowCount : rows.size();
+    }
+
+    auto isDeleted(std::size_t rowIndex) const -> bool {
+        return rowIndex < deleted.size() && deleted[rowIndex];
+    }
+
+    auto liveRowCount() const -> std::size_t {
+        return rowCount() - deletedCount;
+    }
+
+    // Kolumny w kolejności schematu dostają kolejne miejsca w Row::Data.
+    auto assignOrdinals() -> void {
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            columns[i].ordinal = i;
+        }
+        nextOrdinal = columns.size();
+        deadOrdinals.clear();
+        compactionCursor = 0;
+    }
+
+    auto findColumn(const std::string &columnName) const -> const Column * {
+        auto it = std::ranges::find_if(columns, [&columnName](const Column &column) {
+            return column.name == columnName;
+        });
+        return it == columns.end() ? nullptr : &*it;
+    }
+
+    auto findIndex(const std::string &columnName) -> TrigramIndex * {
+        auto it = std::ranges::find_if(indexes, [&columnName](const TrigramIndex &index) {
+            return index.column == columnName;
+        });
+        return it == indexes.end() ? nullptr : &*it;
+    }
+
+    auto hasEncoded(const Column &column) const -> bool {
+        return column.ordinal < encoded.size() && encoded[column.ordinal].size == encodedRowCount;
+    }
 
+    auto valueAt(std::size_t rowIndex, const Column &column) const -> std::string {
+        if (paged) {
+            return paged->valueAt(rowIndex, column);
+        }
+        if (compressed) {
+            return hasEncoded(column) ? encoded[column.ordinal].valueAt(rowIndex) : column.defaultValue;
+        }
+        return rows[rowIndex].value(column);
+    }
 };
 #endif //DATABASE2_TABLE_H
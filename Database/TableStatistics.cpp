@@ -0,0 +1,249 @@
+#include "TableStatistics.h"
+#include "Table.h"
+#include "HyperLogLog.h"
+#include "Predicate.h"
+#include "BinaryIO.h"
+#include <cmath>
+#include <random>
+
+namespace {
+    // Domyślne selektywności dla kolumn bez statystyk (te same rzędy wielkości co w PostgreSQL).
+    constexpr double DEFAULT_EQUAL_SELECTIVITY = 0.005;
+    constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3.0;
+    // Histogram nie mówi nic o podciągach, więc LIKE zawsze dostaje stały udział wierszy z wartością.
+    constexpr double DEFAULT_LIKE_SELECTIVITY = 0.05;
+
+    auto numericBounds(const std::vector<std::string> &bounds) -> std::vector<long long> {
+        std::vector<long long> numbers;
+        numbers.reserve(bounds.size());
+        for (const auto &bound: bounds) {
+            long long number = 0;
+            parseNumber(bound, number);
+            numbers.push_back(number);
+        }
+        return numbers;
+    }
+}
+
+auto ColumnStatistics::fractionBelow(const std::string &value) const -> double {
+    if (bounds.size() < 2) {
+        return bounds.empty() || value <= bounds.front() ? 0.0 : 1.0;
+    }
+    const double buckets = static_cast<double>(bounds.size() - 1);
+    long long number;
+    if (numeric) {
+        if (!parseNumber(value, number)) {
+            return DEFAULT_RANGE_SELECTIVITY;
+        }
+        std::vector<long long> numbers = numericBounds(bounds);
+        if (number <= numbers.front()) {
+            return 0.0;
+        }
+        if (number > numbers.back()) {
+            return 1.0;
+        }
+        // Interpolacja liniowa wewnątrz przedziału, w którym leży wartość.
+        auto it = std::ranges::lower_bound(numbers, number);
+        auto bucket = static_cast<std::size_t>(std::distance(numbers.begin(), it)) - 1;
+        double width = static_cast<double>(numbers[bucket + 1] - numbers[bucket]);
+        double within = width > 0 ? static_cast<double>(number - numbers[bucket]) / width : 1.0;
+        return (static_cast<double>(bucket) + within) / buckets;
+    }
+    auto below = static_cast<std::size_t>(std::distance(bounds.begin(), std::ranges::lower_bound(bounds, value)));
+    if (below == 0) {
+        return 0.0;
+    }
+    if (below == bounds.size()) {
+        return 1.0;
+    }
+    return (static_cast<double>(below) - 0.5) / buckets;
+}
+
+auto ColumnStatistics::fractionEqual(const std::string &value) const -> double {
+    if (bounds.empty() || distinct < 1.0) {
+        return 0.0;
+    }
+    long long number;
+    std::size_t repeated = 0;
+    if (numeric && parseNumber(value, number)) {
+        std::vector<long long> numbers = numericBounds(bounds);
+        if (number < numbers.front() || number > numbers.back()) {
+            return 0.0;
+        }
+        repeated = static_cast<std::size_t>(std::ranges::count(numbers, number));
+    } else {
+        if (value < bounds.front() || value > bounds.back()) {
+            return 0.0;
+        }
+        repeated = static_cast<std::size_t>(std::ranges::count(bounds, value));
+    }
+    // Wartość, która jest granicą kilku przedziałów z rzędu, zajmuje co najmniej tyle przedziałów.
+    double fromHistogram = repeated > 1 ? static_cast<double>(repeated - 1) / static_cast<double>(bounds.size() - 1)
+                                        : 0.0;
+    return std::max(1.0 / distinct, fromHistogram);
+}
+
+auto TableStatistics::column(const std::string &name) const -> const ColumnStatistics * {
+    auto it = std::ranges::find_if(columns, [&name](const ColumnStatistics &column) {
+        return column.name == name;
+    });
+    return it == columns.end() ? nullptr : &*it;
+}
+
+auto analyzeTable(const Table &table) -> TableStatistics {
+    TableStatistics statistics;
+    statistics.rowCount = table.liveRowCount();
+    std::mt19937_64 random(HISTOGRAM_SAMPLE);
+
+    for (const auto &column: table.columns) {
+        ColumnStatistics columnStatistics;
+        columnStatistics.name = column.name;
+        HyperLogLog distinct;
+        std::vector<std::string> sample;
+        std::size_t seen = 0;
+        std::size_t pairs = 0;
+        std::size_t ordered = 0;
+        bool numeric = true;
+        std::string previous;
+
+        for (std::size_t i = 0; i < table.rowCount(); ++i) {
+            if (table.isDeleted(i)) {
+                continue;
+            }
+            std::string value = table.valueAt(i, column);
+            if (value.empty()) {
+                ++columnStatistics.nullCount;
+                continue;
+            }
+            distinct.add(value);
+            long long number;
+            numeric = numeric && parseNumber(value, number);
+            if (seen > 0) {
+                ++pairs;
+                ordered += !compareValues(value, "<", previous);
+            }
+            // Próbka rezerwuarowa - histogram nie wymaga sortowania całej kolumny.
+            if (sample.size() < HISTOGRAM_SAMPLE) {
+                sample.push_back(value);
+            } else if (std::size_t slot = random() % (seen + 1); slot < HISTOGRAM_SAMPLE) {
+                sample[slot] = value;
+            }
+            previous = std::move(value);
+            ++seen;
+        }
+
+        columnStatistics.numeric = numeric && seen > 0;
+        columnStatistics.distinct = seen == 0 ? 0.0 : std::clamp(distinct.estimate(), 1.0, static_cast<double>(seen));
+        columnStatistics.correlation = pairs == 0 ? 1.0 : std::fabs(2.0 * static_cast<double>(ordered) /
+                                                                    static_cast<double>(pairs) - 1.0);
+        if (columnStatistics.numeric) {
+            std::ranges::sort(sample, [](const std::string &a, const std::string &b) {
+                long long left = 0;
+                long long right = 0;
+                parseNumber(a, left);
+                parseNumber(b, right);
+                return left < right;
+            });
+        } else {
+            std::ranges::sort(sample);
+        }
+        for (std::size_t bucket = 0; !sample.empty() && bucket <= HISTOGRAM_BUCKETS; ++bucket) {
+            columnStatistics.bounds.push_back(sample[bucket * (sample.size() - 1) / HISTOGRAM_BUCKETS]);
+        }
+        statistics.columns.push_back(std::move(columnStatistics));
+    }
+    return statistics;
+}
+
+auto estimateSelectivity(const TableStatistics *statistics, const Expression *expression) -> double {
+    if (expression == nullptr) {
+        return 1.0;
+    }
+    if (expression->logicalOperator == "AND") {
+        return estimateSelectivity(statistics, expression->left.get()) *
+               estimateSelectivity(statistics, expression->right.get());
+    }
+    if (expression->logicalOperator == "OR") {
+        double left = estimateSelectivity(statistics, expression->left.get());
+        double right = estimateSelectivity(statistics, expression->right.get());
+        return left + right - left * right;
+    }
+
+    const std::string &op = expression->operators;
+    const ColumnStatistics *column = statistics == nullptr ? nullptr : statistics->column(expression->column);
+    if (column == nullptr || statistics->rowCount == 0) {
+        if (op == "LIKE") {
+            return DEFAULT_LIKE_SELECTIVITY;
+        }
+        if (op == "=") {
+            return DEFAULT_EQUAL_SELECTIVITY;
+        }
+        return op == "!=" ? 1.0 - DEFAULT_EQUAL_SELECTIVITY : DEFAULT_RANGE_SELECTIVITY;
+    }
+
+    const double rows = static_cast<double>(statistics->rowCount);
+    const double nullFraction = static_cast<double>(column->nullCount) / rows;
+    const double nonNull = 1.0 - nullFraction;
+    if (op == "LIKE") {
+        return nonNull * DEFAULT_LIKE_SELECTIVITY;
+    }
+    const double equal = expression->value.empty() ? 0.0 : column->fractionEqual(expression->value);
+    const double below = column->fractionBelow(expression->value);
+    double selectivity;
+    if (op == "=") {
+        selectivity = expression->value.empty() ? nullFraction : nonNull * equal;
+    } else if (op == "!=") {
+        selectivity = 1.0 - (expression->value.empty() ? nullFraction : nonNull * equal);
+    } else if (op == "<") {
+        selectivity = nonNull * below;
+    } else if (op == "<=") {
+        selectivity = nonNull * (below + equal);
+    } else if (op == ">") {
+        selectivity = nonNull * (1.0 - below - equal);
+    } else {
+        selectivity = nonNull * (1.0 - below);
+    }
+    return std::clamp(selectivity, 0.0, 1.0);
+}
+
+auto writeTableStatistics(std::ostream &out, const TableStatistics &statistics) -> void {
+    writeU64(out, statistics.rowCount);
+    writeU64(out, statistics.columns.size());
+    for (const auto &column: statistics.columns) {
+        writeString(out, column.name);
+        writeU64(out, column.nullCount);
+        writeDouble(out, column.distinct);
+        writeDouble(out, column.correlation);
+        writeU64(out, column.numeric);
+        writeU64(out, column.bounds.size());
+        for (const auto &bound: column.bounds) {
+            writeString(out, bound);
+        }
+    }
+}
+
+auto readTableStatistics(std::istream &in) -> TableStatistics {
+    TableStatistics statistics;
+    statistics.rowCount = readU64(in);
+    std::uint64_t columns = readU64(in);
+    if (columns > (std::uint64_t{1} << 20)) {
+        throw std::runtime_error("Corrupted statistics file: too many columns");
+    }
+    statistics.columns.resize(columns);
+    for (auto &column: statistics.columns) {
+        column.name = readString(in);
+        column.nullCount = readU64(in);
+        column.distinct = readDouble(in);
+        column.correlation = readDouble(in);
+        column.numeric = readU64(in) != 0;
+        std::uint64_t bounds = readU64(in);
+        if (bounds > HISTOGRAM_BUCKETS + 1) {
+            throw std::runtime_error("Corrupted statistics file: too many histogram bounds");
+        }
+        column.bounds.resize(bounds);
+        for (auto &bound: column.bounds) {
+            bound = readString(in);
+        }
+    }
+    return statistics;
+}
@@ -0,0 +1,46 @@
+#ifndef DATABASE2_TABLESTATISTICS_H
+#define DATABASE2_TABLESTATISTICS_H
+#pragma once
+#include "Prerequestion.h"
+#include "Expression.h"
+#include <cstdint>
+
+struct Table;
+
+// Liczba przedziałów histogramu i maksymalna próbka, z której jest budowany.
+constexpr std::size_t HISTOGRAM_BUCKETS = 32;
+constexpr std::size_t HISTOGRAM_SAMPLE = 30000;
+
+/*
+ * Statystyki kolumny zbierane przez ANALYZE. bounds to granice histogramu equi-depth (HISTOGRAM_BUCKETS + 1
+ * wartości, każdy przedział zawiera tyle samo wierszy). correlation mówi, jak bardzo kolejność wierszy
+ * zgadza się z kolejnością wartości (1 - posortowane, 0 - losowe) - od tego zależy skuteczność map stref.
+ */
+struct ColumnStatistics {
+    std::string name;
+    std::size_t nullCount = 0;
+    double distinct = 0.0;
+    double correlation = 0.0;
+    bool numeric = false;
+    std::vector<std::string> bounds;
+
+    // Szacowany ułamek niepustych wartości mniejszych od value.
+    auto fractionBelow(const std::string &value) const -> double;
+    auto fractionEqual(const std::string &value) const -> double;
+};
+
+struct TableStatistics {
+    std::size_t rowCount = 0;
+    std::vector<ColumnStatistics> columns;
+
+    auto column(const std::string &name) const -> const ColumnStatistics *;
+};
+
+auto analyzeTable(const Table &table) -> TableStatistics;
+// Szacowany ułamek wierszy spełniających WHERE; bez statystyk używa stałych domyślnych.
+auto estimateSelectivity(const TableStatistics *statistics, const Expression *expression) -> double;
+
+auto writeTableStatistics(std::ostream &out, const TableStatistics &statistics) -> void;
+auto readTableStatistics(std::istream &in) -> TableStatistics;
+
+#endif //DATABASE2_TABLESTATISTICS_H
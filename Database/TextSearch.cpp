@@ -0,0 +1,196 @@
+#include "TextSearch.h"
+#include <bit>
+#include <cstring>
+
+#ifdef DATABASE_SIMD_SEARCH
+#include <emmintrin.h>
+#endif
+
+auto likeSubject(std::string_view value) -> std::string_view {
+    std::size_t first = value.find_first_not_of(' ');
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    std::size_t last = value.find_last_not_of(' ');
+    return value.substr(first, last - first + 1);
+}
+
+/*
+ * Pierwszy i ostatni bajt needle porównywane są z 16 pozycjami haystack naraz; memcmp środka
+ * tylko dla pozycji, na których oba się zgadzają. Końcówkę krótszą niż blok sprawdza std::string_view::find.
+ */
+auto findSubstring(std::string_view haystack, std::string_view needle) -> std::size_t {
+    if (needle.empty()) {
+        return 0;
+    }
+    if (needle.size() > haystack.size()) {
+        return std::string_view::npos;
+    }
+    if (needle.size() == 1) {
+        return haystack.find(needle.front());
+    }
+    std::size_t position = 0;
+#ifdef DATABASE_SIMD_SEARCH
+    const std::size_t length = needle.size();
+    const __m128i first = _mm_set1_epi8(needle.front());
+    const __m128i last = _mm_set1_epi8(needle.back());
+    for (; position + length - 1 + 16 <= haystack.size(); position += 16) {
+        const char *block = haystack.data() + position;
+        __m128i firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+        __m128i lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + length - 1));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(first, firstBlock), _mm_cmpeq_epi8(last, lastBlock))));
+        while (mask != 0) {
+            auto offset = static_cast<std::size_t>(std::countr_zero(mask));
+            if (std::memcmp(block + offset + 1, needle.data() + 1, length - 2) == 0) {
+                return position + offset;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    return haystack.find(needle, position);
+}
+
+// Zwykłe dopasowanie z powrotem do ostatniego % - bez alokacji, dla ścieżek porównujących wartość po wartości.
+auto likeMatches(const std::string &value, const std::string &pattern) -> bool {
+    if (value.empty()) {
+        return false;
+    }
+    std::string_view subject = likeSubject(value);
+    std::size_t s = 0;
+    std::size_t p = 0;
+    std::size_t star = std::string::npos;
+    std::size_t resume = 0;
+    while (s < subject.size()) {
+        if (p < pattern.size() && (pattern[p] == '_' || pattern[p] == subject[s])) {
+            ++s;
+            ++p;
+        } else if (p < pattern.size() && pattern[p] == '%') {
+            star = p++;
+            resume = s;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            s = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '%') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+LikePattern::LikePattern(const std::string &pattern) {
+    anchoredStart = pattern.empty() || pattern.front() != '%';
+    anchoredEnd = pattern.empty() || pattern.back() != '%';
+    std::size_t begin = 0;
+    while (begin <= pattern.size()) {
+        std::size_t end = pattern.find('%', begin);
+        if (end == std::string::npos) {
+            end = pattern.size();
+        }
+        if (end > begin) {
+            Segment segment{pattern.substr(begin, end - begin)};
+            segment.wildcard = segment.text.find('_') != std::string::npos;
+            segments.push_back(std::move(segment));
+        }
+        begin = end + 1;
+    }
+}
+
+auto LikePattern::segmentAt(const Segment &segment, std::string_view value, std::size_t position) -> bool {
+    if (position + segment.text.size() > value.size()) {
+        return false;
+    }
+    if (!segment.wildcard) {
+        return value.compare(position, segment.text.size(), segment.text) == 0;
+    }
+    for (std::size_t i = 0; i < segment.text.size(); ++i) {
+        if (segment.text[i] != '_' && segment.text[i] != value[position + i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto LikePattern::findSegment(const Segment &segment, std::string_view value, std::size_t from) -> std::size_t {
+    if (from > value.size()) {
+        return std::string_view::npos;
+    }
+    if (!segment.wildcard) {
+        std::size_t found = findSubstring(value.substr(from), segment.text);
+        return found == std::string_view::npos ? found : from + found;
+    }
+    for (std::size_t position = from; position + segment.text.size() <= value.size(); ++position) {
+        if (segmentAt(segment, value, position)) {
+            return position;
+        }
+    }
+    return std::string_view::npos;
+}
+
+/*
+ * Pierwszy fragment (bez % na początku wzorca) musi stać na początku wartości, ostatni (bez % na końcu) na końcu,
+ * a środkowe wyszukiwane są od lewej - najwcześniejsze trafienie zostawia najwięcej miejsca na resztę.
+ */
+auto LikePattern::matches(const std::string &value) const -> bool {
+    if (value.empty()) {
+        return false;
+    }
+    std::string_view subject = likeSubject(value);
+    if (segments.empty()) {
+        return !anchoredStart || subject.empty();
+    }
+    std::size_t first = 0;
+    std::size_t last = segments.size();
+    std::size_t position = 0;
+    if (anchoredStart) {
+        if (!segmentAt(segments.front(), subject, 0)) {
+            return false;
+        }
+        position = segments.front().text.size();
+        ++first;
+    }
+    std::size_t limit = subject.size();
+    if (anchoredEnd && first < last) {
+        const Segment &tail = segments.back();
+        if (tail.text.size() > subject.size() || tail.text.size() + position > subject.size() ||
+            !segmentAt(tail, subject, subject.size() - tail.text.size())) {
+            return false;
+        }
+        limit = subject.size() - tail.text.size();
+        --last;
+    } else if (anchoredEnd && position != subject.size()) {
+        // Jeden fragment zakotwiczony z obu stron - wartość musi mieć dokładnie jego długość.
+        return false;
+    }
+    for (std::size_t i = first; i < last; ++i) {
+        std::size_t found = findSegment(segments[i], subject.substr(0, limit), position);
+        if (found == std::string_view::npos) {
+            return false;
+        }
+        position = found + segments[i].text.size();
+    }
+    return true;
+}
+
+auto likeLiterals(const std::string &pattern) -> std::vector<std::string> {
+    std::vector<std::string> literals;
+    std::string current;
+    for (char ch: pattern) {
+        if (ch == '%' || ch == '_') {
+            if (!current.empty()) {
+                literals.push_back(std::move(current));
+                current.clear();
+            }
+        } else {
+            current += ch;
+        }
+    }
+    if (!current.empty()) {
+        literals.push_back(std::move(current));
+    }
+    return literals;
+}
@@ -0,0 +1,50 @@
+#ifndef DATABASE2_TEXTSEARCH_H
+#define DATABASE2_TEXTSEARCH_H
+#pragma once
+#include "Prerequestion.h"
+#include <cstdint>
+#include <string_view>
+
+// Wyszukiwanie podciągu porównuje 16 bajtów naraz (SSE2); na innych procesorach zostaje std::string_view::find.
+#if defined(__SSE2__) || defined(_M_X64)
+#define DATABASE_SIMD_SEARCH 1
+#endif
+
+/*
+ * WHERE kolumna LIKE 'wzorzec': % - dowolny ciąg znaków, _ - dokładnie jeden znak.
+ * Napis z INSERT ['...'] jest zapisany z odstępami, które dodał tokenizer, więc LIKE porównuje wartość
+ * bez odstępów na początku i końcu. Pusta komórka, jak przy innych porównaniach, nie pasuje do niczego.
+ */
+auto likeMatches(const std::string &value, const std::string &pattern) -> bool;
+// Wartość taka, jaką widzi LIKE (bez odstępów dodanych przez tokenizer na brzegach).
+auto likeSubject(std::string_view value) -> std::string_view;
+// Pozycja pierwszego wystąpienia needle w haystack albo std::string_view::npos.
+auto findSubstring(std::string_view haystack, std::string_view needle) -> std::size_t;
+
+// Wzorzec przygotowany raz na zapytanie: fragmenty między % szukane są findSubstring.
+class LikePattern {
+public:
+    explicit LikePattern(const std::string &pattern);
+
+    auto matches(const std::string &value) const -> bool;
+
+private:
+    struct Segment {
+        std::string text;
+        // Fragment zawiera _ - porównywany znak po znaku zamiast findSubstring.
+        bool wildcard = false;
+    };
+
+    static auto segmentAt(const Segment &segment, std::string_view value, std::size_t position) -> bool;
+    static auto findSegment(const Segment &segment, std::string_view value, std::size_t from) -> std::size_t;
+
+    std::vector<Segment> segments;
+    // Pierwszy fragment musi stać na początku, ostatni na końcu (wzorzec nie zaczyna / nie kończy się na %).
+    bool anchoredStart = true;
+    bool anchoredEnd = true;
+};
+
+// Fragmenty wzorca bez % i _ (z nich indeks trigramów wybiera wiersze do sprawdzenia).
+auto likeLiterals(const std::string &pattern) -> std::vector<std::string>;
+
+#endif //DATABASE2_TEXTSEARCH_H
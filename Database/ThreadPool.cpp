@@ -0,0 +1,120 @@
+#include "ThreadPool.h"
+
+namespace {
+    thread_local bool insidePool = false;
+    std::atomic<bool> poolDisabled{false};
+}
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker: workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+auto ThreadPool::shared() -> ThreadPool & {
+    static ThreadPool pool(std::thread::hardware_concurrency());
+    return pool;
+}
+
+auto ThreadPool::disableInThisProcess() -> void {
+    poolDisabled.store(true);
+}
+
+auto ThreadPool::submit(std::function<void()> task) -> std::future<void> {
+    std::packaged_task<void()> packaged(std::move(task));
+    std::future<void> result = packaged.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(packaged));
+    }
+    wake.notify_one();
+    return result;
+}
+
+auto ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &body) -> void {
+    if (count <= 1 || insidePool || poolDisabled.load()) {
+        for (std::size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    /*
+     * Zadania same pobierają kolejne indeksy, więc nierówne kolumny rozkładają się po wątkach.
+     * Czekamy na wykonanie wszystkich indeksów, a nie na zadania w kolejce - zadanie, które wystartuje
+     * później (bo wątki puli są zajęte), nie znajdzie już pracy i nie dotknie body.
+     */
+    struct State {
+        std::atomic<std::size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::size_t done = 0;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    auto drain = [state, count, body = &body]() {
+        for (std::size_t i = state->next.fetch_add(1); i < count; i = state->next.fetch_add(1)) {
+            std::exception_ptr error;
+            if (!state->failed.load()) {
+                try {
+                    (*body)(i);
+                } catch (...) {
+                    error = std::current_exception();
+                    state->failed.store(true);
+                }
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error) {
+                state->error = error;
+            }
+            if (++state->done == count) {
+                state->finished.notify_all();
+            }
+        }
+    };
+    for (std::size_t i = 0; i + 1 < std::min(count, workers.size() + 1); ++i) {
+        submit(drain);
+    }
+    drain();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count]() { return state->done == count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+auto ThreadPool::size() const -> std::size_t {
+    return workers.size();
+}
+
+auto ThreadPool::workerLoop() -> void {
+    insidePool = true;
+    while (true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef DATABASE2_THREADPOOL_H
+#define DATABASE2_THREADPOOL_H
+#pragma once
+#include "Prerequestion.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+/*
+ * Stała pula wątków do równoległego kodowania/dekodowania kolumn snapshotu.
+ * parallelFor wywołany z wątku puli (zagnieżdżenie) albo po disableInThisProcess() wykonuje się
+ * w wątku wywołującym - inaczej pula mogłaby czekać sama na siebie.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+
+    static auto shared() -> ThreadPool &;
+    // Po fork() wątki puli nie istnieją w procesie potomnym.
+    static auto disableInThisProcess() -> void;
+
+    auto submit(std::function<void()> task) -> std::future<void>;
+    // Wywołuje body(0..count-1) równolegle i czeka na wszystkie; pierwszy wyjątek jest rzucany dalej.
+    auto parallelFor(std::size_t count, const std::function<void(std::size_t)> &body) -> void;
+    auto size() const -> std::size_t;
+
+private:
+    auto workerLoop() -> void;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::packaged_task<void()>> tasks;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
+
+#endif //DATABASE2_THREADPOOL_H
@@ -0,0 +1,153 @@
+#include "Trace.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace {
+    struct TraceEvent {
+        const char *name = nullptr;
+        std::uint64_t startNanos = 0;
+        std::uint64_t durationNanos = 0;
+    };
+
+    // Bufor jednego wątku; blokada jest niesporna poza chwilą TRACE DUMP / TRACE START.
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+        std::uint64_t written = 0;
+        std::size_t thread = 0;
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        // Bufory zakończonych wątków zostają - ich spany nadal trafiają do zrzutu.
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::uint64_t startedAt = 0;
+    };
+
+    auto registry() -> Registry & {
+        static Registry instance;
+        return instance;
+    }
+
+    auto localBuffer() -> ThreadBuffer & {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+            auto created = std::make_shared<ThreadBuffer>();
+            created->events.resize(TRACE_RING_EVENTS);
+            Registry &shared = registry();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            created->thread = shared.buffers.size() + 1;
+            shared.buffers.push_back(created);
+            return created;
+        }();
+        return *buffer;
+    }
+
+    auto appendEscaped(std::ostream &out, const char *text) -> void {
+        for (; *text != '\0'; ++text) {
+            if (*text == '"' || *text == '\\') {
+                out << '\\';
+            }
+            out << *text;
+        }
+    }
+}
+
+auto Tracer::compiledIn() -> bool {
+#ifdef DATABASE_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+auto Tracer::start() -> void {
+    if (!compiledIn()) {
+        throw std::runtime_error("Tracing is not compiled in (build with -DDATABASE_TRACING=ON)");
+    }
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    for (const auto &buffer: shared.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->written = 0;
+    }
+    shared.startedAt = now();
+    recording.store(true, std::memory_order_relaxed);
+}
+
+auto Tracer::stop() -> void {
+    recording.store(false, std::memory_order_relaxed);
+}
+
+auto Tracer::now() -> std::uint64_t {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+auto Tracer::record(const char *name, std::uint64_t startNanos, std::uint64_t durationNanos) -> void {
+    ThreadBuffer &buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events[buffer.written % TRACE_RING_EVENTS] = {name, startNanos, durationNanos};
+    ++buffer.written;
+}
+
+auto Tracer::dump(const std::string &path) -> std::size_t {
+    if (!compiledIn()) {
+        throw std::runtime_error("Tracing is not compiled in (build with -DDATABASE_TRACING=ON)");
+    }
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open trace file: " + path);
+    }
+
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    std::size_t events = 0;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+    for (const auto &buffer: shared.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        std::uint64_t kept = std::min<std::uint64_t>(buffer->written, TRACE_RING_EVENTS);
+        for (std::uint64_t i = buffer->written - kept; i < buffer->written; ++i) {
+            const TraceEvent &event = buffer->events[i % TRACE_RING_EVENTS];
+            // Span rozpoczęty przed TRACE START - bez niego oś czasu zaczynałaby się przed zapisem.
+            if (event.startNanos < shared.startedAt) {
+                continue;
+            }
+            out << (events == 0 ? "" : ",\n") << "{\"name\":\"";
+            appendEscaped(out, event.name);
+            // Chrome oczekuje mikrosekund; ułamek zachowuje rozdzielczość nanosekundową.
+            out << "\",\"cat\":\"database\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+                << ",\"ts\":" << static_cast<double>(event.startNanos - shared.startedAt) / 1000.0
+                << ",\"dur\":" << static_cast<double>(event.durationNanos) / 1000.0 << "}";
+            ++events;
+        }
+    }
+    out << "\n]}\n";
+    if (!out) {
+        throw std::runtime_error("Cannot write trace file: " + path);
+    }
+    return events;
+}
+
+auto Tracer::status() -> std::string {
+    if (!compiledIn()) {
+        return "Tracing: not compiled in (build with -DDATABASE_TRACING=ON)\n";
+    }
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    std::uint64_t written = 0;
+    std::uint64_t overwritten = 0;
+    for (const auto &buffer: shared.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        written += buffer->written;
+        overwritten += buffer->written - std::min<std::uint64_t>(buffer->written, TRACE_RING_EVENTS);
+    }
+    std::ostringstream out;
+    out << "Tracing: " << (enabled() ? "on" : "off") << ", " << written << " spans in " << shared.buffers.size()
+        << " threads, " << overwritten << " overwritten\n";
+    return out.str();
+}
@@ -0,0 +1,67 @@
+#ifndef DATABASE2_TRACE_H
+#define DATABASE2_TRACE_H
+#pragma once
+#include "Prerequestion.h"
+#include <atomic>
+#include <cstdint>
+
+// Tyle ostatnich spanów pamięta każdy wątek (starsze są nadpisywane); ok. 1.5 MiB na wątek, który coś zapisał.
+constexpr std::size_t TRACE_RING_EVENTS = 1 << 16;
+
+/*
+ * Śledzenie czasu wewnątrz pojedynczych poleceń. TRACE_SPAN("nazwa") mierzy czas do końca bieżącego zakresu
+ * i zapisuje go w buforze pierścieniowym swojego wątku; TRACE DUMP zapisuje bufory wszystkich wątków jako JSON
+ * w formacie Chrome trace-event (chrome://tracing, ui.perfetto.dev).
+ * Spany istnieją tylko w kompilacji z DATABASE_TRACING (CMake: -DDATABASE_TRACING=ON) - bez niej TRACE_SPAN
+ * nie generuje żadnego kodu. Z nią, dopóki nie ma TRACE START, span kosztuje jeden odczyt flagi.
+ */
+class Tracer {
+public:
+    static auto enabled() -> bool {
+        return recording.load(std::memory_order_relaxed);
+    }
+    static auto compiledIn() -> bool;
+
+    // Czyści bufory i zaczyna zapis.
+    static auto start() -> void;
+    static auto stop() -> void;
+    // Zapisuje spany wszystkich wątków; zwraca ich liczbę. Działa także w trakcie zapisu.
+    static auto dump(const std::string &path) -> std::size_t;
+    static auto status() -> std::string;
+
+    static auto now() -> std::uint64_t;
+    // name musi żyć do końca programu (literał).
+    static auto record(const char *name, std::uint64_t startNanos, std::uint64_t durationNanos) -> void;
+
+private:
+    inline static std::atomic<bool> recording{false};
+};
+
+#ifdef DATABASE_TRACING
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name) : name(Tracer::enabled() ? name : nullptr),
+                                           startNanos(this->name != nullptr ? Tracer::now() : 0) {}
+
+    ~TraceSpan() {
+        if (name != nullptr) {
+            Tracer::record(name, startNanos, Tracer::now() - startNanos);
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    auto operator=(const TraceSpan &) -> TraceSpan & = delete;
+
+private:
+    const char *name;
+    std::uint64_t startNanos;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) static_cast<void>(0)
+#endif
+
+#endif //DATABASE2_TRACE_H
@@ -0,0 +1,49 @@
+#include "Transaction.h"
+
+auto Transaction::isWrite(const std::string &commandType) -> bool {
+    return commandType == "CREATE" || commandType == "DROP" || commandType == "ADD" || commandType == "INSERT" ||
+           commandType == "UPDATE" || commandType == "DELETE" || commandType == "REMOVE";
+}
+
+auto Transaction::begin() -> void {
+    if (open) {
+        throw std::runtime_error("A transaction is already open");
+    }
+    open = true;
+    writes.clear();
+}
+
+auto Transaction::add(Command command) -> void {
+    if (!open) {
+        throw std::runtime_error("No transaction is open");
+    }
+    writes.push_back(std::move(command));
+}
+
+auto Transaction::commit() -> std::vector<Command> {
+    if (!open) {
+        throw std::runtime_error("No transaction is open");
+    }
+    open = false;
+    return std::move(writes);
+}
+
+auto Transaction::rollback() -> std::size_t {
+    if (!open) {
+        throw std::runtime_error("No transaction is open");
+    }
+    open = false;
+    std::size_t discarded = writes.size();
+    writes.clear();
+    return discarded;
+}
+
+auto Transaction::tableNames(const std::vector<Command> &commands) -> std::vector<std::string> {
+    std::vector<std::string> names;
+    for (const auto &command: commands) {
+        if (std::ranges::find(names, command.tableName) == names.end()) {
+            names.push_back(command.tableName);
+        }
+    }
+    return names;
+}
@@ -0,0 +1,39 @@
+#ifndef DATABASE2_TRANSACTION_H
+#define DATABASE2_TRANSACTION_H
+#pragma once
+#include "Prerequestion.h"
+#include "Parser.h"
+
+/*
+ * Transakcja CLI (BEGIN ... COMMIT | ROLLBACK). Polecenia zmieniające dane (isWrite) trafiają do zbioru zapisów
+ * i są wykonywane dopiero przy COMMIT - jednym wsadem, pod jedną blokadą bazy. Gdy któreś z nich się
+ * nie powiedzie, tabele, których dotyczyła transakcja, wracają do stanu sprzed COMMIT.
+ * SELECT wewnątrz transakcji czyta stan zatwierdzony, bez zmian z jej zbioru zapisów.
+ */
+class Transaction {
+public:
+    static auto isWrite(const std::string &commandType) -> bool;
+
+    auto active() const -> bool {
+        return open;
+    }
+
+    auto begin() -> void;
+    auto add(Command command) -> void;
+    // Kończy transakcję i oddaje jej zbiór zapisów (w kolejności poleceń).
+    auto commit() -> std::vector<Command>;
+    // Kończy transakcję bez zmian; zwraca liczbę odrzuconych poleceń.
+    auto rollback() -> std::size_t;
+    auto size() const -> std::size_t {
+        return writes.size();
+    }
+
+    // Nazwy tabel, których dotyczy zbiór zapisów (bez powtórzeń).
+    static auto tableNames(const std::vector<Command> &commands) -> std::vector<std::string>;
+
+private:
+    bool open = false;
+    std::vector<Command> writes;
+};
+
+#endif //DATABASE2_TRANSACTION_H
@@ -0,0 +1,87 @@
+#include "TrigramIndex.h"
+#include "TextSearch.h"
+
+namespace {
+    auto trigramAt(std::string_view text, std::size_t position) -> std::uint32_t {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(text[position])) << 16 |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(text[position + 1])) << 8 |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(text[position + 2]));
+    }
+}
+
+auto TrigramIndex::add(std::size_t row, const std::string &value) -> void {
+    // Trigramy z tej samej postaci wartości, którą porównuje LIKE.
+    std::string_view subject = likeSubject(value);
+    for (std::size_t i = 0; i + 3 <= subject.size(); ++i) {
+        auto &rows = postings[trigramAt(subject, i)];
+        if (!rows.empty() && rows.back() >= row) {
+            if (rows.back() == row) {
+                continue;
+            }
+            unsorted = true;
+        }
+        rows.push_back(row);
+    }
+}
+
+auto TrigramIndex::clear() -> void {
+    postings.clear();
+    indexedRows = 0;
+    unsorted = false;
+}
+
+auto TrigramIndex::candidates(const std::string &pattern) -> std::optional<std::vector<std::size_t>> {
+    std::vector<std::uint32_t> trigrams;
+    for (const auto &literal: likeLiterals(pattern)) {
+        for (std::size_t i = 0; i + 3 <= literal.size(); ++i) {
+            trigrams.push_back(trigramAt(literal, i));
+        }
+    }
+    if (trigrams.empty()) {
+        return std::nullopt;
+    }
+    if (unsorted) {
+        for (auto &[trigram, rows]: postings) {
+            std::ranges::sort(rows);
+            rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        }
+        unsorted = false;
+    }
+
+    std::vector<const std::vector<std::size_t> *> lists;
+    for (std::uint32_t trigram: trigrams) {
+        auto it = postings.find(trigram);
+        if (it == postings.end()) {
+            return std::vector<std::size_t>();
+        }
+        lists.push_back(&it->second);
+    }
+    // Przecięcie od najkrótszej listy - wynik nie może być dłuższy od niej.
+    std::ranges::sort(lists, {}, [](const std::vector<std::size_t> *rows) { return rows->size(); });
+    std::vector<std::size_t> result = *lists.front();
+    std::vector<std::size_t> narrowed;
+    for (std::size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        if (lists[i] == lists[i - 1]) {
+            continue;
+        }
+        narrowed.clear();
+        std::ranges::set_intersection(result, *lists[i], std::back_inserter(narrowed));
+        result.swap(narrowed);
+    }
+    return result;
+}
+
+auto TrigramIndex::narrows(const std::string &pattern) -> bool {
+    return std::ranges::any_of(likeLiterals(pattern), [](const std::string &literal) {
+        return literal.size() >= 3;
+    });
+}
+
+auto TrigramIndex::byteSize() const -> std::size_t {
+    std::size_t bytes = postings.bucket_count() * sizeof(void *);
+    for (const auto &[trigram, rows]: postings) {
+        bytes += sizeof(std::pair<const std::uint32_t, std::vector<std::size_t>>) + sizeof(void *) +
+                 rows.capacity() * sizeof(std::size_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,37 @@
+#ifndef DATABASE2_TRIGRAMINDEX_H
+#define DATABASE2_TRIGRAMINDEX_H
+#pragma once
+#include "Prerequestion.h"
+#include <cstdint>
+#include <optional>
+#include <iterator>
+#include <unordered_map>
+
+/*
+ * CREATE INDEX ON t (column): dla każdej trójki kolejnych znaków wartości lista wierszy, w których występuje.
+ * Indeks tylko zawęża LIKE - wiersze z listy są potem sprawdzane pełnym porównaniem, więc nadpisana wartość
+ * może zostać na starych listach (zbędny kandydat), ale nowa wartość musi trafić na swoje listy.
+ * Wiersze od indexedRows w górę nie są jeszcze w indeksie - dopisuje je pierwsze zapytanie, które go użyje.
+ */
+struct TrigramIndex {
+    explicit TrigramIndex(std::string column) : column(std::move(column)) {}
+
+    std::string column;
+    std::unordered_map<std::uint32_t, std::vector<std::size_t>> postings;
+    std::size_t indexedRows = 0;
+
+    auto add(std::size_t row, const std::string &value) -> void;
+    // Po zmianie numeracji wierszy (usunięcie wierszy, przebudowa) indeks buduje się od nowa.
+    auto clear() -> void;
+    // Wiersze, które mogą pasować do wzorca LIKE (rosnąco); nullopt - wzorzec nie ma fragmentu na trigram.
+    auto candidates(const std::string &pattern) -> std::optional<std::vector<std::size_t>>;
+    // Czy wzorzec ma fragment bez % i _ długości co najmniej 3 - tylko wtedy candidates coś zawęża.
+    static auto narrows(const std::string &pattern) -> bool;
+    auto byteSize() const -> std::size_t;
+
+private:
+    // add poza kolejnością wierszy (UPDATE, INSERT w pustą komórkę) - listy trzeba posortować przed użyciem.
+    bool unsorted = false;
+};
+
+#endif //DATABASE2_TRIGRAMINDEX_H
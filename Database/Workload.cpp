@@ -0,0 +1,308 @@
+#include "Workload.h"
+#include "BinaryIO.h"
+#include "Stats.h"
+#include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace {
+    // Tyle poleceń, które zwolniły najbardziej, pokazuje podsumowanie REPLAY.
+    constexpr std::size_t REPLAY_TOP_REGRESSIONS = 5;
+
+    auto systemNanos(std::chrono::system_clock::time_point time) -> std::uint64_t {
+        return static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    }
+
+    auto readCapture(const std::string &path, std::vector<CapturedStatement> &statements) -> void {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open capture file: " + path);
+        }
+        char magic[sizeof(CAPTURE_MAGIC) - 1];
+        if (!in.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)) != CAPTURE_MAGIC) {
+            throw std::runtime_error("Not a capture file: " + path);
+        }
+        std::uint64_t time = readU64(in);
+        while (in.peek() != std::char_traits<char>::eof()) {
+            CapturedStatement statement;
+            time += readVarint(in);
+            statement.timeNanos = time;
+            statement.session = readVarint(in);
+            statement.latencyNanos = readVarint(in);
+            std::uint64_t size = readVarint(in);
+            if (size > (std::uint64_t{1} << 32)) {
+                throw std::runtime_error("Corrupted capture file: " + path);
+            }
+            statement.text.resize(size);
+            if (size > 0 && !in.read(statement.text.data(), static_cast<std::streamsize>(size))) {
+                throw std::runtime_error("Unexpected end of capture file: " + path);
+            }
+            statements.push_back(std::move(statement));
+        }
+    }
+
+    auto readReplayReport(const std::string &path) -> std::vector<ReplayTiming> {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot open replay report: " + path);
+        }
+        std::vector<ReplayTiming> timings;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::size_t first = line.find('\t');
+            std::size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+            if (second == std::string::npos) {
+                throw std::runtime_error("Invalid replay report line " + std::to_string(timings.size() + 1) +
+                                         " in " + path);
+            }
+            ReplayTiming timing;
+            timing.session = std::stoull(line.substr(0, first));
+            timing.replayNanos = std::stoull(line.substr(first + 1, second - first - 1));
+            timing.text = line.substr(second + 1);
+            timings.push_back(std::move(timing));
+        }
+        return timings;
+    }
+
+    auto percentileOf(std::vector<std::uint64_t> values, double p) -> std::uint64_t {
+        if (values.empty()) {
+            return 0;
+        }
+        auto rank = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1));
+        std::ranges::nth_element(values, values.begin() + static_cast<std::ptrdiff_t>(rank));
+        return values[rank];
+    }
+
+    auto change(std::uint64_t before, std::uint64_t after) -> std::string {
+        if (before == 0) {
+            return "-";
+        }
+        std::ostringstream out;
+        out << std::showpos << std::fixed << std::setprecision(1)
+            << 100.0 * (static_cast<double>(after) - static_cast<double>(before)) / static_cast<double>(before)
+            << "%";
+        return out.str();
+    }
+}
+
+WorkloadCapture::WorkloadCapture() : session(std::random_device()()) {
+}
+
+WorkloadCapture::~WorkloadCapture() {
+    if (active()) {
+        stop();
+    }
+}
+
+auto WorkloadCapture::start(const std::string &path) -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (recording) {
+        throw std::runtime_error("Capture already running into " + this->path + " (CAPTURE STOP first)");
+    }
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open capture file: " + path);
+    }
+    out.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC) - 1);
+    startedAt = std::chrono::steady_clock::now();
+    writeU64(out, systemNanos(std::chrono::system_clock::now()));
+    this->path = path;
+    previousOffset = 0;
+    statements = 0;
+    recording = true;
+}
+
+auto WorkloadCapture::stop() -> std::size_t {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!recording) {
+        throw std::runtime_error("No capture is running");
+    }
+    out.close();
+    recording = false;
+    return statements;
+}
+
+auto WorkloadCapture::active() const -> bool {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recording;
+}
+
+auto WorkloadCapture::status() -> std::string {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!recording) {
+        return "Capture: off\n";
+    }
+    std::ostringstream out;
+    out << "Capture: " << path << ", session " << session << ", " << statements << " statements, "
+        << this->out.tellp() << " bytes\n";
+    return out.str();
+}
+
+auto WorkloadCapture::record(const std::string &statement, std::chrono::steady_clock::time_point started,
+                             std::uint64_t latencyNanos) -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!recording) {
+        return;
+    }
+    auto offset = static_cast<std::uint64_t>(std::max<std::int64_t>(
+            0, std::chrono::duration_cast<std::chrono::nanoseconds>(started - startedAt).count()));
+    // Wątki mogą zgłosić polecenia nie po kolei - przesunięcie nie może się cofać.
+    offset = std::max(offset, previousOffset);
+    writeVarint(out, offset - previousOffset);
+    writeVarint(out, session);
+    writeVarint(out, latencyNanos);
+    writeVarint(out, statement.size());
+    out.write(statement.data(), static_cast<std::streamsize>(statement.size()));
+    if (!out) {
+        throw std::runtime_error("Cannot write capture file: " + path);
+    }
+    previousOffset = offset;
+    ++statements;
+}
+
+auto readCaptures(const std::vector<std::string> &paths) -> std::vector<CapturedStatement> {
+    std::vector<CapturedStatement> statements;
+    for (const auto &path: paths) {
+        readCapture(path, statements);
+    }
+    std::ranges::stable_sort(statements, {}, &CapturedStatement::timeNanos);
+    return statements;
+}
+
+auto replayWorkload(const std::vector<CapturedStatement> &statements, const ReplayOptions &options,
+                    const std::function<SessionExecutor(std::uint64_t session)> &openSession)
+-> std::vector<std::uint64_t> {
+    std::vector<std::uint64_t> latencies(statements.size());
+    if (statements.empty()) {
+        return latencies;
+    }
+
+    // Sesje po kolei do wątków; polecenia jednej sesji zawsze w jednym wątku, więc zachowują kolejność.
+    std::size_t threads = std::max<std::size_t>(options.threads, 1);
+    std::map<std::uint64_t, std::pair<std::size_t, SessionExecutor>> sessions;
+    std::vector<std::vector<std::size_t>> queues(threads);
+    for (std::size_t i = 0; i < statements.size(); ++i) {
+        auto it = sessions.find(statements[i].session);
+        if (it == sessions.end()) {
+            it = sessions.emplace(statements[i].session,
+                                  std::make_pair(sessions.size() % threads, openSession(statements[i].session)))
+                    .first;
+        }
+        queues[it->second.first].push_back(i);
+    }
+
+    const std::uint64_t firstTime = statements.front().timeNanos;
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (const auto &queue: queues) {
+        if (queue.empty()) {
+            continue;
+        }
+        workers.emplace_back([&]() {
+            for (std::size_t i: queue) {
+                const CapturedStatement &statement = statements[i];
+                if (options.speed > 0.0) {
+                    auto due = begin + std::chrono::nanoseconds(static_cast<std::int64_t>(
+                            static_cast<double>(statement.timeNanos - firstTime) / options.speed));
+                    // Czekamy krótkimi odcinkami, żeby anulowanie nie czekało na odległe polecenie.
+                    while (std::chrono::steady_clock::now() < due && !(options.canceled && options.canceled())) {
+                        std::this_thread::sleep_until(std::min(due, std::chrono::steady_clock::now() +
+                                                                    std::chrono::milliseconds(50)));
+                    }
+                }
+                if (options.canceled && options.canceled()) {
+                    return;
+                }
+                StopWatch timer;
+                try {
+                    sessions.at(statement.session).second(statement.text);
+                } catch (const std::exception &) {
+                    // Wykonawca sam zgłasza błędy poleceń; czas liczy się tak samo.
+                }
+                latencies[i] = timer.elapsedNanos();
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    return latencies;
+}
+
+auto writeReplayReport(const std::string &path, const std::vector<ReplayTiming> &timings) -> void {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open replay report: " + path);
+    }
+    for (const auto &timing: timings) {
+        out << timing.session << '\t' << timing.replayNanos << '\t' << timing.text << '\n';
+    }
+    if (!out) {
+        throw std::runtime_error("Cannot write replay report: " + path);
+    }
+}
+
+auto compareReplayReports(const std::string &baselinePath, const std::string &replayPath)
+-> std::vector<ReplayTiming> {
+    std::vector<ReplayTiming> baseline = readReplayReport(baselinePath);
+    std::vector<ReplayTiming> replay = readReplayReport(replayPath);
+    if (baseline.size() != replay.size()) {
+        throw std::runtime_error("Replay reports differ in length (" + std::to_string(baseline.size()) + " and " +
+                                 std::to_string(replay.size()) + " statements) - not the same capture");
+    }
+    for (std::size_t i = 0; i < replay.size(); ++i) {
+        if (baseline[i].text != replay[i].text) {
+            throw std::runtime_error("Replay reports differ at statement " + std::to_string(i + 1) +
+                                     " - not the same capture");
+        }
+        replay[i].baselineNanos = baseline[i].replayNanos;
+    }
+    return replay;
+}
+
+auto describeReplayTimings(const std::vector<ReplayTiming> &timings) -> std::string {
+    std::vector<std::uint64_t> baseline;
+    std::vector<std::uint64_t> replay;
+    std::uint64_t baselineTotal = 0;
+    std::uint64_t replayTotal = 0;
+    for (const auto &timing: timings) {
+        baseline.push_back(timing.baselineNanos);
+        replay.push_back(timing.replayNanos);
+        baselineTotal += timing.baselineNanos;
+        replayTotal += timing.replayNanos;
+    }
+
+    std::ostringstream out;
+    out << "latency_ns   baseline       replay         change\n";
+    for (auto [label, p]: {std::pair{"p50", 0.5}, std::pair{"p95", 0.95}, std::pair{"p99", 0.99}}) {
+        std::uint64_t before = percentileOf(baseline, p);
+        std::uint64_t after = percentileOf(replay, p);
+        out << std::left << std::setw(13) << label << std::setw(15) << before << std::setw(15) << after
+            << change(before, after) << "\n";
+    }
+    out << std::left << std::setw(13) << "total" << std::setw(15) << baselineTotal << std::setw(15) << replayTotal
+        << change(baselineTotal, replayTotal) << std::right << "\n";
+
+    std::vector<std::size_t> slower;
+    for (std::size_t i = 0; i < timings.size(); ++i) {
+        if (timings[i].replayNanos > timings[i].baselineNanos) {
+            slower.push_back(i);
+        }
+    }
+    auto regression = [&](std::size_t i) { return timings[i].replayNanos - timings[i].baselineNanos; };
+    std::size_t shown = std::min(slower.size(), REPLAY_TOP_REGRESSIONS);
+    std::ranges::partial_sort(slower, slower.begin() + static_cast<std::ptrdiff_t>(shown), std::greater<>(),
+                              regression);
+    if (shown > 0) {
+        out << "Largest regressions:\n";
+    }
+    for (std::size_t k = 0; k < shown; ++k) {
+        const ReplayTiming &timing = timings[slower[k]];
+        out << "  #" << slower[k] + 1 << " +" << regression(slower[k]) << " ns (" << timing.baselineNanos
+            << " -> " << timing.replayNanos << "): " << timing.text << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,96 @@
+#ifndef DATABASE2_WORKLOAD_H
+#define DATABASE2_WORKLOAD_H
+#pragma once
+#include "Prerequestion.h"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+
+// Nagłówek pliku nagrania (CAPTURE START); zmiana formatu wymaga nowej wersji.
+constexpr char CAPTURE_MAGIC[] = "DBCAPT01";
+
+struct CapturedStatement {
+    // Chwila rozpoczęcia według zegara systemowego (ns od epoki) - pozwala łączyć nagrania kilku procesów.
+    std::uint64_t timeNanos = 0;
+    std::uint64_t session = 0;
+    // Czas wykonania w nagrywanym procesie.
+    std::uint64_t latencyNanos = 0;
+    std::string text;
+};
+
+/*
+ * Nagrywanie obciążenia (CAPTURE START path): każde polecenie wpisane w CLI trafia do pliku z chwilą
+ * rozpoczęcia, identyfikatorem sesji i czasem wykonania. Rekord to cztery liczby w kodzie varint
+ * (przesunięcie czasu względem poprzedniego rekordu, sesja, czas wykonania, długość tekstu) i tekst polecenia,
+ * więc typowe polecenie zajmuje kilka bajtów ponad swoją treść.
+ */
+class WorkloadCapture {
+public:
+    WorkloadCapture();
+    ~WorkloadCapture();
+
+    WorkloadCapture(const WorkloadCapture &) = delete;
+    auto operator=(const WorkloadCapture &) -> WorkloadCapture & = delete;
+
+    auto start(const std::string &path) -> void;
+    // Zamyka plik; zwraca liczbę nagranych poleceń.
+    auto stop() -> std::size_t;
+    auto active() const -> bool;
+    auto status() -> std::string;
+    auto record(const std::string &statement, std::chrono::steady_clock::time_point started,
+                std::uint64_t latencyNanos) -> void;
+
+private:
+    mutable std::mutex mutex;
+    std::ofstream out;
+    std::string path;
+    // Stały dla procesu - odróżnia sesje, gdy REPLAY łączy nagrania kilku procesów.
+    std::uint64_t session;
+    std::chrono::steady_clock::time_point startedAt;
+    std::uint64_t previousOffset = 0;
+    std::size_t statements = 0;
+    bool recording = false;
+};
+
+// Wczytuje nagrania i scala je w kolejności chwil rozpoczęcia.
+auto readCaptures(const std::vector<std::string> &paths) -> std::vector<CapturedStatement>;
+
+struct ReplayOptions {
+    // Mnożnik tempa względem nagrania; 0 - bez czekania (SPEED MAX).
+    double speed = 1.0;
+    std::size_t threads = 1;
+    // Sprawdzane przed każdym poleceniem; true kończy odtwarzanie (pozostałe polecenia są pomijane).
+    std::function<bool()> canceled;
+};
+
+using SessionExecutor = std::function<void(const std::string &statement)>;
+
+/*
+ * Odtwarza nagranie: sesje są rozdzielane między `threads` wątków, a polecenia jednej sesji wykonują się
+ * po kolei w jej własnym wykonawcy (openSession - wołane w wątku wywołującym, raz na sesję). Przy speed > 0
+ * każde polecenie startuje nie wcześniej niż w swojej chwili z nagrania podzielonej przez speed.
+ * Zwraca czas wykonania każdego polecenia (w kolejności nagrania).
+ */
+auto replayWorkload(const std::vector<CapturedStatement> &statements, const ReplayOptions &options,
+                    const std::function<SessionExecutor(std::uint64_t session)> &openSession)
+-> std::vector<std::uint64_t>;
+
+// Jedno polecenie raportu REPLAY: czas odniesienia (nagranie albo pierwszy raport) i czas porównywany.
+struct ReplayTiming {
+    std::uint64_t session = 0;
+    std::uint64_t baselineNanos = 0;
+    std::uint64_t replayNanos = 0;
+    std::string text;
+};
+
+// Raport tekstowy (sesja, czas w ns, polecenie - rozdzielone tabulatorami), do porównania dwóch wersji programu.
+auto writeReplayReport(const std::string &path, const std::vector<ReplayTiming> &timings) -> void;
+// Łączy dwa raporty tego samego nagrania: czasy pierwszego są odniesieniem, drugiego - porównywanymi.
+auto compareReplayReports(const std::string &baselinePath, const std::string &replayPath)
+-> std::vector<ReplayTiming>;
+// Percentyle obu czasów, suma i polecenia, które zwolniły najbardziej.
+auto describeReplayTimings(const std::vector<ReplayTiming> &timings) -> std::string;
+
+#endif //DATABASE2_WORKLOAD_H
@@ -0,0 +1,206 @@
+#include "ZoneMap.h"
+#include "Table.h"
+
+auto ColumnZone::add(const std::string &value) -> void {
+    if (value.empty()) {
+        ++nullCount;
+        return;
+    }
+    if (!hasValues() || value < minValue) {
+        minValue = value;
+    }
+    if (!hasValues() || value > maxValue) {
+        maxValue = value;
+    }
+
+    long long number;
+    if (parseNumber(value, number)) {
+        if (numericCount == 0 || number < minNumber) {
+            minNumber = number;
+        }
+        if (numericCount == 0 || number > maxNumber) {
+            maxNumber = number;
+        }
+        ++numericCount;
+    } else {
+        ++textCount;
+    }
+}
+
+auto ColumnZone::addRepeated(const std::string &value, std::size_t count) -> void {
+    if (count == 0) {
+        return;
+    }
+    if (value.empty()) {
+        nullCount += count;
+        return;
+    }
+    add(value);
+    long long number;
+    if (parseNumber(value, number)) {
+        numericCount += count - 1;
+    } else {
+        textCount += count - 1;
+    }
+}
+
+auto ColumnZone::hasValues() const -> bool {
+    return numericCount + textCount > 0;
+}
+
+
+auto buildZone(const Table &table, std::size_t block) -> ZoneMap {
+    ZoneMap zone;
+    zone.columns.resize(table.nextOrdinal);
+    std::size_t begin = block * ZONE_BLOCK_ROWS;
+    std::size_t end = std::min(begin + ZONE_BLOCK_ROWS, table.rowCount());
+    for (const auto &column: table.columns) {
+        for (std::size_t i = begin; i < end; ++i) {
+            zone.columns[column.ordinal].add(table.valueAt(i, column));
+        }
+    }
+    for (std::size_t i = begin; i < end; ++i) {
+        zone.deletedRows += table.isDeleted(i);
+    }
+    return zone;
+}
+
+auto rebuildZones(Table &table) -> void {
+    table.zones.clear();
+    for (std::size_t block = 0; block * ZONE_BLOCK_ROWS < table.rowCount(); ++block) {
+        table.zones.push_back(buildZone(table, block));
+    }
+}
+
+auto zonesMatchRows(const Table &table) -> bool {
+    return table.zones.size() == (table.rowCount() + ZONE_BLOCK_ROWS - 1) / ZONE_BLOCK_ROWS;
+}
+
+auto zoneColumn(const Table &table, std::size_t block, const Column &column) -> ColumnZone {
+    const ZoneMap &zone = table.zones[block];
+    if (column.ordinal < zone.columns.size()) {
+        return zone.columns[column.ordinal];
+    }
+    // Kolumna dodana po zbudowaniu strefy - wszystkie wiersze bloku mają jej wartość domyślną.
+    ColumnZone defaults;
+    std::size_t begin = block * ZONE_BLOCK_ROWS;
+    defaults.addRepeated(column.defaultValue, std::min(ZONE_BLOCK_ROWS, table.rowCount() - begin));
+    return defaults;
+}
+
+auto ensureZoneColumn(Table &table, std::size_t block, const Column &column) -> ColumnZone & {
+    ZoneMap &zone = table.zones[block];
+    if (column.ordinal >= zone.columns.size()) {
+        ColumnZone defaults = zoneColumn(table, block, column);
+        zone.columns.resize(column.ordinal + 1);
+        zone.columns[column.ordinal] = defaults;
+    }
+    return zone.columns[column.ordinal];
+}
+
+auto noteCellChanged(Table &table, std::size_t rowIndex, const Column &column,
+                     const std::string &oldValue, const std::string &newValue) -> void {
+    std::size_t block = rowIndex / ZONE_BLOCK_ROWS;
+    if (!zonesMatchRows(table)) {
+        rebuildZones(table);
+        return;
+    }
+    ColumnZone &zone = ensureZoneColumn(table, block, column);
+    if (oldValue.empty() && zone.nullCount > 0) {
+        --zone.nullCount;
+    }
+    zone.add(newValue);
+}
+
+auto noteRowAppended(Table &table) -> void {
+    std::size_t rowIndex = table.rows.size() - 1;
+    std::size_t block = rowIndex / ZONE_BLOCK_ROWS;
+    if (table.zones.size() != block && table.zones.size() != block + 1) {
+        rebuildZones(table);
+        return;
+    }
+    if (table.zones.size() == block) {
+        table.zones.emplace_back();
+    }
+    ZoneMap &zone = table.zones[block];
+    std::size_t previousRows = rowIndex - block * ZONE_BLOCK_ROWS;
+    const Row &row = table.rows[rowIndex];
+    // Kolumny są uporządkowane rosnąco po ordinal, więc brakujące strefy dokładamy po kolei.
+    for (const auto &column: table.columns) {
+        if (column.ordinal >= zone.columns.size()) {
+            zone.columns.resize(column.ordinal + 1);
+            zone.columns[column.ordinal].addRepeated(column.defaultValue, previousRows);
+        }
+        zone.columns[column.ordinal].add(row.value(column));
+    }
+}
+
+namespace {
+    auto columnMayMatch(const ColumnZone &zone, const std::string &op, const std::string &value) -> bool {
+        if (op == "=") {
+            if (value.empty()) {
+                return zone.nullCount > 0;
+            }
+            return zone.hasValues() && value >= zone.minValue && value <= zone.maxValue;
+        }
+        if (op == "!=") {
+            if (value.empty()) {
+                return zone.hasValues();
+            }
+            return zone.nullCount > 0 || !zone.hasValues() || zone.minValue != value || zone.maxValue != value;
+        }
+        if (op == "LIKE") {
+            // min/max nie mówią nic o podciągach - odrzucamy tylko blok bez żadnej wartości.
+            return zone.hasValues();
+        }
+
+        long long number;
+        if (parseNumber(value, number)) {
+            // Liczby porównujemy numerycznie, a tekstowe komórki leksykograficznie - blok odrzucamy
+            // tylko wtedy, gdy żadna z tych dwóch grup nie może dać trafienia.
+            if (zone.textCount > 0) {
+                return true;
+            }
+            if (zone.numericCount == 0) {
+                return false;
+            }
+            if (op == ">") return zone.maxNumber > number;
+            if (op == ">=") return zone.maxNumber >= number;
+            if (op == "<") return zone.minNumber < number;
+            if (op == "<=") return zone.minNumber <= number;
+            return true;
+        }
+
+        if (!zone.hasValues()) {
+            return false;
+        }
+        if (op == ">") return zone.maxValue > value;
+        if (op == ">=") return zone.maxValue >= value;
+        if (op == "<") return zone.minValue < value;
+        if (op == "<=") return zone.minValue <= value;
+        return true;
+    }
+}
+
+auto zoneMayMatch(const Table &table, const ZoneMap &zone, const Expression *expression) -> bool {
+    if (expression == nullptr) {
+        return true;
+    }
+    if (expression->logicalOperator == "AND") {
+        return zoneMayMatch(table, zone, expression->left.get()) && zoneMayMatch(table, zone, expression->right.get());
+    }
+    if (expression->logicalOperator == "OR") {
+        return zoneMayMatch(table, zone, expression->left.get()) || zoneMayMatch(table, zone, expression->right.get());
+    }
+
+    const Column *column = table.findColumn(expression->column);
+    if (column == nullptr) {
+        return true;
+    }
+    if (column->ordinal >= zone.columns.size()) {
+        ColumnZone defaults;
+        defaults.add(column->defaultValue);
+        return columnMayMatch(defaults, expression->operators, expression->value);
+    }
+    return columnMayMatch(zone.columns[column->ordinal], expression->operators, expression->value);
+}
@@ -0,0 +1,50 @@
+#ifndef DATABASE2_ZONEMAP_H
+#define DATABASE2_ZONEMAP_H
+#pragma once
+#include "Prerequestion.h"
+#include "Expression.h"
+#include "Predicate.h"
+
+struct Table;
+
+// Liczba wierszy w jednym bloku mapy stref.
+constexpr std::size_t ZONE_BLOCK_ROWS = 1024;
+
+/*
+ * Min/max jednej kolumny w bloku. Wartości tylko poszerzają zakres (nadpisana wartość nie zwęża min/max),
+ * więc strefa jest zawsze konserwatywna - może nie odrzucić bloku, ale nigdy nie odrzuci pasującego.
+ */
+struct ColumnZone {
+    std::size_t nullCount = 0;
+    std::size_t numericCount = 0;
+    std::size_t textCount = 0;
+    std::string minValue;
+    std::string maxValue;
+    long long minNumber = 0;
+    long long maxNumber = 0;
+
+    auto add(const std::string &value) -> void;
+    auto addRepeated(const std::string &value, std::size_t count) -> void;
+    auto hasValues() const -> bool;
+};
+
+// Strefy kolumn indeksowane przez Column::ordinal; kolumna dodana później może nie mieć jeszcze swojej strefy.
+// Usunięte wiersze nie zwężają min/max, ale blok złożony wyłącznie z nich jest pomijany bez skanowania.
+struct ZoneMap {
+    std::vector<ColumnZone> columns;
+    std::size_t deletedRows = 0;
+};
+
+struct Column;
+
+auto buildZone(const Table &table, std::size_t block) -> ZoneMap;
+auto rebuildZones(Table &table) -> void;
+auto zonesMatchRows(const Table &table) -> bool;
+auto zoneColumn(const Table &table, std::size_t block, const Column &column) -> ColumnZone;
+auto ensureZoneColumn(Table &table, std::size_t block, const Column &column) -> ColumnZone &;
+auto noteCellChanged(Table &table, std::size_t rowIndex, const Column &column,
+                     const std::string &oldValue, const std::string &newValue) -> void;
+auto noteRowAppended(Table &table) -> void;
+auto zoneMayMatch(const Table &table, const ZoneMap &zone, const Expression *expression) -> bool;
+
+#endif //DATABASE2_ZONEMAP_H
@@ -1,5 +1,8 @@
 #include "Database.h"
 #include "CLI.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
 
 /*
  *
@@ -21,6 +24,9 @@
 
  Klasa FileOps odpowiada głównie za tworzenie backupu bazy danych oraz wczytaniem backupu bazy danych z pliku.
 
+ Silnik bez CLI budowany jest jako biblioteka database_core. Klasa EmbeddedDatabase (Embedded.h) pozwala z niej korzystać
+ bez tekstu SQL: uchwyty tabel, wstawianie wsadami kolumn (std::span) i warunki WHERE budowane w kodzie.
+
 
 
 
@@ -31,9 +37,20 @@
 
  Dla CREATE - tworzy nową tabelę.
  CREATE table_name WITH {column_name, data_type}
-
- Dla ADD - dodaje nową kolumnę do tabeli.
+ CREATE table_name WITH {column_name, data_type} PARTITION BY RANGE(int_column) EVERY width
+ CREATE table_name WITH {column_name, data_type} PARTITION BY HASH(column_name) INTO count
+ (każda partycja to osobna tabela; SELECT, UPDATE i DELETE czytają tylko partycje, których WHERE nie wyklucza.
+ INSERT klucza zaczyna wiersz w jego partycji, INSERT innej kolumny wypełnia pustą komórkę albo zaczyna wiersz
+ w partycji domyślnej; klucza partycjonowania nie da się zmienić przez UPDATE)
+
+ Dla CREATE MATERIALIZED VIEW - zapisuje wynik zapytania jako tabelę tylko do odczytu (SELECT z niej kosztuje tyle,
+ co z małej tabeli). INSERT, UPDATE i DELETE w tabeli bazowej poprawiają widok o zmienione wiersze, bez liczenia
+ zapytania od nowa; DROP usuwa widok, a tabeli bazowej nie da się usunąć, dopóki ma widoki
+ CREATE MATERIALIZED VIEW view_name AS SELECT column_name, column_name FROM table_name WHERE condition
+
+ Dla ADD - dodaje nową kolumnę do tabeli (bez przepisywania wierszy; istniejące wiersze widzą default_value)
  ADD {column_name, data_type} INTO table_name
+ ADD {column_name, data_type, default_value} INTO table_name
 
  Dla INSERT - wprowadzanie danych do tabeli
  INSERT [int] INTO column_name IN table_name
@@ -42,28 +59,157 @@
 
  Dla SELECT
  SELECT column_name FROM table_name WHERE condition
+ SELECT column_name FROM table_name WHERE column_name LIKE 'pattern'   (% - dowolny ciąg, _ - jeden znak;
+ wzorzec dzielony jest na słowa i znaki jak wartość w INSERT, więc 'ab%' pasuje do 'abc def')
+ SELECT column_name FROM table_name TABLESAMPLE (p PERCENT) [REPEATABLE (seed)] WHERE condition
+ (czyta tylko ok. p% bloków po 1024 wiersze; to samo ziarno daje tę samą próbę)
+
+ Dla zapytań przybliżonych - wynik z przedziałem błędu i liczbą wczytanych wierszy; z TABLESAMPLE przedział
+ obejmuje też wiersze spoza próby
+ SELECT APPROX_COUNT_DISTINCT(column_name) FROM table_name [TABLESAMPLE (p PERCENT)] WHERE condition
+ SELECT APPROX_QUANTILE(int_column_name, q) FROM table_name [TABLESAMPLE (p PERCENT)] WHERE condition   (q z 0..1)
+
+ Dla CREATE INDEX - indeks trigramów kolumny string: LIKE z fragmentem co najmniej 3 znaków (sam albo w AND)
+ sprawdza tylko wiersze wskazane przez indeks. Indeks uzupełnia się przy pierwszym zapytaniu po zmianach,
+ a SAVE zapisuje tylko to, które kolumny go mają
+ CREATE INDEX ON table_name (column_name)
+ DROP INDEX ON table_name (column_name)
 
  Dla UPDATE - zmiany danych w tabeli
  UPDATE column_name FROM table_name WITH [updated_value]
+ UPDATE column_name FROM table_name WITH [updated_value] WHERE condition
+ UPDATE column_name FROM table_name WITH [column_name + number] WHERE condition   (także -, *, /; tylko kolumny int)
 
  Dla DELETE - usuwanie danych z tabeli
  DELETE [data] FROM column_name IN table_name
+ DELETE FROM table_name WHERE condition   (usuwa całe wiersze; miejsce odzyskiwane jest w tle)
 
- Dla REMOVE - usuwanie column z tabeli
+ Dla REMOVE - usuwanie column z tabeli (dane kolumny zwalniane są w tle)
  REMOVE column_name FROM table_name
 
  Dla DROP - usuwanie tabeli
  DROP table_name
+ DROP PARTITIONS FROM table_name BELOW bound   (usuwa całe przedziały RANGE poniżej bound, bez czytania wierszy)
 
  Dla SAVE - zapisanie danych do pliku
  SAVE absolute_path_to_file
+ SAVE ASYNC absolute_path_to_file     (zapis w tle stanu z chwili polecenia, postęp: SAVE STATUS)
+ SAVE EVERY seconds absolute_path_to_file     (okresowy SAVE ASYNC; SAVE EVERY 0 wyłącza)
+ SAVE STATUS
 
- Dla LOAD - wczytywanie danych z pliku
+ Dla LOAD - wczytywanie danych z pliku (zastępuje bieżącą bazę; dane tabel doczytywane są w tle
+ albo przy pierwszym użyciu tabeli). Stare kopie pseudo-json (Backup.txt) są importowane w całości od razu,
+ a tabele trafiają do pamięci skompresowane, jak po COMPRESS
  LOAD absolute_path_to_file
 
+ Dla COMPRESS - kompresja kolumnowa tabeli w pamięci (RLE, słownik, bit-packing, delta - dobierane automatycznie)
+ (zapis rozpakowuje tabelę; kompresuje się ona ponownie w tle, gdy zapisy do niej ucichną)
+ COMPRESS table_name
+
+ Dla PAGE - przeniesienie danych tabeli do pliku stron na dysku (domyślnie table_name.pages); w pamięci zostają
+ tylko katalog bloków i mapy stref, a bloki kolumn czyta pula buforów (CLOCK, przypinanie, odczyt z wyprzedzeniem).
+ SELECT, INSERT, UPDATE i DELETE działają bez zmian; plik jest przestrzenią roboczą - trwałość nadal daje SAVE
+ PAGE table_name [INTO path]
+
+ Dla STATS - histogramy opóźnień per typ komendy i liczniki (JSON - zrzut maszynowy, RESET - zerowanie)
+ STATS [JSON | RESET]
+
+ Dla ANALYZE - statystyki kolumn (puste wartości, liczba różnych wartości, histogram) dla wyboru planu zapytania;
+ zapisywane przez SAVE obok snapshotu (plik .stats)
+ ANALYZE [table_name]
+
+ Dla SHOW MEMORY - pamięć tabel (wiersze, mapy stref, kolumny zakodowane, statystyki, indeksy), cache wyników,
+ puli buforów, trwających zapytań oraz zajętość sterty i limity
+ SHOW MEMORY
+ SHOW PARTITIONS table_name   (granice i liczba wierszy partycji)
+ SHOW STATEMENTS              (trwające polecenia: faza, postęp, szacowany czas do końca fazy)
+
+ Dla SET - limity pamięci (0 wyłącza limit); po przekroczeniu SELECT, INSERT i UPDATE kończą się błędem,
+ a DELETE, DROP, REMOVE i COMPRESS nadal działają, żeby dało się zwolnić pamięć
+ SET MEMORY LIMIT size [KB | MB | GB]          (limit sterty całego procesu)
+ SET QUERY MEMORY LIMIT size [KB | MB | GB]    (limit wyniku jednego zapytania)
+ SET BUFFER POOL size [KB | MB | GB]           (pamięć na bloki tabel stronicowanych, domyślnie 64 MB)
+ SET STATEMENT TIMEOUT n [MS | S | MIN]        (albo STATEMENT_TIMEOUT; limit czasu każdego polecenia, 0 wyłącza)
+
+ Dla BEGIN, COMMIT i ROLLBACK - transakcja: CREATE, DROP, ADD, INSERT, UPDATE, DELETE i REMOVE po BEGIN są tylko
+ zapamiętywane i wykonują się razem przy COMMIT (jeśli któreś się nie powiedzie, żadna zmiana nie zostaje);
+ ROLLBACK je odrzuca. SELECT w transakcji widzi stan zatwierdzony, a LOAD jest w niej niedozwolony
+ BEGIN
+ COMMIT
+ ROLLBACK
+
+ Dla REPLICATE - replikacja przez gniazdo Unix na tym samym hoście: główny proces wysyła replikom snapshot,
+ a potem każdą zatwierdzoną zmianę (polecenie albo całą transakcję); replika stosuje je w tle i przyjmuje
+ tylko odczyty. STATUS pokazuje LSN i opóźnienie replik, STOP kończy replikację (replika znów przyjmuje zapisy);
+ LOAD na głównym procesie wymaga wcześniejszego REPLICATE STOP
+ REPLICATE SERVE socketPath
+ REPLICATE FROM socketPath
+ REPLICATE STATUS
+ REPLICATE STOP
+
+ Dla CAPTURE - nagrywanie obciążenia: każde polecenie wpisane w CLI (poza CAPTURE i REPLAY) trafia do pliku
+ binarnego z chwilą rozpoczęcia, identyfikatorem sesji i czasem wykonania
+ CAPTURE START path
+ CAPTURE STATUS
+ CAPTURE STOP
+
+ Dla REPLAY - odtworzenie nagrania na bieżącej bazie (zwykle po LOAD snapshotu z chwili nagrania). Domyślnie
+ w tempie oryginału; SPEED 2 - dwa razy szybciej, SPEED MAX - bez czekania. Kilka nagrań (np. z kilku procesów)
+ łączy się po czasie; każda sesja wykonuje się po kolei we własnym CLI, a THREADS dzieli sesje między wątki.
+ Wyniki poleceń nie są wypisywane; podsumowanie porównuje czasy z czasami z nagrania, a INTO zapisuje raport,
+ który REPLAY COMPARE zestawia z raportem innej wersji programu (percentyle i polecenia, które zwolniły najbardziej)
+ SAVE, LOAD, PAGE, REPLICATE i CAPTURE z nagrania są pomijane (podsumowanie podaje ich liczbę)
+ REPLAY path [, path ...] [SPEED factor | SPEED MAX] [THREADS n] [INTO report_path]
+ REPLAY COMPARE report_path WITH report_path
+
+ Dla CANCEL - anuluje polecenie o numerze z SHOW STATEMENTS (np. z innej sesji albo wątku REPLAY). Ctrl-C
+ (kill -INT pid) anuluje trwające polecenie, a drugi Ctrl-C kończy proces; kill -USR1 pid wypisuje postęp na stderr.
+ Anulowanie działa w skanach, projekcji, SAVE, LOAD i COMPRESS; UPDATE, DELETE i INSERT po rozpoczęciu zmian
+ kończą się normalnie, a SAVE zapisuje do pliku .partial i podmienia snapshot dopiero po udanym zapisie
+ CANCEL statement_id
+
+ Dla EXPLAIN ANALYZE - wykonuje komendę i pokazuje czas oraz liczbę wierszy każdej fazy
+ EXPLAIN ANALYZE statement
+
+ Dla TRACE - spany czasu wewnątrz poleceń (tokenizacja, parsowanie, skan i partie predykatu, projekcja, fazy SAVE
+ i LOAD, także w wątkach puli) zapisywane przez DUMP jako JSON Chrome trace-event (chrome://tracing, Perfetto).
+ Wymaga kompilacji z -DDATABASE_TRACING=ON; każdy wątek pamięta ostatnie 65536 spanów
+ TRACE START
+ TRACE STOP
+ TRACE STATUS
+ TRACE DUMP path
+
 Mimo, że nie korzystam z SFML w aplikacji, ale jak go nie ma to się aplikacja nie kompiluje, prawdopobnie jest to związane z CLionem i plikami w debugCmakee, ale zostawiamn na wszelki wypadek.
 
 */
+// Zastępczy operator new - zlicza alokacje (STATS) i bajty żywych alokacji (SHOW MEMORY, SET MEMORY LIMIT).
+// Zwykły operator delete nie dostaje rozmiaru, więc rozmiar leży w nagłówku przed zwracanym blokiem.
+constexpr std::size_t ALLOCATION_HEADER = alignof(std::max_align_t);
+
+auto operator new(std::size_t size) -> void * {
+    Stats::allocationCounter().fetch_add(1, std::memory_order_relaxed);
+    if (void *block = std::malloc(size + ALLOCATION_HEADER)) {
+        *static_cast<std::size_t *>(block) = size;
+        Stats::heapBytesCounter().fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+        return static_cast<char *>(block) + ALLOCATION_HEADER;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator delete(void *ptr) noexcept -> void {
+    if (ptr == nullptr) {
+        return;
+    }
+    void *block = static_cast<char *>(ptr) - ALLOCATION_HEADER;
+    Stats::heapBytesCounter().fetch_sub(static_cast<std::int64_t>(*static_cast<std::size_t *>(block)),
+                                        std::memory_order_relaxed);
+    std::free(block);
+}
+
+auto operator delete(void *ptr, std::size_t) noexcept -> void {
+    operator delete(ptr);
+}
+
 int main() {
     Database db;
     Parser parser;